@@ -1,20 +1,52 @@
 package main
 
 import (
+	"flag"
 	"fmt"
 	"math/rand"
 	"nnl/src/neuralnetwork"
 	"nnl/src/trainingdata"
+	"os"
+	"strconv"
+	"strings"
 	"time"
 )
 
 func main() {
 	defer timeTrack(time.Now(), "main")
 
-	nn := neuralnetwork.SetUp(2, 4, 1, 0.1)
+	layers := flag.String("layers", "2,4,1", "Network architecture: inputs,hidden,outputs")
+	data := flag.String("data", "", "Train on a .csv dataset (inputs then targets per line) instead of XOR")
+	iterations := flag.Int("iterations", 10000, "Random XOR samples, or epochs over -data")
+	learningRate := flag.Float64("lr", 0.1, "Learning rate")
+	seed := flag.Int64("seed", 0, "Random seed (0 = time-based)")
+	flag.Parse()
+
+	sizes, err := parseLayers(*layers)
+	if err != nil {
+		fmt.Println("Error:", err)
+		os.Exit(1)
+	}
+	if *seed == 0 {
+		*seed = time.Now().UnixNano()
+	}
+	rand.Seed(*seed)
+
+	nn := neuralnetwork.SetUp(sizes[0], sizes[1], sizes[2], float32(*learningRate))
+	if *data != "" {
+		if err := trainOnData(&nn, *data, sizes, *iterations); err != nil {
+			fmt.Println("Error:", err)
+			os.Exit(1)
+		}
+		return
+	}
+	if sizes[0] != 2 || sizes[2] != 1 {
+		fmt.Println("Error: XOR needs 2 inputs and 1 output")
+		os.Exit(1)
+	}
+
 	trainingdata := getTrainingData()
-	rand.Seed(time.Now().UnixNano())
-	for i := 0; i < 10000; i++ {
+	for i := 0; i < *iterations; i++ {
 		index := rand.Intn(len(trainingdata))
 		data := trainingdata[index]
 		neuralnetwork.Train(&nn, data.Inputs, data.Targets)
@@ -49,6 +81,58 @@ func main() {
 	fmt.Println("iterating over", epoch*4, "times the nn is correct", percentage(epoch, equalCount), "% of the time")
 }
 
+// parseLayers reads the inputs,hidden,outputs sizes of the one-hidden-layer network
+func parseLayers(spec string) ([]int, error) {
+	fields := strings.Split(spec, ",")
+	if len(fields) != 3 {
+		return nil, fmt.Errorf("layers %q: expected inputs,hidden,outputs", spec)
+	}
+	sizes := make([]int, len(fields))
+	for i, field := range fields {
+		size, err := strconv.Atoi(strings.TrimSpace(field))
+		if err != nil || size <= 0 {
+			return nil, fmt.Errorf("layers %q: %q is not a layer size", spec, field)
+		}
+		sizes[i] = size
+	}
+	return sizes, nil
+}
+
+// trainOnData trains on every sample in file order for the given number of epochs, then reports
+// the mean squared error over the dataset in the same form as nnlcpp
+func trainOnData(nn *neuralnetwork.NeuralNetwork, path string, sizes []int, epochs int) error {
+	samples, err := trainingdata.LoadCSV(path, sizes[0], sizes[2])
+	if err != nil {
+		return err
+	}
+	if len(samples) == 0 {
+		return fmt.Errorf("%s holds no samples", path)
+	}
+	fmt.Println("Dataset:", path, "with", len(samples), "samples")
+
+	for i := 0; i < epochs; i++ {
+		for _, sample := range samples {
+			neuralnetwork.Train(nn, sample.Inputs, sample.Targets)
+		}
+	}
+
+	squaredError := 0.0
+	correct, outputs := 0, 0
+	for _, sample := range samples {
+		for j, value := range neuralnetwork.Feed(nn, sample.Inputs) {
+			diff := float64(value - sample.Targets[j])
+			squaredError += diff * diff
+			if (value >= 0.5) == (sample.Targets[j] >= 0.5) {
+				correct++
+			}
+			outputs++
+		}
+	}
+	fmt.Printf("Evaluated %d samples: MSE %.6f, %d of %d outputs correct (%.2f%%)\n", len(samples),
+		squaredError/float64(outputs), correct, outputs, 100*float64(correct)/float64(outputs))
+	return nil
+}
+
 func timeTrack(start time.Time, name string) {
 	fmt.Printf("%v: %v\n", name, time.Since(start))
 }
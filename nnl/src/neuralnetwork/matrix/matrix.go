@@ -4,7 +4,6 @@ import (
 	"fmt"
 	"math/rand"
 	"os"
-	"time"
 )
 
 // Matrix is a struct that holds rows, cols int and data [][]float32
@@ -120,10 +119,10 @@ func Transpose(m1 Matrix) Matrix {
 	return transposeM1
 }
 
-// Randomize takes a matrix and randomises all data points
+// Randomize takes a matrix and randomises all data points from the global source, so a seed
+// set once in main reproduces the same network
 func Randomize(m *Matrix) {
 	for x := 0; x < m.Rows; x++ {
-		rand.Seed(time.Now().UnixNano())
 		for y := 0; y < m.Cols; y++ {
 			m.Data[x][y] = float32(rand.Float32()*2 - 1)
 		}
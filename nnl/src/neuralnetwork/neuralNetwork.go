@@ -14,7 +14,7 @@ var learningRate float32
 
 // SetUp Initializes neuralNetwork
 func SetUp(i, h, o int, l float32) NeuralNetwork {
-	learningRate = 0.1
+	learningRate = l
 	nn := NeuralNetwork{
 		InputLayer:  layer.SetUp(h, i), //holds weights_ih
 		HiddenLayer: layer.SetUp(o, h), //holds weights_ho
@@ -46,9 +46,12 @@ func Train(nn *NeuralNetwork, input, target []float32) {
 	//calculate errors
 	//output errors
 	outputErrors := matrix.ScalarMatrix(targets, matrix.Subtract, outputs)
-	//hidden errors
+	//hidden errors: the output errors times the derivative of sigmoid, back through the weights
+	//(Map works in place, so it gets a copy of the outputs)
+	outputDeltas := matrix.Map(dSigmoid, matrix.FromArray(matrix.ToArray(outputs)))
+	outputDeltas = matrix.ScalarMatrix(outputDeltas, matrix.Multiply, outputErrors)
 	hiddenWT := matrix.Transpose(nn.HiddenLayer.Weights)
-	hiddenErrors := matrix.DotMatrix(hiddenWT, outputErrors)
+	hiddenErrors := matrix.DotMatrix(hiddenWT, outputDeltas)
 
 	//calculate change
 	nn.HiddenLayer = applyDelta(outputs, hidden, outputErrors, nn.HiddenLayer)
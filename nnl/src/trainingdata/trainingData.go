@@ -1,6 +1,48 @@
 package trainingdata
 
+import (
+	"bufio"
+	"fmt"
+	"os"
+	"strconv"
+	"strings"
+)
+
 //Trainingdata is....
 type Trainingdata struct {
 	Inputs, Targets []float32
 }
+
+// LoadCSV reads one sample per line, the inputs followed by the targets, separated by commas.
+// These are the same files nnlcpp trains on with --data.
+func LoadCSV(path string, inputs, targets int) ([]Trainingdata, error) {
+	file, err := os.Open(path)
+	if err != nil {
+		return nil, err
+	}
+	defer file.Close()
+
+	var samples []Trainingdata
+	scanner := bufio.NewScanner(file)
+	scanner.Buffer(make([]byte, 64*1024), 64*1024*1024)
+	for line := 1; scanner.Scan(); line++ {
+		text := strings.TrimSpace(scanner.Text())
+		if text == "" {
+			continue
+		}
+		fields := strings.Split(text, ",")
+		if len(fields) != inputs+targets {
+			return nil, fmt.Errorf("%s:%d: expected %d values, got %d", path, line, inputs+targets, len(fields))
+		}
+		values := make([]float32, len(fields))
+		for i, field := range fields {
+			value, err := strconv.ParseFloat(strings.TrimSpace(field), 32)
+			if err != nil {
+				return nil, fmt.Errorf("%s:%d: %v", path, line, err)
+			}
+			values[i] = float32(value)
+		}
+		samples = append(samples, Trainingdata{Inputs: values[:inputs], Targets: values[inputs:]})
+	}
+	return samples, scanner.Err()
+}
@@ -0,0 +1,434 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <random>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "allocations.hpp"
+#include "expression.hpp"
+#include "gemm.hpp"
+#include "kernels.hpp"
+#include "matrix.hpp"
+#include "neuralnetwork.hpp"
+#include "quantizednetwork.hpp"
+#include "staticnetwork.hpp"
+#include "workspace.hpp"
+
+// Self-contained benchmark harness. Every case is warmed up, then timed over a number of
+// repetitions, each long enough to swamp clock overhead; the per-op median and p99 are reported
+// together with throughput and heap allocations per op. Progress goes to stderr as a table and
+// the results to stdout (or --output) as JSON, so runs can be diffed across commits.
+
+namespace {
+
+struct Options {
+    uint32_t    reps = 15;       // Timed repetitions per case
+    uint32_t    warmup = 3;      // Untimed calls before calibration
+    double      min_time_ms = 5; // Minimum duration of one timed repetition
+    bool        quick = false;   // Skip the largest shapes and topologies
+    std::string filter;          // Only run cases whose name contains this
+    std::string output;          // JSON destination; stdout when empty
+};
+
+struct Result {
+    std::string name;
+    std::string shape;
+    uint64_t    iterations;    // Ops per repetition
+    uint32_t    reps;
+    double      median_ns;     // Per op
+    double      p99_ns;
+    double      min_ns;
+    double      flops;         // Per op, 0 when not meaningful
+    double      bytes;         // Per op, memory touched at least once
+    double      samples;       // Per op, for network cases
+    double      allocs_per_op;
+};
+
+volatile float g_sink; // Keeps benchmarked results observable
+
+class Bench {
+private:
+    Options             m_options;
+    std::vector<Result> m_results;
+
+public:
+    explicit Bench(Options options) : m_options(std::move(options)) {}
+
+    const Options& options() const {
+        return m_options;
+    }
+    bool selected(const std::string& name, const std::string& shape) const {
+        return m_options.filter.empty() || (name + "/" + shape).find(m_options.filter) != std::string::npos;
+    }
+
+    template <typename Op>
+    void run(const std::string& name, const std::string& shape, double flops, double bytes, double samples, Op&& op) {
+        if (!selected(name, shape))
+            return;
+
+        using Clock = std::chrono::steady_clock;
+        for (uint32_t i = 0; i < m_options.warmup; ++i) {
+            op();
+        }
+
+        // Calibrate: double the ops per repetition until one repetition takes min_time_ms
+        uint64_t iterations = 1;
+        while (true) {
+            auto start = Clock::now();
+            for (uint64_t i = 0; i < iterations; ++i) {
+                op();
+            }
+            double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            if (ms >= m_options.min_time_ms || iterations >= (1ull << 30))
+                break;
+            iterations = ms <= 0.0 ? iterations * 16
+                                   : std::max(iterations * 2, static_cast<uint64_t>(iterations * m_options.min_time_ms / ms));
+        }
+
+        std::vector<double> per_op(m_options.reps);
+        uint64_t            allocations = nnlcpp::Allocations::count();
+        for (auto& ns : per_op) {
+            auto start = Clock::now();
+            for (uint64_t i = 0; i < iterations; ++i) {
+                op();
+            }
+            ns = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations;
+        }
+        allocations = nnlcpp::Allocations::count() - allocations;
+
+        std::vector<double> sorted = per_op;
+        std::sort(sorted.begin(), sorted.end());
+        size_t p99 = static_cast<size_t>(std::ceil(0.99 * sorted.size())) - 1;
+
+        Result result{name,
+                      shape,
+                      iterations,
+                      m_options.reps,
+                      sorted[sorted.size() / 2],
+                      sorted[p99],
+                      sorted.front(),
+                      flops,
+                      bytes,
+                      samples,
+                      static_cast<double>(allocations) / (static_cast<double>(iterations) * m_options.reps)};
+
+        fprintf(stderr, "%-16s %-22s %14.1f %14.1f %10.2f %14.0f %10.2f\n", name.c_str(), shape.c_str(),
+                result.median_ns, result.p99_ns, flops / result.median_ns, samples * 1e9 / result.median_ns,
+                result.allocs_per_op);
+        m_results.push_back(std::move(result));
+    }
+
+    bool writeJson() const {
+        FILE* file = m_options.output.empty() ? stdout : fopen(m_options.output.c_str(), "w");
+        if (file == nullptr) {
+            printf("Error: Cannot open %s for writing.\n", m_options.output.c_str());
+            return false;
+        }
+
+        fprintf(file, "{\n  \"benchmark\": \"nnl_bench\",\n  \"kernels\": \"%s\",\n  \"timestamp\": %lld,\n",
+                nnlcpp::Kernels::active().name, static_cast<long long>(std::time(nullptr)));
+        fprintf(file, "  \"config\": {\"reps\": %u, \"warmup\": %u, \"min_time_ms\": %.3f},\n  \"results\": [\n",
+                m_options.reps, m_options.warmup, m_options.min_time_ms);
+        for (size_t i = 0; i < m_results.size(); ++i) {
+            const Result& r = m_results[i];
+            fprintf(file,
+                    "    {\"name\": \"%s\", \"shape\": \"%s\", \"iterations\": %llu, \"reps\": %u, "
+                    "\"ns_per_op_median\": %.3f, \"ns_per_op_p99\": %.3f, \"ns_per_op_min\": %.3f, "
+                    "\"gflops\": %.4f, \"gbytes_per_sec\": %.4f, \"samples_per_sec\": %.1f, "
+                    "\"allocs_per_op\": %.4f}%s\n",
+                    r.name.c_str(), r.shape.c_str(), static_cast<unsigned long long>(r.iterations), r.reps,
+                    r.median_ns, r.p99_ns, r.min_ns, r.flops / r.median_ns, r.bytes / r.median_ns,
+                    r.samples * 1e9 / r.median_ns, r.allocs_per_op, i + 1 < m_results.size() ? "," : "");
+        }
+        fprintf(file, "  ]\n}\n");
+        return file == stdout || fclose(file) == 0;
+    }
+};
+
+std::vector<float> randomVector(size_t size, std::mt19937& rng) {
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<float>                    values(size);
+    for (auto& value : values) {
+        value = dist(rng);
+    }
+    return values;
+}
+
+std::string joinTopology(const std::vector<uint32_t>& layers) {
+    std::string text;
+    for (size_t i = 0; i < layers.size(); ++i) {
+        text += (i ? "," : "") + std::to_string(layers[i]);
+    }
+    return text;
+}
+
+void benchMatrix(Bench& bench, std::mt19937& rng) {
+    struct Shape {
+        size_t m, k, n;
+    };
+    std::vector<Shape> shapes = {{1, 256, 256},   {256, 256, 1},   {32, 32, 32},    {64, 64, 64},
+                                 {128, 128, 128}, {256, 256, 256}, {784, 256, 32},  {512, 512, 512}};
+    if (!bench.options().quick) {
+        shapes.push_back({1024, 1024, 1024});
+    }
+    for (const Shape& s : shapes) {
+        std::vector<float> a = randomVector(s.m * s.k, rng);
+        std::vector<float> b = randomVector(s.k * s.n, rng);
+        std::string        shape = std::to_string(s.m) + "x" + std::to_string(s.k) + "x" + std::to_string(s.n);
+        bench.run("dotMatrix", shape, 2.0 * s.m * s.k * s.n, 4.0 * (s.m * s.k + s.k * s.n + s.m * s.n), 0, [&] {
+            g_sink = nnlcpp::Matrix::dotMatrix(a, s.m, s.k, b, s.k, s.n)[0];
+        });
+    }
+
+    std::vector<std::pair<size_t, size_t>> transposes = {{64, 64}, {1000, 3}, {256, 256}, {784, 256}, {1024, 1024}};
+    for (const auto& [rows, cols] : transposes) {
+        std::vector<float> a = randomVector(rows * cols, rng);
+        bench.run("transpose", std::to_string(rows) + "x" + std::to_string(cols), 0, 8.0 * rows * cols, 0,
+                  [&] { g_sink = nnlcpp::Matrix::transpose(a, rows, cols)[0]; });
+    }
+
+    for (size_t n : {size_t(1) << 10, size_t(1) << 16, size_t(1) << 20}) {
+        std::vector<float> a = randomVector(n, rng);
+        std::vector<float> b = randomVector(n, rng);
+        std::vector<float> out(n);
+        std::string        shape = std::to_string(n);
+        double             bytes = 12.0 * n;
+        bench.run("add", shape, n, bytes, 0, [&] { g_sink = nnlcpp::Matrix::add(a, b)[0]; });
+        bench.run("multiply", shape, n, bytes, 0, [&] { g_sink = nnlcpp::Matrix::multiply(a, b)[0]; });
+        bench.run("divide", shape, n, bytes, 0, [&] { g_sink = nnlcpp::Matrix::divide(a, b)[0]; });
+        bench.run("add_into", shape, n, bytes, 0, [&] {
+            nnlcpp::Matrix::add(a, b, out);
+            g_sink = out[0];
+        });
+
+        // out = a + 0.5 * a * b: two temporaries through Matrix, one fused pass as an expression
+        std::vector<float> half(n, 0.5f);
+        bench.run("composite_temporaries", shape, 3.0 * n, bytes, 0, [&] {
+            g_sink = nnlcpp::Matrix::add(a, nnlcpp::Matrix::multiply(half, nnlcpp::Matrix::multiply(a, b)))[0];
+        });
+        bench.run("composite_expression", shape, 3.0 * n, bytes, 0, [&] {
+            using nnlcpp::expression::values;
+            nnlcpp::expression::evaluate(out, values(a) + 0.5f * values(a) * values(b));
+            g_sink = out[0];
+        });
+    }
+}
+
+// Cost of each activation on its own and fused into a dense layer
+void benchActivations(Bench& bench, std::mt19937& rng) {
+    const size_t       n = size_t(1) << 16;
+    const size_t       rows = 256;
+    const size_t       cols = 784;
+    std::vector<float> z = randomVector(n, rng);
+    for (auto& value : z) {
+        value *= 8.0f; // Spread over the interesting range of every activation
+    }
+    std::vector<float> out(n);
+    std::vector<float> w = randomVector(rows * cols, rng);
+    std::vector<float> x = randomVector(cols, rng);
+    std::vector<float> b = randomVector(rows, rng);
+
+    for (size_t i = 0; i < nnlcpp::ACTIVATION_COUNT; ++i) {
+        auto                             activation = static_cast<nnlcpp::Activation>(i);
+        const nnlcpp::ActivationKernels& kernels = nnlcpp::Kernels::active().activation(activation);
+        std::string                      name = nnlcpp::activationName(activation);
+        bench.run("activate", name + "/" + std::to_string(n), n, 8.0 * n, 0, [&] {
+            kernels.activate(z.data(), out.data(), n);
+            g_sink = out[0];
+        });
+        bench.run("dense", name + "/" + std::to_string(rows) + "x" + std::to_string(cols), 2.0 * rows * cols,
+                  4.0 * (rows * cols + cols + 2 * rows), 0, [&] {
+                      kernels.dense(w.data(), x.data(), b.data(), nullptr, out.data(), rows, cols);
+                      g_sink = out[0];
+                  });
+    }
+}
+
+// One fused update pass per optimizer over a 784x256 layer: the dense form (gradient in memory),
+// the outer-product form of a single-sample step, and that step fused with backpropagating W^T delta.
+// backward_two_pass is the SGD backward step as separate update and transposed GEMV passes.
+void benchOptimizers(Bench& bench, std::mt19937& rng) {
+    const size_t       rows = 256;
+    const size_t       cols = 784;
+    const size_t       n = rows * cols;
+    std::vector<float> w = randomVector(n, rng);
+    std::vector<float> g = randomVector(n, rng);
+    std::vector<float> delta = randomVector(rows, rng);
+    std::vector<float> x = randomVector(cols, rng);
+    std::vector<float> next(cols);
+    std::vector<float> first(n);
+    std::vector<float> second(n);
+
+    for (size_t i = 0; i < nnlcpp::OPTIMIZER_COUNT; ++i) {
+        nnlcpp::OptimizerSettings settings;
+        settings.type = static_cast<nnlcpp::Optimizer>(i);
+        const nnlcpp::OptimizerKernels& kernels = nnlcpp::Kernels::active().optimizer(settings.type);
+        const nnlcpp::OptimizerStep     step = nnlcpp::OptimizerStep::make(settings, 1e-6f, 1);
+        std::string                     name = nnlcpp::optimizerName(settings.type);
+        std::string                     shape = std::to_string(rows) + "x" + std::to_string(cols);
+        // Weights read and written, the gradient read, and each state array read and written
+        const int    states = (settings.type == nnlcpp::Optimizer::Adam)  ? 2
+                              : (settings.type == nnlcpp::Optimizer::Sgd) ? 0
+                                                                          : 1;
+        const double bytes = 4.0 * n * (3 + 2 * states);
+        bench.run("optimizer_update", name + "/" + shape, 2.0 * n, bytes, 0, [&] {
+            kernels.update(w.data(), g.data(), 1.0f, first.data(), second.data(), n, step);
+            g_sink = w[0];
+        });
+        bench.run("optimizer_outer", name + "/" + shape, 3.0 * n, bytes - 4.0 * n, 0, [&] {
+            kernels.updateOuter(w.data(), delta.data(), x.data(), nullptr, first.data(), second.data(), rows, cols,
+                                step);
+            g_sink = w[0];
+        });
+        // The weights are still read and written once; next adds 2 flops per weight
+        bench.run("optimizer_backward", name + "/" + shape, 5.0 * n, bytes - 4.0 * n, 0, [&] {
+            kernels.updateOuter(w.data(), delta.data(), x.data(), next.data(), first.data(), second.data(), rows,
+                                cols, step);
+            g_sink = next[0];
+        });
+        if (settings.type == nnlcpp::Optimizer::Sgd) {
+            bench.run("backward_two_pass", name + "/" + shape, 5.0 * n, bytes, 0, [&] {
+                nnlcpp::Gemm::multiplyVector(1.0f, nnlcpp::ConstMatrixView(w.data(), rows, cols),
+                                             nnlcpp::Transpose::Yes, delta.data(), 0.0f, next.data());
+                kernels.updateOuter(w.data(), delta.data(), x.data(), nullptr, first.data(), second.data(), rows,
+                                    cols, step);
+                g_sink = next[0];
+            });
+        }
+    }
+}
+
+void benchNetwork(Bench& bench, std::mt19937& rng) {
+    std::vector<std::vector<uint32_t>> topologies = {
+        {2, 2, 1}, {16, 32, 1}, {64, 128, 64, 10}, {256, 256, 10}, {784, 256, 128, 10}};
+    if (!bench.options().quick) {
+        topologies.push_back({1024, 1024, 1024, 10});
+    }
+
+    const uint32_t batch_size = 32;
+    for (const auto& layers : topologies) {
+        std::srand(1);
+        nnlcpp::NeuralNetwork nn(layers, 0.01f);
+        std::string           shape = joinTopology(layers);
+
+        // Forward is 2 flops per weight, training adds the update and delta propagation
+        double weights = 0.0;
+        for (size_t i = 1; i < layers.size(); ++i) {
+            weights += static_cast<double>(layers[i - 1]) * layers[i];
+        }
+
+        std::vector<float> input = randomVector(layers.front(), rng);
+        std::vector<float> expected(layers.back(), 1.0f);
+        std::vector<float> output(layers.back());
+        std::vector<float> inputs = randomVector(batch_size * layers.front(), rng);
+        std::vector<float> expecteds(batch_size * layers.back(), 1.0f);
+        std::vector<float> outputs(batch_size * layers.back());
+        nnlcpp::Workspace  workspace(nn.getLayers(), batch_size);
+
+        bench.run("train", shape, 6.0 * weights, 12.0 * weights, 1, [&] { nn.train(input, expected); });
+        bench.run("train_batch32", shape, 6.0 * weights * batch_size, 12.0 * weights, batch_size,
+                  [&] { nn.trainBatch(inputs.data(), expecteds.data(), batch_size, workspace); });
+        bench.run("predict", shape, 2.0 * weights, 4.0 * weights, 1, [&] { g_sink = nn.predict(input)[0]; });
+        bench.run("predict_into", shape, 2.0 * weights, 4.0 * weights, 1, [&] {
+            nn.predict(input, output, workspace);
+            g_sink = output[0];
+        });
+        bench.run("predict_batch32", shape, 2.0 * weights * batch_size, 4.0 * weights, batch_size, [&] {
+            nn.predictBatch(inputs.data(), batch_size, outputs.data(), workspace);
+            g_sink = outputs[0];
+        });
+
+        // Int8 weights read a quarter of the bytes
+        nnlcpp::QuantizedNetwork          quantized = nnlcpp::QuantizedNetwork::quantize(nn);
+        nnlcpp::QuantizedNetwork::Scratch scratch = quantized.makeScratch();
+        bench.run("predict_int8", shape, 2.0 * weights, weights, 1, [&] {
+            quantized.predict(input, output, scratch);
+            g_sink = output[0];
+        });
+    }
+}
+
+// Compile-time topologies, comparable with the same shapes in benchNetwork
+template <uint32_t... Sizes>
+void benchStatic(Bench& bench, std::mt19937& rng) {
+    using Network = nnlcpp::StaticNetwork<Sizes...>;
+    std::string shape = joinTopology({Sizes...});
+
+    double weights = 0.0;
+    for (size_t i = 1; i < Network::TOPOLOGY.size(); ++i) {
+        weights += static_cast<double>(Network::TOPOLOGY[i - 1]) * Network::TOPOLOGY[i];
+    }
+
+    std::srand(1);
+    Network                  nn(0.01f);
+    typename Network::Input  input;
+    typename Network::Output expected;
+    std::vector<float>       values = randomVector(input.size(), rng);
+    std::copy(values.begin(), values.end(), input.begin());
+    expected.fill(1.0f);
+
+    bench.run("static_train", shape, 6.0 * weights, 12.0 * weights, 1, [&] { nn.train(input, expected); });
+    bench.run("static_predict", shape, 2.0 * weights, 4.0 * weights, 1, [&] { g_sink = nn.predict(input)[0]; });
+}
+
+void printUsage(const char* programName) {
+    printf("USAGE:\n  %s [OPTIONS]\n\n", programName);
+    printf("OPTIONS:\n");
+    printf("  %-20s %s\n", "-h, --help", "Show this help message");
+    printf("  %-20s %s\n", "--filter TEXT", "Only run cases whose name/shape contains TEXT");
+    printf("  %-20s %s\n", "--reps N", "Timed repetitions per case (default 15)");
+    printf("  %-20s %s\n", "--warmup N", "Untimed warm-up calls per case (default 3)");
+    printf("  %-20s %s\n", "--min-time MS", "Minimum length of one repetition (default 5)");
+    printf("  %-20s %s\n", "--quick", "Skip the largest shapes and topologies");
+    printf("  %-20s %s\n\n", "--output PATH", "Write JSON results to PATH instead of stdout");
+}
+
+} // namespace
+
+int main(int argc, char const* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            printUsage(argv[0]);
+            return 0;
+        } else if (arg == "--filter" && i + 1 < argc) {
+            options.filter = argv[++i];
+        } else if (arg == "--reps" && i + 1 < argc) {
+            options.reps = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--warmup" && i + 1 < argc) {
+            options.warmup = std::max(0, std::stoi(argv[++i]));
+        } else if (arg == "--min-time" && i + 1 < argc) {
+            options.min_time_ms = std::max(0.0, std::stod(argv[++i]));
+        } else if (arg == "--quick") {
+            options.quick = true;
+        } else if (arg == "--output" && i + 1 < argc) {
+            options.output = argv[++i];
+        } else {
+            printf("Error: Unknown option %s.\n", arg.c_str());
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    fprintf(stderr, "SIMD kernels: %s\n", nnlcpp::Kernels::active().name);
+    fprintf(stderr, "%-16s %-22s %14s %14s %10s %14s %10s\n", "Case", "Shape", "Median ns/op", "p99 ns/op",
+            "GFLOP/s", "Samples/sec", "Allocs/op");
+
+    Bench        bench(options);
+    std::mt19937 rng(42);
+    benchMatrix(bench, rng);
+    benchActivations(bench, rng);
+    benchOptimizers(bench, rng);
+    benchNetwork(bench, rng);
+    benchStatic<2, 2, 1>(bench, rng);
+    benchStatic<2, 4, 1>(bench, rng);
+    benchStatic<16, 32, 1>(bench, rng);
+    return bench.writeJson() ? 0 : 1;
+}
@@ -0,0 +1,442 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <random>
+#include <stdio.h>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+// Side-by-side benchmark of nnlcpp's nnl and the Go nnl. Both are run as child processes on the
+// same topologies, seed, learning rate, epoch count and CSV dataset, each training per sample in
+// file order, and their final losses are checked against each other. The two draw their initial
+// weights from different generators and ranges, so the same seed starts them at different points
+// and the losses are only expected to agree within --tolerance. Startup is the wall time of a
+// run without training (process start, loading the data, one evaluation pass and exit); training
+// throughput is taken from the extra wall time a training run needs over that, so both are
+// measured the same way from outside. Peak RSS comes from wait4. Progress goes to stderr as a table
+// and the results to stdout (or --output) as JSON. Everything runs locally; build the Go binary
+// first with (cd nnl && go build -o /tmp/nnl-go .).
+
+namespace {
+
+struct Options {
+    std::string                        cpp_path;             // nnlcpp's nnl; next to this binary by default
+    std::string                        go_path;              // The Go nnl binary
+    std::string                        data_path;            // Shared CSV; generated per topology when empty
+    std::vector<std::vector<uint32_t>> topologies;           // inputs,hidden,outputs each
+    uint32_t                           epochs = 20;          // Passes over the dataset
+    uint32_t                           samples = 512;        // Rows of a generated dataset
+    uint64_t                           seed = 1;             // Network initialisation and generated data
+    float                              learning_rate = 0.1f;
+    uint32_t                           repeats = 3;          // Runs per measurement; medians are reported
+    double                             tolerance = 0.02;     // Largest accepted difference of final MSE
+    std::string                        output;               // JSON destination; stdout when empty
+};
+
+struct Run {
+    bool        ok = false;
+    double      seconds = 0.0;
+    long        peak_rss_kb = 0;
+    std::string output;
+};
+
+// Run argv to completion with its stdout captured and stderr discarded
+Run runProcess(const std::vector<std::string>& argv) {
+    Run                result;
+    std::vector<char*> args;
+    for (const std::string& arg : argv) {
+        args.push_back(const_cast<char*>(arg.c_str()));
+    }
+    args.push_back(nullptr);
+
+    int pipe_fds[2];
+    if (pipe(pipe_fds) != 0)
+        return result;
+
+    auto  start = std::chrono::steady_clock::now();
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(pipe_fds[0]);
+        close(pipe_fds[1]);
+        return result;
+    }
+    if (pid == 0) {
+        dup2(pipe_fds[1], STDOUT_FILENO);
+        int null_fd = open("/dev/null", O_WRONLY);
+        if (null_fd >= 0)
+            dup2(null_fd, STDERR_FILENO);
+        close(pipe_fds[0]);
+        close(pipe_fds[1]);
+        execv(args[0], args.data());
+        _exit(127);
+    }
+
+    close(pipe_fds[1]);
+    char    buffer[4096];
+    ssize_t received;
+    while ((received = read(pipe_fds[0], buffer, sizeof(buffer))) > 0) {
+        result.output.append(buffer, static_cast<size_t>(received));
+    }
+    close(pipe_fds[0]);
+
+    int    status = 0;
+    rusage usage = {};
+    if (wait4(pid, &status, 0, &usage) != pid)
+        return result;
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.peak_rss_kb = usage.ru_maxrss;
+    result.ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    return result;
+}
+
+// The MSE of an "Evaluated N samples: MSE x, ..." line, which both implementations print
+bool parseLoss(const std::string& output, double& loss) {
+    size_t at = output.rfind("MSE ");
+    return at != std::string::npos && sscanf(output.c_str() + at, "MSE %lf", &loss) == 1;
+}
+
+double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+std::string joinTopology(const std::vector<uint32_t>& layers) {
+    std::string text;
+    for (size_t i = 0; i < layers.size(); ++i) {
+        text += (i ? "," : "") + std::to_string(layers[i]);
+    }
+    return text;
+}
+
+// A learnable dataset for the given sizes: inputs uniform in [0, 1], and each target 1 when a
+// fixed random projection of the inputs lies above its mean, so about half the targets are set
+bool writeDataset(const std::string& path, uint32_t inputs, uint32_t outputs, uint32_t samples, uint64_t seed) {
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        printf("Error: Cannot open %s for writing.\n", path.c_str());
+        return false;
+    }
+
+    std::mt19937_64                       rng(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::uniform_real_distribution<float> weight(-1.0f, 1.0f);
+    std::vector<float>                    projection(static_cast<size_t>(inputs) * outputs);
+    for (float& w : projection) {
+        w = weight(rng);
+    }
+    std::vector<float> x(inputs);
+    for (uint32_t n = 0; n < samples; ++n) {
+        for (uint32_t k = 0; k < inputs; ++k) {
+            x[k] = unit(rng);
+            fprintf(file, "%s%.4f", k ? "," : "", x[k]);
+        }
+        for (uint32_t j = 0; j < outputs; ++j) {
+            float sum = 0.0f;
+            float mean = 0.0f;
+            for (uint32_t k = 0; k < inputs; ++k) {
+                sum += projection[j * inputs + k] * x[k];
+                mean += 0.5f * projection[j * inputs + k];
+            }
+            fprintf(file, ",%d", sum > mean ? 1 : 0);
+        }
+        fprintf(file, "\n");
+    }
+    return fclose(file) == 0;
+}
+
+// One implementation's measurements on one topology
+struct Measurement {
+    bool   ok = false;
+    double startup_ms = 0.0;
+    double train_seconds = 0.0;  // Median training run, startup included
+    double samples_per_sec = 0.0;
+    long   peak_rss_kb = 0;      // Largest over the training runs
+    double loss = 0.0;
+    bool   deterministic = true; // Every training run ended on the same loss
+};
+
+struct Comparison {
+    std::string topology;
+    uint32_t    samples = 0;
+    Measurement cpp;
+    Measurement go;
+    double      loss_difference = 0.0;
+    bool        agree = false;
+};
+
+// Measure one implementation; argvFor(epochs) gives its command line for a run of that length
+template <typename ArgvFor>
+Measurement measure(const Options& options, uint32_t samples, ArgvFor&& argvFor) {
+    Measurement         result;
+    std::vector<double> startups;
+    std::vector<double> trainings;
+    std::vector<double> losses;
+    for (uint32_t r = 0; r < options.repeats; ++r) {
+        Run    startup = runProcess(argvFor(0));
+        Run    training = runProcess(argvFor(options.epochs));
+        double loss;
+        if (!startup.ok || !training.ok || !parseLoss(training.output, loss)) {
+            const Run& failed = (!startup.ok) ? startup : training;
+            printf("Error: %s failed:\n%s\n", argvFor(options.epochs)[0].c_str(), failed.output.c_str());
+            return result;
+        }
+        startups.push_back(startup.seconds);
+        trainings.push_back(training.seconds);
+        losses.push_back(loss);
+        result.peak_rss_kb = std::max(result.peak_rss_kb, training.peak_rss_kb);
+    }
+
+    result.ok = true;
+    result.startup_ms = 1000.0 * median(startups);
+    result.train_seconds = median(trainings);
+    double training_only = std::max(result.train_seconds - median(startups), 1e-9);
+    result.samples_per_sec = static_cast<double>(options.epochs) * samples / training_only;
+    result.loss = losses.front();
+    result.deterministic =
+        std::all_of(losses.begin(), losses.end(), [&](double loss) { return loss == losses.front(); });
+    return result;
+}
+
+// Generated datasets live here and are removed on exit
+struct WorkDirectory {
+    std::string              path;
+    std::vector<std::string> files;
+
+    ~WorkDirectory() {
+        for (const std::string& file : files) {
+            unlink(file.c_str());
+        }
+        if (!path.empty())
+            rmdir(path.c_str());
+    }
+};
+
+size_t countSamples(const std::string& path) {
+    FILE* file = fopen(path.c_str(), "r");
+    if (file == nullptr)
+        return 0;
+    size_t count = 0;
+    char   line[1 << 16];
+    bool   at_line_start = true;
+    while (fgets(line, sizeof(line), file)) {
+        if (at_line_start && (line[0] == '-' || line[0] == '.' || (line[0] >= '0' && line[0] <= '9')))
+            ++count;
+        at_line_start = std::strchr(line, '\n') != nullptr;
+    }
+    fclose(file);
+    return count;
+}
+
+void printRow(const char* topology, const char* name, const Measurement& m) {
+    fprintf(stderr, "%-18s %-5s %12.1f %14.0f %12.1f %12.6f%s\n", topology, name, m.startup_ms, m.samples_per_sec,
+            m.peak_rss_kb / 1024.0, m.loss, m.deterministic ? "" : " (varies)");
+}
+
+void writeMeasurement(FILE* file, const char* name, const Measurement& m, bool last) {
+    fprintf(file,
+            "        \"%s\": {\"startup_ms\": %.3f, \"train_seconds\": %.4f, \"samples_per_sec\": %.1f, "
+            "\"peak_rss_kb\": %ld, \"loss\": %.6f, \"deterministic\": %s}%s\n",
+            name, m.startup_ms, m.train_seconds, m.samples_per_sec, m.peak_rss_kb, m.loss,
+            m.deterministic ? "true" : "false", last ? "" : ",");
+}
+
+bool writeJson(const Options& options, const std::vector<Comparison>& comparisons) {
+    FILE* file = options.output.empty() ? stdout : fopen(options.output.c_str(), "w");
+    if (file == nullptr) {
+        printf("Error: Cannot open %s for writing.\n", options.output.c_str());
+        return false;
+    }
+
+    fprintf(file, "{\n  \"benchmark\": \"nnl_compare\",\n  \"timestamp\": %lld,\n",
+            static_cast<long long>(std::time(nullptr)));
+    fprintf(file,
+            "  \"config\": {\"epochs\": %u, \"seed\": %llu, \"learning_rate\": %.6f, \"repeats\": %u, "
+            "\"tolerance\": %.6f, \"data\": \"%s\"},\n  \"results\": [\n",
+            options.epochs, static_cast<unsigned long long>(options.seed), options.learning_rate, options.repeats,
+            options.tolerance, options.data_path.empty() ? "generated" : options.data_path.c_str());
+    for (size_t i = 0; i < comparisons.size(); ++i) {
+        const Comparison& c = comparisons[i];
+        fprintf(file, "    {\"topology\": \"%s\", \"samples\": %u,\n", c.topology.c_str(), c.samples);
+        writeMeasurement(file, "cpp", c.cpp, false);
+        writeMeasurement(file, "go", c.go, false);
+        fprintf(file, "        \"speedup\": %.3f, \"loss_difference\": %.6f, \"losses_agree\": %s}%s\n",
+                c.cpp.samples_per_sec / c.go.samples_per_sec, c.loss_difference, c.agree ? "true" : "false",
+                i + 1 < comparisons.size() ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    return file == stdout || fclose(file) == 0;
+}
+
+bool parseTopology(const std::string& text, std::vector<uint32_t>& layers) {
+    layers.clear();
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t end = text.find(',', start);
+        if (end == std::string::npos)
+            end = text.size();
+        int size = std::atoi(text.substr(start, end - start).c_str());
+        if (size <= 0)
+            return false;
+        layers.push_back(static_cast<uint32_t>(size));
+        start = end + 1;
+    }
+    return layers.size() == 3;
+}
+
+void printUsage(const char* programName) {
+    printf("USAGE:\n");
+    printf("  %s --go PATH [OPTIONS]\n\n", programName);
+    printf("OPTIONS:\n");
+    printf("  %-20s %s\n", "-h, --help", "Show this help message");
+    printf("  %-20s %s\n", "--go PATH", "The Go nnl binary: (cd nnl && go build -o /tmp/nnl-go .)");
+    printf("  %-20s %s\n", "--cpp PATH", "nnlcpp's nnl (default: next to this binary)");
+    printf("  %-20s %s\n", "--layers A,B,C", "Topology to compare, repeatable; the Go nnl has one hidden layer");
+    printf("  %-20s %s\n", "", "(default 2,4,1 16,32,4 64,128,8 256,256,10)");
+    printf("  %-20s %s\n", "--data PATH", "CSV both train on (default: generated per topology)");
+    printf("  %-20s %s\n", "--samples N", "Rows of a generated dataset (default 512)");
+    printf("  %-20s %s\n", "--epochs N", "Passes over the dataset (default 20)");
+    printf("  %-20s %s\n", "-s, --seed N", "Seed for both networks and the generated data (default 1)");
+    printf("  %-20s %s\n", "-lr R", "Learning rate (default 0.1)");
+    printf("  %-20s %s\n", "--repeats N", "Runs per measurement, medians reported (default 3)");
+    printf("  %-20s %s\n", "--tolerance T", "Largest accepted difference in final MSE (default 0.02)");
+    printf("  %-20s %s\n", "--output PATH", "Write JSON results to PATH instead of stdout");
+}
+
+} // namespace
+
+int main(int argc, char const* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            printUsage(argv[0]);
+            return 0;
+        } else if (arg == "--go" && i + 1 < argc) {
+            options.go_path = argv[++i];
+        } else if (arg == "--cpp" && i + 1 < argc) {
+            options.cpp_path = argv[++i];
+        } else if (arg == "--layers" && i + 1 < argc) {
+            std::vector<uint32_t> layers;
+            if (!parseTopology(argv[++i], layers)) {
+                printf("Error: Topology %s is not inputs,hidden,outputs; the Go nnl has one hidden layer.\n",
+                       argv[i]);
+                return 1;
+            }
+            options.topologies.push_back(layers);
+        } else if (arg == "--data" && i + 1 < argc) {
+            options.data_path = argv[++i];
+        } else if (arg == "--samples" && i + 1 < argc) {
+            options.samples = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--epochs" && i + 1 < argc) {
+            options.epochs = std::max(1, std::stoi(argv[++i]));
+        } else if ((arg == "--seed" || arg == "-s") && i + 1 < argc) {
+            options.seed = std::max(1ull, std::stoull(argv[++i]));
+        } else if (arg == "-lr" && i + 1 < argc) {
+            options.learning_rate = std::stof(argv[++i]);
+        } else if (arg == "--repeats" && i + 1 < argc) {
+            options.repeats = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--tolerance" && i + 1 < argc) {
+            options.tolerance = std::stod(argv[++i]);
+        } else if (arg == "--output" && i + 1 < argc) {
+            options.output = argv[++i];
+        } else {
+            printf("Error: Unknown option %s.\n", arg.c_str());
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (options.go_path.empty()) {
+        printf("Error: --go is required.\n");
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (options.cpp_path.empty()) {
+        std::string self = argv[0];
+        size_t      slash = self.rfind('/');
+        options.cpp_path = (slash == std::string::npos ? std::string(".") : self.substr(0, slash)) + "/nnl";
+    }
+    if (options.topologies.empty()) {
+        options.topologies = {{2, 4, 1}, {16, 32, 4}, {64, 128, 8}, {256, 256, 10}};
+    }
+    for (const std::string& path : {options.cpp_path, options.go_path}) {
+        if (access(path.c_str(), X_OK) != 0) {
+            printf("Error: %s is not an executable.\n", path.c_str());
+            return 1;
+        }
+    }
+
+    WorkDirectory work;
+    if (options.data_path.empty()) {
+        char work_template[] = "/tmp/nnl_compare.XXXXXX";
+        if (mkdtemp(work_template) == nullptr) {
+            printf("Error: Cannot create a working directory.\n");
+            return 1;
+        }
+        work.path = work_template;
+    }
+
+    const std::string seed = std::to_string(options.seed);
+    char              learning_rate[32];
+    snprintf(learning_rate, sizeof(learning_rate), "%g", options.learning_rate);
+
+    fprintf(stderr, "%u epochs, seed %s, learning rate %s, median of %u runs\n", options.epochs, seed.c_str(),
+            learning_rate, options.repeats);
+    fprintf(stderr, "%-18s %-5s %12s %14s %12s %12s\n", "Topology", "Impl", "Startup ms", "Samples/sec",
+            "Peak RSS MB", "Final MSE");
+
+    std::vector<Comparison> comparisons;
+    bool                    all_agree = true;
+    for (const std::vector<uint32_t>& layers : options.topologies) {
+        Comparison comparison;
+        comparison.topology = joinTopology(layers);
+
+        std::string data = options.data_path;
+        if (data.empty()) {
+            data = work.path + "/" + comparison.topology + ".csv";
+            work.files.push_back(data);
+            if (!writeDataset(data, layers.front(), layers.back(), options.samples, options.seed))
+                return 1;
+        }
+        comparison.samples = static_cast<uint32_t>(countSamples(data));
+        if (comparison.samples == 0) {
+            printf("Error: %s holds no samples.\n", data.c_str());
+            return 1;
+        }
+
+        // Per-sample SGD in file order on both sides: batch size 1 and a one-sample shuffle window
+        comparison.cpp = measure(options, comparison.samples, [&](uint32_t epochs) {
+            return std::vector<std::string>{options.cpp_path, "--layers", comparison.topology, "--data", data,
+                                            "-i", std::to_string(epochs), "-s", seed, "-lr", learning_rate,
+                                            "-b", "1", "--shuffle-window", "1"};
+        });
+        comparison.go = measure(options, comparison.samples, [&](uint32_t epochs) {
+            return std::vector<std::string>{options.go_path, "-layers", comparison.topology, "-data", data,
+                                            "-iterations", std::to_string(epochs), "-seed", seed, "-lr",
+                                            learning_rate};
+        });
+        if (!comparison.cpp.ok || !comparison.go.ok)
+            return 1;
+
+        comparison.loss_difference = std::fabs(comparison.cpp.loss - comparison.go.loss);
+        comparison.agree = comparison.loss_difference <= options.tolerance;
+        all_agree = all_agree && comparison.agree;
+        printRow(comparison.topology.c_str(), "cpp", comparison.cpp);
+        printRow("", "go", comparison.go);
+        fprintf(stderr, "%-18s %.2fx samples/sec, losses %s (difference %.6f, tolerance %g)\n", "",
+                comparison.cpp.samples_per_sec / comparison.go.samples_per_sec,
+                comparison.agree ? "agree" : "DISAGREE", comparison.loss_difference, options.tolerance);
+        comparisons.push_back(comparison);
+    }
+
+    if (!writeJson(options, comparisons))
+        return 1;
+    return all_agree ? 0 : 2;
+}
@@ -0,0 +1,211 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <stdio.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// Closed-loop load generator for nnl --serve. Each connection sends one random request, waits for
+// its answer and sends the next, so the number of connections is the number of requests the
+// server can coalesce. Reports throughput and client-side latency percentiles.
+
+namespace {
+
+struct Options {
+    std::string socket_path;
+    uint32_t    connections = 8;     // Concurrent closed-loop clients
+    uint32_t    requests = 10000;    // Per connection
+    uint32_t    warmup = 100;        // Untimed requests per connection
+};
+
+int connectTo(const std::string& path) {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path))
+        return -1;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd >= 0 && connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Send one line and read one line back; false if the connection broke
+bool roundTrip(int fd, const std::string& request, std::string& reply) {
+    for (size_t sent = 0; sent < request.size();) {
+        ssize_t written = send(fd, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+        if (written <= 0)
+            return false;
+        sent += static_cast<size_t>(written);
+    }
+    reply.clear();
+    char c;
+    while (true) {
+        ssize_t received = recv(fd, &c, 1, 0);
+        if (received <= 0)
+            return false;
+        if (c == '\n')
+            return true;
+        reply += c;
+    }
+}
+
+struct ClientResult {
+    std::vector<double> latencies_us;
+    uint64_t            errors = 0;
+};
+
+void runClient(const Options& options, uint32_t input_size, uint32_t seed, std::atomic<uint32_t>& ready,
+               std::atomic<bool>& go, ClientResult& result) {
+    int fd = connectTo(options.socket_path);
+    ready.fetch_add(1);
+    if (fd < 0) {
+        result.errors = options.requests;
+        return;
+    }
+
+    std::mt19937                          rng(seed);
+    std::uniform_real_distribution<float> value(0.0f, 1.0f);
+    std::string                           request;
+    std::string                           reply;
+    char                                  number[32];
+    auto                                  next = [&] {
+        request.clear();
+        for (uint32_t i = 0; i < input_size; ++i) {
+            snprintf(number, sizeof(number), "%s%.4f", i ? "," : "", value(rng));
+            request += number;
+        }
+        request += '\n';
+    };
+
+    for (uint32_t i = 0; i < options.warmup; ++i) {
+        next();
+        roundTrip(fd, request, reply);
+    }
+    while (!go.load()) {
+        std::this_thread::yield();
+    }
+
+    result.latencies_us.reserve(options.requests);
+    for (uint32_t i = 0; i < options.requests; ++i) {
+        next();
+        auto start = std::chrono::steady_clock::now();
+        bool ok = roundTrip(fd, request, reply);
+        auto end = std::chrono::steady_clock::now();
+        if (!ok) {
+            result.errors += options.requests - i;
+            break;
+        }
+        if (reply.rfind("error", 0) == 0) {
+            ++result.errors;
+            continue;
+        }
+        result.latencies_us.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+    }
+    close(fd);
+}
+
+void printUsage(const char* programName) {
+    printf("USAGE:\n");
+    printf("  %s --socket PATH [OPTIONS]\n\n", programName);
+    printf("OPTIONS:\n");
+    printf("  %-20s %s\n", "-h, --help", "Show this help message");
+    printf("  %-20s %s\n", "--socket PATH", "Socket of a running nnl --serve");
+    printf("  %-20s %s\n", "--connections N", "Concurrent closed-loop clients (default 8)");
+    printf("  %-20s %s\n", "--requests N", "Timed requests per connection (default 10000)");
+    printf("  %-20s %s\n", "--warmup N", "Untimed requests per connection (default 100)");
+}
+
+} // namespace
+
+int main(int argc, char const* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            printUsage(argv[0]);
+            return 0;
+        } else if (arg == "--socket" && i + 1 < argc) {
+            options.socket_path = argv[++i];
+        } else if (arg == "--connections" && i + 1 < argc) {
+            options.connections = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--requests" && i + 1 < argc) {
+            options.requests = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--warmup" && i + 1 < argc) {
+            options.warmup = std::max(0, std::stoi(argv[++i]));
+        } else {
+            printf("Error: Unknown option %s.\n", arg.c_str());
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (options.socket_path.empty()) {
+        printf("Error: --socket is required.\n");
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // Ask the server for its input size
+    int         probe = connectTo(options.socket_path);
+    std::string reply;
+    uint32_t    input_size = 0;
+    uint32_t    output_size = 0;
+    if (probe < 0 || !roundTrip(probe, "?\n", reply) ||
+        sscanf(reply.c_str(), "inputs %u outputs %u", &input_size, &output_size) != 2) {
+        printf("Error: No nnl server answering on %s.\n", options.socket_path.c_str());
+        if (probe >= 0)
+            close(probe);
+        return 1;
+    }
+    close(probe);
+
+    std::vector<ClientResult> results(options.connections);
+    std::vector<std::thread>  clients;
+    std::atomic<uint32_t>     ready{0};
+    std::atomic<bool>         go{false};
+    for (uint32_t c = 0; c < options.connections; ++c) {
+        clients.emplace_back(runClient, std::cref(options), input_size, 1000 + c, std::ref(ready), std::ref(go),
+                             std::ref(results[c]));
+    }
+    while (ready.load() < options.connections) {
+        std::this_thread::yield();
+    }
+    auto start = std::chrono::steady_clock::now();
+    go.store(true);
+    for (auto& client : clients) {
+        client.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<double> latencies;
+    uint64_t            errors = 0;
+    for (const ClientResult& result : results) {
+        latencies.insert(latencies.end(), result.latencies_us.begin(), result.latencies_us.end());
+        errors += result.errors;
+    }
+    if (latencies.empty()) {
+        printf("Error: No request succeeded (%llu errors).\n", static_cast<unsigned long long>(errors));
+        return 1;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](double q) {
+        return latencies[static_cast<size_t>(std::ceil(q * latencies.size())) - 1];
+    };
+
+    printf("%u connections, %zu requests of %u inputs in %.3f s, %llu errors\n", options.connections,
+           latencies.size(), input_size, seconds, static_cast<unsigned long long>(errors));
+    printf("Throughput: %.0f requests/s\n", latencies.size() / seconds);
+    printf("Latency: p50 %.1f us, p99 %.1f us, p99.9 %.1f us, max %.1f us\n", percentile(0.50), percentile(0.99),
+           percentile(0.999), latencies.back());
+    return errors ? 1 : 0;
+}
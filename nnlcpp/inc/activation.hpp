@@ -0,0 +1,130 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace nnlcpp {
+
+// Activation function of a dense layer. Every one of these has a derivative that can be
+// written in terms of its own output, so the backward pass only needs the stored activations.
+enum class Activation : uint8_t {
+    Sigmoid,      // 1 / (1 + exp(-z)); SIMD kernels use a polynomial exp accurate to about 2 ulp
+    SigmoidPoly,  // Piecewise-cubic sigmoid, absolute error below 3.5e-4
+    SigmoidTable, // Interpolated lookup-table sigmoid, absolute error below 4e-6
+    Tanh,
+    Relu,
+    LeakyRelu,    // Slope 0.01 below zero
+};
+constexpr size_t ACTIVATION_COUNT = 6;
+
+// Command line names: sigmoid, sigmoid-poly, sigmoid-lut, tanh, relu, leaky-relu
+const char*               activationName(Activation activation);
+std::optional<Activation> parseActivation(const std::string& name);
+
+// Scalar policies, one per Activation. apply(z) is the activation and derivative(y) its
+// derivative expressed through the output y = apply(z). The SIMD kernels implement the same
+// functions lane-wise, sharing the constants below.
+namespace activation {
+
+constexpr float LEAKY_RELU_SLOPE = 0.01f;
+
+// SigmoidPoly: on |z| in [k, k + 1), k = 0..7, sigmoid is the cubic Hermite interpolant through
+// the exact values and slopes at both ends, c0 + c1 t + c2 t^2 + c3 t^3 with t = |z| - k. It is
+// 1 beyond |z| = 8 and mirrored as 1 - p for negative z. The error peaks at 3.36e-4, from the
+// saturation just past 8.
+constexpr float  SIGMOID_POLY_LIMIT = 8.0f;
+constexpr size_t SIGMOID_POLY_PIECES = 8;
+constexpr float  SIGMOID_POLY_COEFFICIENTS[4][SIGMOID_POLY_PIECES] = {
+    {5.000000000e-01f, 7.310585976e-01f, 8.807970881e-01f, 9.525741339e-01f, 9.820137620e-01f, 9.933071733e-01f,
+     9.975273609e-01f, 9.990889430e-01f},
+    {2.500000000e-01f, 1.966119260e-01f, 1.049935818e-01f, 4.517665878e-02f, 1.766270585e-02f, 6.648056675e-03f,
+     2.466509352e-03f, 9.102211916e-04f},
+    {-3.436197294e-03f, -4.900195450e-02f, -3.983268514e-02f, -1.969703659e-02f, -8.093391545e-03f,
+     -3.101939335e-03f, -1.158523839e-03f, -4.285768373e-04f},
+    {-1.550522447e-02f, 2.128520049e-03f, 6.616147235e-03f, 3.960039467e-03f, 1.724044792e-03f, 6.741104298e-04f,
+     2.535865351e-04f, 9.405672608e-05f},
+};
+
+// SigmoidTable: sigmoid sampled every 1/64 over [-16, 16] and linearly interpolated, with z
+// clamped to that range. Interpolation error is at most h^2 / 8 * max|sigmoid''| = 2.9e-6; the
+// clamp adds 1.1e-7. The table is 8 KB and stays in L1.
+constexpr float  SIGMOID_TABLE_LIMIT = 16.0f;
+constexpr float  SIGMOID_TABLE_STEPS_PER_UNIT = 64.0f;
+constexpr size_t SIGMOID_TABLE_INTERVALS = 2048;
+extern const std::array<float, SIGMOID_TABLE_INTERVALS + 1> SIGMOID_TABLE;
+
+struct Sigmoid {
+    static float apply(float z) {
+        return 1.0f / (1.0f + std::exp(-z));
+    }
+    static float derivative(float y) {
+        return y * (1.0f - y);
+    }
+};
+
+struct SigmoidPoly {
+    static float apply(float z) {
+        float magnitude = std::fabs(z);
+        float p = 1.0f;
+        if (magnitude < SIGMOID_POLY_LIMIT) {
+            size_t k = static_cast<size_t>(magnitude);
+            float  t = magnitude - static_cast<float>(k);
+            p = ((SIGMOID_POLY_COEFFICIENTS[3][k] * t + SIGMOID_POLY_COEFFICIENTS[2][k]) * t +
+                 SIGMOID_POLY_COEFFICIENTS[1][k]) * t +
+                SIGMOID_POLY_COEFFICIENTS[0][k];
+        }
+        return (z < 0.0f) ? 1.0f - p : p;
+    }
+    static float derivative(float y) {
+        return y * (1.0f - y);
+    }
+};
+
+struct SigmoidTable {
+    static float apply(float z) {
+        float  u = (std::clamp(z, -SIGMOID_TABLE_LIMIT, SIGMOID_TABLE_LIMIT) + SIGMOID_TABLE_LIMIT) *
+                  SIGMOID_TABLE_STEPS_PER_UNIT;
+        size_t i = std::min(static_cast<size_t>(u), SIGMOID_TABLE_INTERVALS - 1);
+        float  t = u - static_cast<float>(i);
+        return SIGMOID_TABLE[i] + t * (SIGMOID_TABLE[i + 1] - SIGMOID_TABLE[i]);
+    }
+    static float derivative(float y) {
+        return y * (1.0f - y);
+    }
+};
+
+struct Tanh {
+    static float apply(float z) {
+        return std::tanh(z);
+    }
+    static float derivative(float y) {
+        return 1.0f - y * y;
+    }
+};
+
+struct Relu {
+    static float apply(float z) {
+        return std::max(z, 0.0f);
+    }
+    static float derivative(float y) {
+        return (y > 0.0f) ? 1.0f : 0.0f;
+    }
+};
+
+struct LeakyRelu {
+    static float apply(float z) {
+        return std::max(z, LEAKY_RELU_SLOPE * z); // Branch-free since the slope is below one
+    }
+    static float derivative(float y) {
+        return (y > 0.0f) ? 1.0f : LEAKY_RELU_SLOPE;
+    }
+};
+
+} // namespace activation
+
+} // namespace nnlcpp
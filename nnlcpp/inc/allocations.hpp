@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstdint>
+
+namespace nnlcpp {
+
+// Heap allocation counter. Linking this in replaces the global operator new with one that
+// counts every call per thread, so hot paths can be checked for stray allocations.
+class Allocations {
+public:
+    // Allocations made by the calling thread since it started
+    static uint64_t count();
+};
+
+} // namespace nnlcpp
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "transport.hpp"
+
+namespace nnlcpp {
+
+// Ring all-reduce: leaves the sum of every rank's values on all of them. The values are cut into
+// one chunk per rank. In the first ranks - 1 steps each rank passes one chunk on and adds the one
+// it receives, after which every chunk's full sum sits on a single rank; in the next ranks - 1
+// steps those finished chunks travel once around the ring. Each rank sends 2 (ranks - 1) / ranks
+// of the values however many ranks there are, and since every chunk is summed in one place and
+// then copied, all ranks end up with bitwise identical results.
+class RingAllReduce {
+private:
+    Transport&                            m_transport;
+    std::vector<float>                    m_incoming;
+    uint64_t                              m_bytes_sent = 0;
+    std::chrono::steady_clock::time_point m_arrived;
+
+public:
+    explicit RingAllReduce(Transport& transport);
+
+    // In place; every rank must call this with the same number of values
+    bool     sum(std::span<float> values);
+    uint64_t getBytesSent() const {
+        return m_bytes_sent;
+    }
+    // When the first chunk of the last sum came in. Before that this rank was waiting for its
+    // neighbours to reach the same sum; from then on the ring was moving data.
+    std::chrono::steady_clock::time_point getLastArrival() const {
+        return m_arrived;
+    }
+};
+
+} // namespace nnlcpp
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "dataset.hpp"
+
+namespace nnlcpp {
+
+// Background input pipeline: a producer thread streams samples from a Dataset, shuffles them
+// within a sliding window and assembles whole batches into a ring of preallocated slots, so the
+// trainer only ever waits when the pipeline genuinely cannot keep up.
+class BatchLoader {
+public:
+    struct Batch {
+        std::vector<float> inputs;  // size x input size, one sample per row
+        std::vector<float> outputs; // size x output size, one sample per row
+        uint32_t           size = 0;
+        bool               last_in_epoch = false;
+    };
+
+    struct Stats {
+        uint64_t samples = 0;       // Samples delivered to the trainer
+        uint64_t bytes = 0;         // Bytes read from the dataset file
+        double   load_seconds = 0;  // Producer time spent reading, shuffling and packing
+        double   stall_seconds = 0; // Trainer time spent blocked in next()
+        uint64_t stalls = 0;        // Calls to next() that had to wait
+    };
+
+private:
+    Dataset&                m_dataset;
+    uint32_t                m_batch_size;
+    size_t                  m_window_size;
+    std::mt19937_64         m_rng;
+    std::vector<Batch>      m_ring;
+    size_t                  m_head = 0;        // Next slot the producer fills
+    size_t                  m_tail = 0;        // Next slot the consumer takes
+    size_t                  m_filled = 0;      // Slots ready for the consumer
+    bool                    m_holding = false; // Consumer still holds the slot it was last given
+    bool                    m_stop = false;
+    mutable std::mutex      m_mutex;
+    std::condition_variable m_ready;
+    std::condition_variable m_free;
+    Stats                   m_stats;
+    std::atomic<double>     m_load_seconds{0.0};
+    std::thread             m_producer;
+
+    void produce();
+
+public:
+    BatchLoader(Dataset& dataset, uint32_t batch_size, size_t window_size = 65536, size_t ring_size = 4,
+                uint64_t seed = 0);
+    ~BatchLoader();
+
+    BatchLoader(const BatchLoader&) = delete;
+    BatchLoader& operator=(const BatchLoader&) = delete;
+
+    // Block until the next batch is ready. The batch stays valid until the following call, which
+    // hands its slot back to the producer. Epochs repeat forever; last_in_epoch marks the
+    // (possibly short) final batch of each pass, and an empty dataset yields empty batches.
+    const Batch& next();
+
+    Stats getStats() const;
+};
+
+} // namespace nnlcpp
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "neuralnetwork.hpp"
+
+namespace nnlcpp {
+
+// Versioned binary checkpoint: everything needed to carry on training where a run left off.
+// Same conventions as a model file, little-endian with every array on a 64-byte boundary:
+//
+//   CheckpointHeader                      128 bytes
+//   uint32_t topology[layer_count + 1]    neurons per layer, input first
+//   uint8_t  activations[layer_count]     Activation of each layer
+//   ParameterArena image                  weights and biases
+//   ParameterArena image                  optimizer first state, if the rule keeps one
+//   ParameterArena image                  optimizer second state (Adam)
+struct CheckpointHeader {
+    char     magic[8];      // "NNLCHKPT"
+    uint32_t version;       // CHECKPOINT_FILE_VERSION
+    uint32_t byte_order;    // 0x01020304 as written by the producer
+    uint32_t layer_count;   // Number of weight layers
+    float    learning_rate;
+    uint64_t file_size;     // Total size, checked against the file on load
+    uint64_t epoch;         // Epochs completed when the snapshot was taken
+    uint64_t steps;         // Optimizer steps taken
+    uint8_t  optimizer;     // Optimizer
+    uint8_t  state_count;   // Optimizer state arenas that follow the parameters
+    uint8_t  padding[2];
+    float    momentum;      // OptimizerSettings
+    float    rho;
+    float    beta1;
+    float    beta2;
+    float    epsilon;
+    uint8_t  reserved[56];
+};
+static_assert(sizeof(CheckpointHeader) == 128, "checkpoint header must stay 128 bytes");
+
+constexpr uint32_t CHECKPOINT_FILE_VERSION = 1;
+
+// A copy of a network's parameters and optimizer state. The arenas are allocated once up front,
+// so capturing is a memcpy per arena and nothing else.
+struct TrainingSnapshot {
+    ParameterArena          parameters;
+    ParameterArena          first;  // Empty when the optimizer keeps no such state
+    ParameterArena          second;
+    std::vector<Activation> activations;
+    float                   learning_rate = 0.0f;
+    OptimizerSettings       optimizer;
+    uint64_t                steps = 0;
+    uint64_t                epoch = 0;
+
+    TrainingSnapshot() = default;
+    // Allocate for network's topology and optimizer without copying anything yet
+    explicit TrainingSnapshot(const NeuralNetwork& network);
+
+    void capture(const NeuralNetwork& network, uint64_t epoch);
+};
+
+class CheckpointFile {
+public:
+    // Write next to path, fsync, and rename over it, so a crash leaves either the old or the new
+    // checkpoint and never a torn one
+    static bool save(const TrainingSnapshot& snapshot, const std::string& path);
+
+    struct Checkpoint {
+        NeuralNetwork network; // Owns its parameters and carries the restored optimizer
+        uint64_t      epoch;
+    };
+    static std::optional<Checkpoint> load(const std::string& path);
+};
+
+// Periodic checkpoints that cost the trainer one memcpy of the parameters and optimizer state.
+// Two snapshots alternate: the trainer captures into the one the background writer is not busy
+// with, and the writer serialises and fsyncs the other, so training never waits for the disk. A
+// checkpoint that comes due while the previous one is still queued replaces it. Synchronous mode
+// writes on the trainer's thread instead, as a baseline.
+class Checkpointer {
+public:
+    struct Stats {
+        uint64_t captured = 0;         // Snapshots taken
+        uint64_t written = 0;          // Snapshots that reached disk
+        uint64_t superseded = 0;       // Queued snapshots replaced by a newer one before being written
+        uint64_t failures = 0;         // Writes that failed
+        double   stall_seconds = 0;    // Trainer time spent checkpointing
+        double   max_stall_seconds = 0;
+        double   write_seconds = 0;    // Serialising and fsyncing, on whichever thread did it
+    };
+
+private:
+    std::string             m_path;
+    uint32_t                m_interval;
+    uint64_t                m_epoch;
+    bool                    m_synchronous;
+    TrainingSnapshot        m_snapshots[2];
+    int                     m_queued = -1;  // Snapshot waiting for the writer
+    int                     m_writing = -1; // Snapshot the writer is busy with
+    bool                    m_stop = false;
+    mutable std::mutex      m_mutex;
+    std::condition_variable m_work;
+    std::condition_variable m_idle;
+    Stats                   m_stats;
+    std::thread             m_writer;
+
+    void write();
+    void record(bool ok, double seconds);
+
+public:
+    // Checkpoint network to path every interval epochs, counting from first_epoch
+    Checkpointer(const NeuralNetwork& network, std::string path, uint32_t interval, uint64_t first_epoch = 0,
+                 bool synchronous = false);
+    // Writes any queued checkpoint before returning
+    ~Checkpointer();
+
+    Checkpointer(const Checkpointer&) = delete;
+    Checkpointer& operator=(const Checkpointer&) = delete;
+
+    // Count one finished epoch and take a snapshot if a checkpoint is due
+    void epochDone(const NeuralNetwork& network);
+    // Block until every snapshot taken so far is on disk
+    void flush();
+
+    Stats getStats() const;
+    void  printReport() const;
+};
+
+} // namespace nnlcpp
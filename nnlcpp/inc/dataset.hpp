@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mappedfile.hpp"
+
+namespace nnlcpp {
+
+// Binary sample file: this 64-byte header followed by sample_count packed records, each holding
+// input_size input floats then output_size expected-output floats, little-endian.
+struct DatasetFileHeader {
+    char     magic[8];     // "NNLDATA\0"
+    uint32_t version;      // DATASET_FILE_VERSION
+    uint32_t byte_order;   // 0x01020304 as written by the producer
+    uint64_t sample_count;
+    uint32_t input_size;
+    uint32_t output_size;
+    uint8_t  reserved[32];
+};
+static_assert(sizeof(DatasetFileHeader) == 64, "dataset header must stay 64 bytes");
+
+constexpr uint32_t DATASET_FILE_VERSION = 1;
+
+// Sequential source of training samples that never needs the whole set in memory
+class Dataset {
+public:
+    virtual ~Dataset() = default;
+
+    virtual uint32_t getInputSize() const = 0;
+    virtual uint32_t getOutputSize() const = 0;
+    // Total bytes consumed from the underlying file since construction
+    virtual uint64_t getBytesRead() const = 0;
+
+    // Read up to count samples from the current position, one sample per row of inputs and
+    // outputs. Returns the number read; 0 means the end of the dataset.
+    virtual size_t read(float* inputs, float* outputs, size_t count) = 0;
+    // Restart from the first sample
+    virtual void rewind() = 0;
+
+    // Open a .csv file (input_size inputs then output_size outputs per line) or a binary
+    // dataset file. The sizes must match the network; returns nullptr on error.
+    static std::unique_ptr<Dataset> open(const std::string& path, uint32_t input_size, uint32_t output_size);
+    // Stream every sample of source into a binary dataset file
+    static bool writeBinary(Dataset& source, const std::string& path);
+};
+
+// Binary dataset read through a read-only mapping; the kernel pages records in on demand
+class BinaryDataset : public Dataset {
+private:
+    std::shared_ptr<MappedFile> m_mapping;
+    const float*                m_records = nullptr;
+    uint64_t                    m_sample_count = 0;
+    uint64_t                    m_position = 0;
+    uint64_t                    m_bytes_read = 0;
+    uint32_t                    m_input_size = 0;
+    uint32_t                    m_output_size = 0;
+
+public:
+    static std::unique_ptr<BinaryDataset> open(const std::string& path);
+
+    uint32_t getInputSize() const override {
+        return m_input_size;
+    }
+    uint32_t getOutputSize() const override {
+        return m_output_size;
+    }
+    uint64_t getBytesRead() const override {
+        return m_bytes_read;
+    }
+    uint64_t getSampleCount() const {
+        return m_sample_count;
+    }
+    size_t read(float* inputs, float* outputs, size_t count) override;
+    void   rewind() override;
+};
+
+// CSV dataset parsed from fixed-size chunked reads, so memory use is independent of file size
+class CsvDataset : public Dataset {
+private:
+    FILE*             m_file = nullptr;
+    std::vector<char> m_chunk;        // Raw bytes read from the file
+    size_t            m_chunk_begin = 0;
+    size_t            m_chunk_end = 0;
+    uint64_t          m_bytes_read = 0;
+    uint64_t          m_line = 0;
+    uint32_t          m_input_size;
+    uint32_t          m_output_size;
+    std::string       m_path;
+
+    bool nextLine(std::string& line);
+
+public:
+    CsvDataset(FILE* file, const std::string& path, uint32_t input_size, uint32_t output_size);
+    ~CsvDataset() override;
+
+    CsvDataset(const CsvDataset&) = delete;
+    CsvDataset& operator=(const CsvDataset&) = delete;
+
+    static std::unique_ptr<CsvDataset> open(const std::string& path, uint32_t input_size, uint32_t output_size);
+
+    uint32_t getInputSize() const override {
+        return m_input_size;
+    }
+    uint32_t getOutputSize() const override {
+        return m_output_size;
+    }
+    uint64_t getBytesRead() const override {
+        return m_bytes_read;
+    }
+    size_t read(float* inputs, float* outputs, size_t count) override;
+    void   rewind() override;
+};
+
+} // namespace nnlcpp
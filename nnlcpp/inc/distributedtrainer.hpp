@@ -0,0 +1,85 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "allreduce.hpp"
+#include "gradients.hpp"
+#include "neuralnetwork.hpp"
+#include "transport.hpp"
+#include "workspace.hpp"
+
+namespace nnlcpp {
+
+// Data-parallel training across ranks. Every rank holds a replica of the network and trains on
+// its own part of each global batch; the gradients are summed over the ranks with a ring
+// all-reduce and every rank applies the same update, so replicas that start equal stay equal.
+// The all-reduce runs on a communication thread one layer at a time, starting as soon as the
+// backward pass has finished a layer's gradients, so it overlaps with computing the layers
+// before it.
+class DistributedTrainer {
+public:
+    // After the backward pass a step waits for its last layers to be summed. That wait is split
+    // into all-reduce transfers the backward pass did not hide, and everything else: mostly ranks
+    // that are behind and have yet to reach the same layer.
+    struct Stats {
+        uint64_t steps = 0;
+        uint64_t samples = 0;                 // Trained on by this rank
+        uint64_t bytes_sent = 0;
+        double   compute_seconds = 0;         // Forward and backward passes
+        double   communication_seconds = 0;   // All-reducing, on the communication thread
+        double   synchronization_seconds = 0; // Of that, waiting for the neighbours to reach the same layer
+        double   exposed_seconds = 0;         // All-reduce transfers left after the backward pass
+        double   stall_seconds = 0;           // The rest of the wait after the backward pass
+    };
+
+private:
+    // When a layer's all-reduce was moving data
+    struct Transfer {
+        std::chrono::steady_clock::time_point start;
+        std::chrono::steady_clock::time_point end;
+    };
+
+    NeuralNetwork&          m_network;
+    RingAllReduce           m_reduce;
+    Workspace               m_workspace;
+    Gradients               m_gradients;
+    std::mutex              m_mutex;
+    std::condition_variable m_work;
+    std::condition_variable m_done;
+    size_t                  m_ready = 0;   // Layers of this step handed over, output layer first
+    size_t                  m_reduced = 0; // Of those, layers already summed over the ranks
+    std::vector<Transfer>   m_transfers;   // This step's, in the order the layers were summed
+    bool                    m_failed = false;
+    bool                    m_stop = false;
+    Stats                   m_stats;
+    std::thread             m_communicator;
+
+    void communicate();
+
+public:
+    DistributedTrainer(NeuralNetwork& network, Transport& transport, uint32_t batch_size);
+    ~DistributedTrainer();
+
+    DistributedTrainer(const DistributedTrainer&) = delete;
+    DistributedTrainer& operator=(const DistributedTrainer&) = delete;
+
+    // One step on this rank's batch_size samples, one per row, of a global batch of
+    // global_batch_size samples. Every rank must take part in every step; a rank without samples
+    // left passes batch_size 0 and contributes zero gradients.
+    bool trainBatch(const float* inputs, const float* expected_outputs, uint32_t batch_size,
+                    uint32_t global_batch_size);
+    // Sum values over every rank, e.g. statistics; only between steps
+    bool sumAcrossRanks(std::span<float> values);
+
+    const Stats& getStats() const {
+        return m_stats;
+    }
+};
+
+} // namespace nnlcpp
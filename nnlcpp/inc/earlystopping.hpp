@@ -0,0 +1,98 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+
+namespace nnlcpp {
+
+// Mean squared error and thresholded accuracy accumulated over any number of outputs, e.g. one
+// epoch's batches
+struct LossTally {
+    double   squared_error = 0.0;
+    uint64_t correct = 0; // Outputs on the same side of 0.5 as expected
+    uint64_t outputs = 0;
+
+    void add(const float* values, const float* expected, size_t n);
+    double loss() const {
+        return outputs ? squared_error / static_cast<double>(outputs) : 0.0;
+    }
+    double accuracy() const {
+        return outputs ? static_cast<double>(correct) / static_cast<double>(outputs) : 0.0;
+    }
+};
+
+// Convergence criteria for a training run, checked once per epoch: stop when the loss reaches a
+// target, or when it has stopped improving for `patience` epochs. It also records when the loss
+// and accuracy targets were first met, so optimizers can be compared by time to target rather
+// than by a fixed iteration count.
+class EarlyStopping {
+public:
+    struct Settings {
+        double   target_loss = 0.0;      // Stop once the loss is at or below this; 0 disables
+        double   target_accuracy = 1.0;  // Accuracy (0-1) whose first arrival is recorded
+        uint32_t patience = 0;           // Stop after this many epochs without improvement; 0 disables
+        double   min_improvement = 1e-7; // Smaller loss drops don't count as improvement
+    };
+
+    enum class Reason : uint8_t {
+        None,       // Still running, or ended by its iteration limit
+        TargetLoss, // The loss reached the target
+        Plateau,    // No improvement for `patience` epochs
+    };
+
+    // When a target was first met, counted from construction or restart()
+    struct Milestone {
+        uint64_t epoch;
+        double   seconds;
+    };
+
+private:
+    Settings                              m_settings;
+    std::chrono::steady_clock::time_point m_start;
+    uint64_t                              m_epochs = 0;
+    double                                m_loss = 0.0;
+    double                                m_accuracy = 0.0;
+    double                                m_best_loss = std::numeric_limits<double>::infinity();
+    uint32_t                              m_stale_epochs = 0;
+    Reason                                m_reason = Reason::None;
+    std::optional<Milestone>              m_loss_reached;
+    std::optional<Milestone>              m_accuracy_reached;
+
+public:
+    explicit EarlyStopping(const Settings& settings);
+
+    // Forget every epoch and restart the clock
+    void restart();
+    // Record one epoch's loss and accuracy; true once training should stop
+    bool update(double loss, double accuracy);
+
+    const Settings& getSettings() const {
+        return m_settings;
+    }
+    Reason getReason() const {
+        return m_reason;
+    }
+    uint64_t getEpochs() const {
+        return m_epochs;
+    }
+    double getLoss() const {
+        return m_loss;
+    }
+    double getAccuracy() const {
+        return m_accuracy;
+    }
+    const std::optional<Milestone>& lossReached() const {
+        return m_loss_reached;
+    }
+    const std::optional<Milestone>& accuracyReached() const {
+        return m_accuracy_reached;
+    }
+
+    // One paragraph: why the run ended and the time and epochs to each target
+    void printReport() const;
+};
+
+} // namespace nnlcpp
@@ -0,0 +1,255 @@
+#pragma once
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <span>
+#include <stdio.h>
+#include <vector>
+
+namespace nnlcpp {
+
+// Lazy element-wise expressions over float arrays. Operators on expressions build a tree of small
+// value types instead of computing anything, and evaluate() then runs the whole tree in one loop
+// into a destination, so  w + lr * delta * x  reads each operand once and allocates nothing.
+// Operands whose sizes are known at compile time (std::array, fixed-extent spans) are checked
+// with static_assert; the rest are checked once before the loop, and a mismatch is reported with
+// both sizes. The expression only refers to its operands, so it must be evaluated before they go.
+namespace expression {
+
+inline constexpr size_t DYNAMIC = std::dynamic_extent;
+
+// The first pair of operand sizes in a tree that disagree
+struct Mismatch {
+    bool   found = false;
+    size_t left = 0;
+    size_t right = 0;
+};
+
+template <typename E>
+concept Expression = requires(const E& e, size_t i) {
+    { e[i] } -> std::convertible_to<float>;
+    { e.size() } -> std::convertible_to<size_t>;
+    { e.mismatch() } -> std::same_as<Mismatch>;
+    { E::EXTENT } -> std::convertible_to<size_t>;
+    { E::SCALAR } -> std::convertible_to<bool>;
+};
+
+// Leaf over existing values
+template <size_t Extent>
+class Values {
+private:
+    std::span<const float, Extent> m_values;
+
+public:
+    static constexpr size_t EXTENT = Extent;
+    static constexpr bool   SCALAR = false;
+
+    explicit Values(std::span<const float, Extent> values) : m_values(values) {}
+
+    float operator[](size_t i) const {
+        return m_values[i];
+    }
+    size_t size() const {
+        return m_values.size();
+    }
+    Mismatch mismatch() const {
+        return {};
+    }
+};
+
+// A constant broadcast to whatever size the rest of the expression has
+class Scalar {
+private:
+    float m_value;
+
+public:
+    static constexpr size_t EXTENT = DYNAMIC;
+    static constexpr bool   SCALAR = true;
+
+    explicit Scalar(float value) : m_value(value) {}
+
+    float operator[](size_t) const {
+        return m_value;
+    }
+    size_t size() const {
+        return 0;
+    }
+    Mismatch mismatch() const {
+        return {};
+    }
+};
+
+template <typename Op, Expression L, Expression R>
+class Binary {
+private:
+    static_assert(L::EXTENT == DYNAMIC || R::EXTENT == DYNAMIC || L::EXTENT == R::EXTENT,
+                  "Element-wise operands differ in size");
+
+    L        m_left;
+    R        m_right;
+    Mismatch m_mismatch;
+
+public:
+    static constexpr size_t EXTENT = (L::EXTENT != DYNAMIC) ? L::EXTENT : R::EXTENT;
+    static constexpr bool   SCALAR = L::SCALAR && R::SCALAR;
+
+    Binary(L left, R right) : m_left(left), m_right(right) {
+        m_mismatch = m_left.mismatch();
+        if (!m_mismatch.found)
+            m_mismatch = m_right.mismatch();
+        if (!m_mismatch.found && !L::SCALAR && !R::SCALAR && m_left.size() != m_right.size())
+            m_mismatch = {true, m_left.size(), m_right.size()};
+    }
+
+    float operator[](size_t i) const {
+        return Op::apply(m_left[i], m_right[i]);
+    }
+    size_t size() const {
+        return L::SCALAR ? m_right.size() : m_left.size();
+    }
+    Mismatch mismatch() const {
+        return m_mismatch;
+    }
+};
+
+// f applied to every element, for the functions operators cannot spell
+template <typename F, Expression E>
+class Map {
+private:
+    E m_operand;
+    F m_function;
+
+public:
+    static constexpr size_t EXTENT = E::EXTENT;
+    static constexpr bool   SCALAR = E::SCALAR;
+
+    Map(E operand, F function) : m_operand(operand), m_function(function) {}
+
+    float operator[](size_t i) const {
+        return m_function(m_operand[i]);
+    }
+    size_t size() const {
+        return m_operand.size();
+    }
+    Mismatch mismatch() const {
+        return m_operand.mismatch();
+    }
+};
+
+struct Add {
+    static float apply(float a, float b) {
+        return a + b;
+    }
+};
+
+struct Subtract {
+    static float apply(float a, float b) {
+        return a - b;
+    }
+};
+
+struct Multiply {
+    static float apply(float a, float b) {
+        return a * b;
+    }
+};
+
+// Division by zero yields zero, matching Matrix::divide
+struct Divide {
+    static float apply(float a, float b) {
+        return (b != 0.0f) ? a / b : 0.0f;
+    }
+};
+
+template <size_t Extent>
+Values<Extent> values(std::span<const float, Extent> values) {
+    return Values<Extent>(values);
+}
+
+template <size_t Extent>
+Values<Extent> values(std::span<float, Extent> values) {
+    return Values<Extent>(values);
+}
+
+template <size_t N>
+Values<N> values(const std::array<float, N>& values) {
+    return Values<N>(std::span<const float, N>(values));
+}
+
+inline Values<DYNAMIC> values(const std::vector<float>& values) {
+    return Values<DYNAMIC>(std::span<const float>(values));
+}
+
+template <Expression E, typename F>
+Map<F, E> map(E operand, F function) {
+    return Map<F, E>(operand, function);
+}
+
+// Each operator takes two expressions or an expression and a float on either side
+#define NNL_EXPRESSION_OPERATOR(symbol, Op)                                                                     \
+    template <Expression L, Expression R>                                                                      \
+    Binary<Op, L, R> operator symbol(L left, R right) {                                                        \
+        return Binary<Op, L, R>(left, right);                                                                  \
+    }                                                                                                          \
+    template <Expression R>                                                                                    \
+    Binary<Op, Scalar, R> operator symbol(float left, R right) {                                               \
+        return Binary<Op, Scalar, R>(Scalar(left), right);                                                     \
+    }                                                                                                          \
+    template <Expression L>                                                                                    \
+    Binary<Op, L, Scalar> operator symbol(L left, float right) {                                               \
+        return Binary<Op, L, Scalar>(left, Scalar(right));                                                     \
+    }
+
+NNL_EXPRESSION_OPERATOR(+, Add)
+NNL_EXPRESSION_OPERATOR(-, Subtract)
+NNL_EXPRESSION_OPERATOR(*, Multiply)
+NNL_EXPRESSION_OPERATOR(/, Divide)
+
+#undef NNL_EXPRESSION_OPERATOR
+
+// out = e in a single pass. out may also be an operand, since element i is only read before it is
+// written. False, with the sizes reported, when the operands or out disagree in size.
+template <size_t Extent, Expression E>
+bool evaluate(std::span<float, Extent> out, const E& e) {
+    static_assert(Extent == DYNAMIC || E::EXTENT == DYNAMIC || Extent == E::EXTENT,
+                  "Expression and destination differ in size");
+    Mismatch mismatch = e.mismatch();
+    if (mismatch.found) {
+        printf("Error: Cannot combine element-wise operands of sizes %zu and %zu.\n", mismatch.left, mismatch.right);
+        return false;
+    }
+    if (!E::SCALAR && e.size() != out.size()) {
+        printf("Error: Cannot evaluate an expression of size %zu into %zu values.\n", e.size(), out.size());
+        return false;
+    }
+
+    for (size_t i = 0; i < out.size(); ++i) {
+        out[i] = e[i];
+    }
+    return true;
+}
+
+template <size_t N, Expression E>
+bool evaluate(std::array<float, N>& out, const E& e) {
+    return evaluate(std::span<float, N>(out), e);
+}
+
+template <Expression E>
+bool evaluate(std::vector<float>& out, const E& e) {
+    return evaluate(std::span<float>(out), e);
+}
+
+// An owned result, for callers that want one; empty on a size mismatch
+template <Expression E>
+std::vector<float> toVector(const E& e) {
+    static_assert(!E::SCALAR, "A scalar expression has no size of its own");
+    std::vector<float> result(e.mismatch().found ? 0 : e.size());
+    if (!evaluate(result, e))
+        return {};
+    return result;
+}
+
+} // namespace expression
+
+} // namespace nnlcpp
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <stdio.h>
+
+namespace nnlcpp {
+
+// Non-owning view of a row-major matrix. The stride is the distance in elements between the
+// start of two consecutive rows, so a view can also describe a sub-block of a larger matrix.
+struct ConstMatrixView {
+    const float* data;
+    size_t       rows;
+    size_t       cols;
+    size_t       stride;
+
+    ConstMatrixView(const float* data, size_t rows, size_t cols)
+          : ConstMatrixView(data, rows, cols, cols) {}
+    ConstMatrixView(const float* data, size_t rows, size_t cols, size_t stride)
+          : data(data),
+            rows(rows),
+            cols(cols),
+            stride(stride) {}
+
+    float operator()(size_t row, size_t col) const {
+        return data[row * stride + col];
+    }
+};
+
+struct MatrixView {
+    float* data;
+    size_t rows;
+    size_t cols;
+    size_t stride;
+
+    MatrixView(float* data, size_t rows, size_t cols)
+          : MatrixView(data, rows, cols, cols) {}
+    MatrixView(float* data, size_t rows, size_t cols, size_t stride)
+          : data(data),
+            rows(rows),
+            cols(cols),
+            stride(stride) {}
+
+    float& operator()(size_t row, size_t col) const {
+        return data[row * stride + col];
+    }
+    operator ConstMatrixView() const {
+        return ConstMatrixView(data, rows, cols, stride);
+    }
+};
+
+enum class Transpose { No, Yes };
+
+class Gemm {
+public:
+    // C = alpha * op(A) * op(B) + beta * C, where op() optionally transposes its operand.
+    // When beta is zero C is treated as uninitialised output. Falls through to the GEMV path
+    // when op(B) is a single column.
+    static bool multiply(float alpha, ConstMatrixView a, Transpose trans_a, ConstMatrixView b, Transpose trans_b,
+                         float beta, MatrixView c);
+
+    // y = alpha * op(A) * x + beta * y, with x and y contiguous.
+    static bool multiplyVector(float alpha, ConstMatrixView a, Transpose trans_a, const float* x, float beta,
+                               float* y);
+};
+
+} // namespace nnlcpp
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "layer.hpp"
+#include "parameterarena.hpp"
+
+namespace nnlcpp {
+
+// Per-layer parameter gradients, held in an arena laid out exactly like the network's
+// parameters so whole-model sweeps over the two line up element for element.
+class Gradients {
+private:
+    ParameterArena m_arena;
+
+public:
+    Gradients() = default;
+    Gradients(const std::vector<Layer>& layers);
+
+    size_t getLayerCount() const {
+        return m_arena.getLayerCount();
+    }
+    const ParameterArena& getArena() const {
+        return m_arena;
+    }
+    std::span<float> weights(size_t layer) {
+        return m_arena.weights(layer);
+    }
+    std::span<float> biases(size_t layer) {
+        return m_arena.biases(layer);
+    }
+    std::span<const float> weights(size_t layer) const {
+        return m_arena.weights(layer);
+    }
+    std::span<const float> biases(size_t layer) const {
+        return m_arena.biases(layer);
+    }
+
+    void zero();
+    // Element-wise accumulate another set of gradients of the same shape into this one
+    bool add(const Gradients& other);
+};
+
+} // namespace nnlcpp
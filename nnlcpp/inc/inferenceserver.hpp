@@ -0,0 +1,121 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "neuralnetwork.hpp"
+#include "workspace.hpp"
+
+namespace nnlcpp {
+
+// Latencies in fixed log-spaced buckets, 16 per power of two (about 6% wide), so a server can
+// record every request for as long as it runs in constant memory
+class LatencyHistogram {
+private:
+    static constexpr int SUB_BUCKETS = 16;
+    static constexpr int BUCKETS = 61 * SUB_BUCKETS;
+
+    std::array<uint64_t, BUCKETS> m_counts = {};
+    uint64_t                      m_total = 0;
+    double                        m_sum_ns = 0.0;
+
+    static size_t   bucketOf(uint64_t ns);
+    static uint64_t lowerBound(size_t bucket);
+
+public:
+    void add(uint64_t ns);
+    // Latency that fraction q of the requests did not exceed, to bucket resolution
+    double percentileNs(double q) const;
+
+    uint64_t getCount() const {
+        return m_total;
+    }
+    double meanNs() const {
+        return m_total ? m_sum_ns / static_cast<double>(m_total) : 0.0;
+    }
+};
+
+// Long-running inference over a line protocol. A request is one line of inputs separated by
+// commas or spaces and is answered by one line of comma-separated outputs, or "error: ..." when
+// it cannot be parsed; a line holding just "?" is answered with "inputs N outputs M". Answers come
+// back in request order on each connection. Requests from every connection are coalesced into
+// micro-batches that flush once max_batch requests are waiting or the oldest has waited
+// max_wait, and each flush is a single predictBatch pass over the network.
+class InferenceServer {
+public:
+    struct Settings {
+        uint32_t max_batch = 64;    // Requests per forward pass at most
+        uint32_t max_wait_us = 200; // Longest a request waits for others to join its batch
+    };
+
+    struct Stats {
+        uint64_t         requests = 0;
+        uint64_t         batches = 0;
+        uint64_t         rejected = 0; // Malformed request lines
+        double           seconds = 0;  // Since the server started
+        LatencyHistogram latency;      // Arrival to answer ready, per request
+    };
+
+private:
+    // One request in flight, owned by the connection that submitted it
+    struct Request {
+        const float*                          input = nullptr;
+        float*                                output = nullptr;
+        std::chrono::steady_clock::time_point arrived;
+        bool                                  done = false;
+    };
+
+    const NeuralNetwork&                  m_network;
+    Settings                              m_settings;
+    uint32_t                              m_input_size;
+    uint32_t                              m_output_size;
+    Workspace                             m_workspace;
+    std::vector<float>                    m_inputs;  // max_batch x input size, packed per flush
+    std::vector<float>                    m_outputs; // max_batch x output size
+    std::vector<Request*>                 m_batch;
+    std::deque<Request*>                  m_queue;
+    bool                                  m_stop = false;
+    mutable std::mutex                    m_mutex;
+    std::condition_variable               m_arrived;
+    std::condition_variable               m_completed;
+    Stats                                 m_stats;
+    std::chrono::steady_clock::time_point m_start;
+    std::thread                           m_batcher;
+
+    void batch();
+    void enqueue(Request& request);
+    void waitFor(Request& request);
+    // Parse a request line into input, or format the answer to a "?" or malformed line into reply
+    bool parse(const std::string& line, std::vector<float>& input, std::string& reply);
+    void formatOutput(const float* output, std::string& reply) const;
+    void serveConnection(int fd);
+
+public:
+    // The network must outlive the server and is only read, never trained
+    InferenceServer(const NeuralNetwork& network, const Settings& settings);
+    ~InferenceServer();
+
+    InferenceServer(const InferenceServer&) = delete;
+    InferenceServer& operator=(const InferenceServer&) = delete;
+
+    // Accept connections on a Unix domain socket at path until stop is set, one thread per
+    // connection. The socket file is replaced if it exists and removed on return.
+    bool serveSocket(const std::string& path, const std::atomic<bool>& stop);
+    // Answer requests read from in on out until in ends. Lines keep being read while earlier
+    // ones wait for their batch, so piped input is batched too.
+    bool serveStream(FILE* in, FILE* out);
+
+    Stats getStats() const;
+    void  printReport() const;
+};
+
+} // namespace nnlcpp
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "activation.hpp"
+#include "optimizer.hpp"
+
+namespace nnlcpp {
+
+// The kernels that depend on a layer's activation f, each compiled with f inlined
+struct ActivationKernels {
+    // out = f(x)
+    void (*activate)(const float* x, float* out, size_t n);
+    // out = delta * f'(z), with f' computed from the activation output y = f(z)
+    void (*multiplyDerivative)(const float* delta, const float* y, float* out, size_t n);
+    // out = f(W x + b) for a row-major rows x cols W: each neuron's dot product, bias and
+    // activation stay in registers and are stored once. When z is not null it also receives the
+    // pre-activation W x + b. x must not alias z or out.
+    void (*dense)(const float* w, const float* x, const float* b, float* z, float* out, size_t rows, size_t cols);
+};
+
+// The update kernels of one Optimizer. Each is a single pass that reads the gradient and the
+// optimizer state and writes the weights and state back, with no temporaries in between. first
+// and second are the optimizer's state arrays, laid out like w; ones it does not use may be null.
+struct OptimizerKernels {
+    // w += update(scale * g) over n parameters
+    void (*update)(float* w, const float* g, float scale, float* first, float* second, size_t n,
+                   const OptimizerStep& step);
+    // The same for a row-major rows x cols weight matrix whose gradient is the outer product
+    // delta x^T, formed on the fly, as in a single-sample step. When next is not null it also
+    // receives the backpropagated W^T delta, taken from the weights as they were before the
+    // update: each weight is loaded once, used for both and stored once, instead of a second
+    // pass over the matrix. next must not alias delta or x.
+    void (*updateOuter)(float* w, const float* delta, const float* x, float* next, float* first, float* second,
+                        size_t rows, size_t cols, const OptimizerStep& step);
+};
+
+// Element-wise kernels over contiguous float arrays. Every kernel accepts out aliasing one of its
+// inputs, so they can be used in place.
+struct KernelTable {
+    const char* name;
+
+    void (*add)(const float* a, const float* b, float* out, size_t n);
+    void (*subtract)(const float* a, const float* b, float* out, size_t n);
+    void (*multiply)(const float* a, const float* b, float* out, size_t n);
+    // Division by zero yields zero, matching Matrix::divide
+    void (*divide)(const float* a, const float* b, float* out, size_t n);
+
+    // out[j] = sum over k of a[j * cols + k] * x[k] for a row-major rows x cols int8 matrix,
+    // accumulated exactly in int32. Inputs must lie in [-127, 127] (symmetric quantization), which
+    // keeps the SIMD pairwise sums from saturating; cols up to 2^17 cannot overflow.
+    void (*gemvInt8)(const int8_t* a, const int8_t* x, int32_t* out, size_t rows, size_t cols);
+
+    // Indexed by Activation
+    ActivationKernels activations[ACTIVATION_COUNT];
+
+    const ActivationKernels& activation(Activation activation) const {
+        return activations[static_cast<size_t>(activation)];
+    }
+
+    // Indexed by Optimizer
+    OptimizerKernels optimizers[OPTIMIZER_COUNT];
+
+    const OptimizerKernels& optimizer(Optimizer optimizer) const {
+        return optimizers[static_cast<size_t>(optimizer)];
+    }
+};
+
+class Kernels {
+public:
+    // The best table this CPU supports, chosen once with cpuid on first use. Setting the
+    // NNL_KERNELS environment variable to scalar, sse2, avx2 or avx512 overrides the choice.
+    static const KernelTable& active();
+
+    // Individual variants; the SIMD ones return nullptr when not compiled in or not supported
+    // by the running CPU.
+    static const KernelTable& scalar();
+    static const KernelTable* sse2();
+    static const KernelTable* avx2();
+    static const KernelTable* avx512();
+};
+
+} // namespace nnlcpp
@@ -2,19 +2,25 @@
 
 #include <cstdint>
 #include <random>
+#include <span>
 #include <vector>
 
+#include "activation.hpp"
+
 namespace nnlcpp {
+// One dense layer's parameters and activation. A Layer is a view: the weights and biases live
+// in a ParameterArena (or other memory, such as a mapped model file) that must outlive it, and
+// copies of a layer share that memory.
 class Layer {
 private:
-    /* data */
-    std::vector<float> m_weights;
-    std::vector<float> m_biases;
-    uint32_t           m_rows; // Number of rows in the layer
-    uint32_t           m_cols; // Number of columns in the layer
+    float*     m_weights;    // rows x cols weights, row-major
+    float*     m_biases;     // rows biases
+    uint32_t   m_rows;       // Number of rows in the layer
+    uint32_t   m_cols;       // Number of columns in the layer
+    Activation m_activation; // Applied to W x + b
 
 public:
-    Layer(uint32_t rows, uint32_t cols, bool randomize = true);
+    Layer(uint32_t rows, uint32_t cols, float* weights, float* biases, Activation activation = Activation::Sigmoid);
     ~Layer() = default;
 
     const uint32_t getRows() const {
@@ -23,18 +29,35 @@ public:
     const uint32_t getCols() const {
         return m_cols;
     }
-    const std::vector<float>& getWeights() const {
-        return m_weights;
+    Activation getActivation() const {
+        return m_activation;
+    }
+    std::span<const float> getWeights() const {
+        return weights();
+    }
+    std::span<const float> getBiases() const {
+        return biases();
+    }
+    // Mutable views for in-place parameter updates
+    std::span<float> weights() {
+        return {m_weights, static_cast<size_t>(m_rows) * m_cols};
     }
-    const std::vector<float>& getBiases() const {
-        return m_biases;
+    std::span<float> biases() {
+        return {m_biases, m_rows};
     }
-    void setWeights(const std::vector<float>& weights) {
-        m_weights = weights;
+    std::span<const float> weights() const {
+        return {m_weights, static_cast<size_t>(m_rows) * m_cols};
     }
-    void setBiases(const std::vector<float>& biases) {
-        m_biases = biases;
+    std::span<const float> biases() const {
+        return {m_biases, m_rows};
     }
+    bool setWeights(std::span<const float> weights);
+    bool setBiases(std::span<const float> biases);
+    // Xavier-scaled random weights and small random biases, drawn from std::rand in that order
+    void randomize();
+    // The same distribution drawn from a caller-owned generator, so independent networks can be
+    // initialised concurrently and reproducibly
+    void randomize(std::mt19937& rng);
 };
 
 } // namespace nnlcpp
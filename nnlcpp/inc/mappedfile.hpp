@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+namespace nnlcpp {
+
+// A whole file mapped copy-on-write: pages come straight from the page cache and are shared
+// with every other process mapping the same file until someone writes to them.
+class MappedFile {
+private:
+    void*  m_data = nullptr;
+    size_t m_size = 0;
+
+    MappedFile(void* data, size_t size)
+          : m_data(data),
+            m_size(size) {}
+
+public:
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Returns nullptr and prints the reason if the file cannot be opened or mapped
+    static std::shared_ptr<MappedFile> open(const std::string& path);
+
+    void* data() const {
+        return m_data;
+    }
+    size_t size() const {
+        return m_size;
+    }
+};
+
+} // namespace nnlcpp
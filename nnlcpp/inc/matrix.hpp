@@ -1,5 +1,6 @@
 #pragma once
 #include <cstdint>
+#include <span>
 #include <stdio.h>
 #include <vector>
 
@@ -7,34 +8,48 @@ namespace nnlcpp {
 
 class Matrix {
 private:
-    // Element-wise matrix operation using a function
-    template <typename Operation>
-    static std::vector<float> elementWiseOperation(const std::vector<float>& matrix_a,
-                                                   const std::vector<float>& matrix_b, Operation op) {
-        if (matrix_a.size() != matrix_b.size()) {
-            printf("Error: Cannot use element-wise operation on vector sizes %d and %d.\n",
-                   static_cast<int>(matrix_a.size()), static_cast<int>(matrix_b.size()));
-            return {};
+    using ElementWiseKernel = void (*)(const float* a, const float* b, float* out, size_t n);
+
+    // Element-wise matrix operation through one of the dispatched SIMD kernels
+    static bool elementWiseOperation(std::span<const float> matrix_a, std::span<const float> matrix_b,
+                                     std::span<float> result, ElementWiseKernel kernel) {
+        if (matrix_a.size() != matrix_b.size() || matrix_a.size() != result.size()) {
+            printf("Error: Cannot use element-wise operation on vector sizes %d, %d and %d.\n",
+                   static_cast<int>(matrix_a.size()), static_cast<int>(matrix_b.size()),
+                   static_cast<int>(result.size()));
+            return false;
         }
+        kernel(matrix_a.data(), matrix_b.data(), result.data(), result.size());
+        return true;
+    }
 
+    static std::vector<float> elementWiseOperation(const std::vector<float>& matrix_a,
+                                                   const std::vector<float>& matrix_b, ElementWiseKernel kernel) {
         std::vector<float> result(matrix_a.size());
-        for (size_t i = 0; i < matrix_a.size(); ++i) {
-            result[i] = op(matrix_a[i], matrix_b[i]);
-        }
+        if (!elementWiseOperation(matrix_a, matrix_b, result, kernel))
+            return {};
         return result;
     }
 
 public:
-    static std::vector<float> dotMatrix(std::vector<float> matrix_a, size_t rows_a, size_t cols_a,
-                                        std::vector<float> matrix_b, size_t rows_b, size_t cols_b);
+    // Thin wrapper over Gemm::multiply for callers that want an owned result
+    static std::vector<float> dotMatrix(const std::vector<float>& matrix_a, size_t rows_a, size_t cols_a,
+                                        const std::vector<float>& matrix_b, size_t rows_b, size_t cols_b);
 
-    // Predefined operations for convenience
+    // Predefined operations for convenience. Each returns a fresh vector, so compositions of them
+    // are better built as an expression (expression.hpp) and evaluated in one pass.
     static std::vector<float> add(const std::vector<float>& a, const std::vector<float>& b);
     static std::vector<float> subtract(const std::vector<float>& a, const std::vector<float>& b);
     static std::vector<float> multiply(const std::vector<float>& a, const std::vector<float>& b);
     static std::vector<float> divide(const std::vector<float>& a, const std::vector<float>& b);
 
-    static std::vector<float> transpose(std::vector<float> matrix, size_t rows, size_t cols);
+    // Allocation-free variants writing into caller-provided storage, which may alias a or b
+    static bool add(std::span<const float> a, std::span<const float> b, std::span<float> out);
+    static bool subtract(std::span<const float> a, std::span<const float> b, std::span<float> out);
+    static bool multiply(std::span<const float> a, std::span<const float> b, std::span<float> out);
+    static bool divide(std::span<const float> a, std::span<const float> b, std::span<float> out);
+
+    static std::vector<float> transpose(const std::vector<float>& matrix, size_t rows, size_t cols);
     static void               randomize();
 };
 } // namespace nnlcpp
\ No newline at end of file
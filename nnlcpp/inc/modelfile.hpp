@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "neuralnetwork.hpp"
+
+namespace nnlcpp {
+
+// Versioned binary model format. All values are little-endian and every array starts on a
+// 64-byte boundary so a mapped file can be used in place:
+//
+//   ModelFileHeader                       64 bytes
+//   uint32_t topology[layer_count + 1]    neurons per layer, input first
+//   uint8_t  activations[layer_count]     Activation of each layer (version 2 on)
+//   per layer: float weights[rows * cols], then float biases[rows]
+//
+// Version 1 files have no activations and load with sigmoid on every layer.
+struct ModelFileHeader {
+    char     magic[8];       // "NNLMODEL"
+    uint32_t version;        // MODEL_FILE_VERSION
+    uint32_t byte_order;     // 0x01020304 as written by the producer
+    uint32_t layer_count;    // Number of weight layers
+    float    learning_rate;
+    uint64_t file_size;      // Total size, checked against the file on load
+    uint8_t  reserved[32];
+};
+static_assert(sizeof(ModelFileHeader) == 64, "model header must stay 64 bytes");
+
+constexpr uint32_t MODEL_FILE_VERSION = 2;
+constexpr size_t   MODEL_FILE_ALIGNMENT = 64;
+
+class ModelFile {
+public:
+    static bool save(const NeuralNetwork& network, const std::string& path);
+
+    // Map the file and build a network whose layers point straight into the mapped pages. The
+    // mapping lives as long as the network (or any copy of it) does.
+    static std::optional<NeuralNetwork> load(const std::string& path);
+};
+
+} // namespace nnlcpp
@@ -1,29 +1,118 @@
 #pragma once
 
 #include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
 #include <vector>
 
+#include "gemm.hpp"
+#include "gradients.hpp"
 #include "layer.hpp"
 #include "matrix.hpp"
+#include "optimizerstate.hpp"
+#include "parameterarena.hpp"
+#include "workspace.hpp"
 
 namespace nnlcpp {
 
 class NeuralNetwork {
 private:
-    std::vector<Layer> m_layers;        // Vector of layers in the neural network
-    float              m_learning_rate; // Learning rate for the neural network
+    ParameterArena          m_parameters;    // Every layer's weights and biases in one aligned block
+    std::vector<Layer>      m_layers;        // Views of each layer's slice of m_parameters
+    std::vector<Activation> m_activations;   // Activation of each layer, output layer last
+    float                   m_learning_rate; // Learning rate for the neural network
+    OptimizerState          m_optimizer;     // Update rule and its per-parameter state, plain SGD by default
+    Workspace               m_workspace;     // Preallocated scratch memory for training steps
+
+    void bindLayers();
+
+    bool        forwardBatch(const float* inputs, uint32_t batch_size, Workspace& workspace) const;
+    template <typename Update>
+    void        backwardBatch(const float* inputs, const float* expected_outputs, uint32_t batch_size,
+                              Workspace& workspace, Update&& update) const;
+    static void accumulateRowSums(ConstMatrixView matrix, float scale, float* sums);
+
 public:
     NeuralNetwork(std::vector<uint32_t> layers, float learning_rate);
+    // Initial parameters drawn from a private generator seeded with seed instead of std::rand,
+    // so networks can be built concurrently and each seed always gives the same network
+    NeuralNetwork(std::vector<uint32_t> layers, float learning_rate, uint64_t seed);
+    // Copy the parameters of existing layers into a fresh arena
+    NeuralNetwork(const std::vector<Layer>& layers, float learning_rate);
+    // Adopt an arena as is, e.g. a view of a mapped model file
+    NeuralNetwork(ParameterArena parameters, float learning_rate);
     ~NeuralNetwork() = default;
 
+    // Copies snapshot the parameters into an arena of their own with a single memcpy
+    NeuralNetwork(const NeuralNetwork& other);
+    NeuralNetwork& operator=(const NeuralNetwork& other);
+    NeuralNetwork(NeuralNetwork&& other) noexcept = default;
+    NeuralNetwork& operator=(NeuralNetwork&& other) noexcept = default;
+
+    const std::vector<Layer>& getLayers() const {
+        return m_layers;
+    }
+    float getLearningRate() const {
+        return m_learning_rate;
+    }
+    const std::vector<Activation>& getActivations() const {
+        return m_activations;
+    }
+    // One activation per layer (topology size - 1), output layer last
+    bool setActivations(const std::vector<Activation>& activations);
+    const OptimizerState& getOptimizer() const {
+        return m_optimizer;
+    }
+    // Switch the update rule, starting it from zeroed state
+    void setOptimizer(const OptimizerSettings& settings);
+    // Resume the current rule from saved state, see OptimizerState::restore
+    bool restoreOptimizer(const float* first, const float* second, uint64_t steps) {
+        return m_optimizer.restore(first, second, steps);
+    }
+    const ParameterArena& getParameters() const {
+        return m_parameters;
+    }
+    // Restore parameters from a snapshot of the same topology in one memcpy
+    bool setParameters(const ParameterArena& parameters) {
+        return m_parameters.copyFrom(parameters);
+    }
+    // Neurons per layer, input first, as passed to the constructor
+    std::vector<uint32_t> getTopology() const;
+
     void               printVector(const std::string& msg, const std::vector<float>& data) const;
     float              sigmoid(float x) const;
     float              dSigmoid(float x) const;
     bool               applyDelta(const std::vector<float>& delta, Layer& layer);
     bool               train(const std::vector<float>& input, std::vector<float>& expected_output);
-    std::vector<float> feedForward(Layer& layer_a, std::vector<float>& input, uint32_t input_rows, uint32_t input_cols);
+    // Train on batch_size samples at once. inputs and expected_outputs hold one sample per row
+    // (batch_size x input size and batch_size x output size) and one averaged update is applied.
+    bool               trainBatch(const std::vector<float>& inputs, const std::vector<float>& expected_outputs,
+                                  uint32_t batch_size);
+    // Same as above on raw row-major buffers with caller-owned scratch memory. Hogwild-style
+    // trainers call this concurrently on one network; those updates race by design.
+    bool               trainBatch(const float* inputs, const float* expected_outputs, uint32_t batch_size,
+                                  Workspace& workspace);
+    // Forward and backward pass over a batch that leaves the weights untouched and overwrites
+    // gradients with the batch-summed (unscaled) parameter gradients. Safe to call concurrently
+    // with distinct workspaces and gradients. layer_ready(i), if given, is called as soon as layer
+    // i's gradients are final, output layer first, so they can be sent on while the rest are computed.
+    bool               computeGradients(const float* inputs, const float* expected_outputs, uint32_t batch_size,
+                                        Workspace& workspace, Gradients& gradients,
+                                        const std::function<void(size_t layer)>& layer_ready = {}) const;
+    // One optimizer step on scale * gradients; for plain SGD, parameters += learning rate * scale * gradients
+    bool               applyGradients(const Gradients& gradients, float scale);
+    std::vector<float> feedForward(const Layer& layer_a, const std::vector<float>& input, uint32_t input_rows,
+                                   uint32_t input_cols) const;
     std::vector<float> calculateGradient(const std::vector<float>& output_error, std::vector<float> layer_weights);
     std::vector<float> calculateDelta(const std::vector<float>& gradient, const Layer& layer);
     std::vector<float> predict(const std::vector<float>& input) const;
+    // Inference into caller-owned output using a caller-owned scratch workspace. The network is
+    // only read, so concurrent callers are safe as long as each uses its own workspace.
+    bool               predict(std::span<const float> input, std::span<float> output, Workspace& workspace) const;
+    // Score batch_size inputs (one sample per row) in one pass over each weight matrix, writing
+    // batch_size x output size results to outputs
+    bool               predictBatch(const float* inputs, uint32_t batch_size, float* outputs,
+                                    Workspace& workspace) const;
 };
 } // namespace nnlcpp
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+namespace nnlcpp {
+
+// Rule that turns a gradient into a parameter update. The network's "gradient" g is the
+// descent direction (expected - output backpropagated), so every rule adds to the weights.
+enum class Optimizer : uint8_t {
+    Sgd,      // w += lr g
+    Momentum, // v = mu v + g; w += lr v
+    Nesterov, // v = mu v + g; w += lr (g + mu v)
+    RmsProp,  // s = rho s + (1 - rho) g^2; w += lr g / (sqrt(s) + eps)
+    Adam,     // Bias-corrected first and second moments, Kingma & Ba
+};
+constexpr size_t OPTIMIZER_COUNT = 5;
+
+// Command line names: sgd, momentum, nesterov, rmsprop, adam
+const char*              optimizerName(Optimizer optimizer);
+std::optional<Optimizer> parseOptimizer(const std::string& name);
+
+// Hyperparameters; each optimizer reads only the ones it needs
+struct OptimizerSettings {
+    Optimizer type = Optimizer::Sgd;
+    float     momentum = 0.9f; // Momentum and Nesterov velocity decay
+    float     rho = 0.9f;      // RMSProp squared-gradient decay
+    float     beta1 = 0.9f;    // Adam first moment decay
+    float     beta2 = 0.999f;  // Adam second moment decay
+    float     epsilon = 1e-8f; // RMSProp and Adam denominator guard
+};
+
+// Everything one update step needs, computed once per step so the kernels do no transcendental
+// work beyond the square root. Adam folds its bias correction into learning_rate and epsilon:
+// lr sqrt(1 - beta2^t) / (1 - beta1^t) and eps sqrt(1 - beta2^t).
+struct OptimizerStep {
+    float learning_rate;
+    float first_decay;  // mu for Momentum and Nesterov, beta1 for Adam
+    float second_decay; // rho for RMSProp, beta2 for Adam
+    float epsilon;
+
+    static OptimizerStep make(const OptimizerSettings& settings, float learning_rate, uint64_t step) {
+        switch (settings.type) {
+        case Optimizer::Momentum:
+        case Optimizer::Nesterov:
+            return {learning_rate, settings.momentum, 0.0f, 0.0f};
+        case Optimizer::RmsProp:
+            return {learning_rate, 0.0f, settings.rho, settings.epsilon};
+        case Optimizer::Adam: {
+            double t = static_cast<double>(step);
+            double second = std::sqrt(1.0 - std::pow(static_cast<double>(settings.beta2), t));
+            double first = 1.0 - std::pow(static_cast<double>(settings.beta1), t);
+            return {static_cast<float>(learning_rate * second / first), settings.beta1, settings.beta2,
+                    static_cast<float>(settings.epsilon * second)};
+        }
+        default:
+            return {learning_rate, 0.0f, 0.0f, 0.0f};
+        }
+    }
+};
+
+// Scalar rules, one per Optimizer. apply() returns the updated weight and updates the rule's
+// STATES state values in place: the velocity, squared-gradient average or Adam's two moments. The
+// SIMD kernels implement the same arithmetic lane-wise.
+namespace optimizer {
+
+struct Sgd {
+    static constexpr int STATES = 0;
+    static float apply(float w, float g, float&, float&, const OptimizerStep& step) {
+        return w + step.learning_rate * g;
+    }
+};
+
+struct Momentum {
+    static constexpr int STATES = 1;
+    static float apply(float w, float g, float& v, float&, const OptimizerStep& step) {
+        v = step.first_decay * v + g;
+        return w + step.learning_rate * v;
+    }
+};
+
+struct Nesterov {
+    static constexpr int STATES = 1;
+    static float apply(float w, float g, float& v, float&, const OptimizerStep& step) {
+        v = step.first_decay * v + g;
+        return w + step.learning_rate * (g + step.first_decay * v);
+    }
+};
+
+struct RmsProp {
+    static constexpr int STATES = 1;
+    static float apply(float w, float g, float& s, float&, const OptimizerStep& step) {
+        s = step.second_decay * s + (1.0f - step.second_decay) * g * g;
+        return w + step.learning_rate * g / (std::sqrt(s) + step.epsilon);
+    }
+};
+
+struct Adam {
+    static constexpr int STATES = 2;
+    static float apply(float w, float g, float& m, float& v, const OptimizerStep& step) {
+        m = step.first_decay * m + (1.0f - step.first_decay) * g;
+        v = step.second_decay * v + (1.0f - step.second_decay) * g * g;
+        return w + step.learning_rate * m / (std::sqrt(v) + step.epsilon);
+    }
+};
+
+// Update parameter i with gradient g. first and second are the rule's state arrays; the ones
+// it does not use are never touched and may be null.
+template <typename R>
+inline void applyAt(float* w, float* first, float* second, size_t i, float g, const OptimizerStep& step) {
+    float  unused_first = 0.0f;
+    float  unused_second = 0.0f;
+    float& s1 = (R::STATES >= 1) ? first[i] : unused_first;
+    float& s2 = (R::STATES >= 2) ? second[i] : unused_second;
+    w[i] = R::apply(w[i], g, s1, s2, step);
+}
+
+} // namespace optimizer
+
+} // namespace nnlcpp
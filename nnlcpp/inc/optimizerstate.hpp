@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "optimizer.hpp"
+#include "parameterarena.hpp"
+
+namespace nnlcpp {
+
+// A network's optimizer: its settings, its step count and the per-parameter state the rule
+// keeps. The state arenas are laid out exactly like the parameters, so a layer's velocity or
+// moments sit in the same slice as its weights and biases, and a whole-model step is one pass
+// over the parameter, gradient and state blocks together. Plain SGD allocates no state.
+class OptimizerState {
+private:
+    OptimizerSettings m_settings;
+    ParameterArena    m_first;     // Velocity, squared-gradient average or Adam's first moment
+    ParameterArena    m_second;    // Adam's second moment
+    uint64_t          m_steps = 0; // Steps taken; hogwild trainers race on it like on the weights
+
+public:
+    OptimizerState() = default;
+    // Zeroed state for a network of the given topology (neurons per layer, input first)
+    OptimizerState(const std::vector<uint32_t>& topology, const OptimizerSettings& settings);
+
+    const OptimizerSettings& getSettings() const {
+        return m_settings;
+    }
+    Optimizer getType() const {
+        return m_settings.type;
+    }
+    uint64_t getSteps() const {
+        return m_steps;
+    }
+
+    // Count a new step and compute its hyperparameters
+    OptimizerStep beginStep(float learning_rate);
+    // Forget all history, as if no step had been taken
+    void reset();
+    // Carry on from saved state: blocks laid out like the arenas below (null where the rule keeps
+    // no such state) and the number of steps already taken
+    bool restore(const float* first, const float* second, uint64_t steps);
+
+    // The state arenas, empty when the rule keeps no such state
+    const ParameterArena& getFirst() const {
+        return m_first;
+    }
+    const ParameterArena& getSecond() const {
+        return m_second;
+    }
+
+    // The whole state blocks, or one layer's slices of them; null when the rule keeps no such state
+    float* first() {
+        return m_first.data();
+    }
+    float* second() {
+        return m_second.data();
+    }
+    float* firstWeights(size_t layer) {
+        return m_first.data() ? m_first.weights(layer).data() : nullptr;
+    }
+    float* firstBiases(size_t layer) {
+        return m_first.data() ? m_first.biases(layer).data() : nullptr;
+    }
+    float* secondWeights(size_t layer) {
+        return m_second.data() ? m_second.weights(layer).data() : nullptr;
+    }
+    float* secondBiases(size_t layer) {
+        return m_second.data() ? m_second.biases(layer).data() : nullptr;
+    }
+};
+
+} // namespace nnlcpp
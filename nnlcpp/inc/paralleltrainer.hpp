@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "gradients.hpp"
+#include "neuralnetwork.hpp"
+#include "threadpool.hpp"
+#include "workspace.hpp"
+
+namespace nnlcpp {
+
+// Data-parallel trainer: each batch is split into one contiguous shard per thread and the shards
+// run on a persistent thread pool against the same NeuralNetwork.
+class ParallelTrainer {
+public:
+    enum class Mode {
+        Synchronous, // Per-shard gradients, deterministic tree reduction, one update per batch
+        Hogwild,     // Every shard applies its own update to the shared weights without locking
+    };
+
+private:
+    NeuralNetwork&         m_network;
+    ThreadPool             m_pool;
+    Mode                   m_mode;
+    std::vector<Workspace> m_workspaces; // Scratch memory per worker thread
+    std::vector<Gradients> m_gradients;  // Gradient slot per shard, reduced into slot 0
+
+    bool reduceGradients(size_t shards);
+
+public:
+    ParallelTrainer(NeuralNetwork& network, uint32_t threads, Mode mode = Mode::Synchronous);
+
+    uint32_t getThreadCount() const {
+        return static_cast<uint32_t>(m_pool.getThreadCount());
+    }
+
+    // Same contract as NeuralNetwork::trainBatch: one sample per row of inputs and expected_outputs
+    bool trainBatch(const std::vector<float>& inputs, const std::vector<float>& expected_outputs,
+                    uint32_t batch_size);
+};
+
+} // namespace nnlcpp
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace nnlcpp {
+
+// Every layer's weights and biases in one 64-byte-aligned block: layer 0 weights, layer 0
+// biases, layer 1 weights and so on, each array starting on a 64-byte boundary with zeroed
+// padding between them. This is the same layout a model file uses after its header, so a mapped
+// file can be adopted as an arena in place. Whole-model operations (update, reduce, copy,
+// serialise) are a single pass over data()..data() + size().
+class ParameterArena {
+public:
+    static constexpr size_t ALIGNMENT = 64;
+
+private:
+    struct Slice {
+        size_t   weights; // Offset in floats of the rows x cols weights
+        size_t   biases;  // Offset in floats of the rows biases
+        uint32_t rows;
+        uint32_t cols;
+    };
+
+    std::vector<uint32_t>       m_topology;
+    std::vector<Slice>          m_slices;
+    size_t                      m_size = 0;       // Floats including padding
+    float*                      m_data = nullptr;
+    std::shared_ptr<const void> m_backing;        // Owned block, or whatever keeps a view's memory alive
+    bool                        m_owned = false;
+
+    void computeLayout();
+
+public:
+    ParameterArena() = default;
+    // Owned, zero-initialised parameters for a topology given as neurons per layer, input first
+    explicit ParameterArena(const std::vector<uint32_t>& topology);
+    // Adopt memory laid out as above, e.g. a mapped model file. Nothing is copied; backing is
+    // held for as long as the arena (or a move of it) is alive.
+    static ParameterArena view(const std::vector<uint32_t>& topology, float* data,
+                               std::shared_ptr<const void> backing);
+
+    // Copies always own their parameters, so copying is a snapshot: one allocation, one memcpy
+    ParameterArena(const ParameterArena& other);
+    ParameterArena& operator=(const ParameterArena& other);
+    ParameterArena(ParameterArena&& other) noexcept = default;
+    ParameterArena& operator=(ParameterArena&& other) noexcept = default;
+
+    // Bytes an arena for this topology occupies
+    static size_t bytesFor(const std::vector<uint32_t>& topology);
+
+    const std::vector<uint32_t>& getTopology() const {
+        return m_topology;
+    }
+    size_t getLayerCount() const {
+        return m_slices.size();
+    }
+    bool ownsMemory() const {
+        return m_owned;
+    }
+    // The whole block, padding included
+    float* data() {
+        return m_data;
+    }
+    const float* data() const {
+        return m_data;
+    }
+    size_t size() const {
+        return m_size;
+    }
+
+    std::span<float> weights(size_t layer) {
+        return {m_data + m_slices[layer].weights, static_cast<size_t>(m_slices[layer].rows) * m_slices[layer].cols};
+    }
+    std::span<float> biases(size_t layer) {
+        return {m_data + m_slices[layer].biases, m_slices[layer].rows};
+    }
+    std::span<const float> weights(size_t layer) const {
+        return {m_data + m_slices[layer].weights, static_cast<size_t>(m_slices[layer].rows) * m_slices[layer].cols};
+    }
+    std::span<const float> biases(size_t layer) const {
+        return {m_data + m_slices[layer].biases, m_slices[layer].rows};
+    }
+
+    bool sameLayout(const ParameterArena& other) const {
+        return m_topology == other.m_topology;
+    }
+    void zero();
+    // Overwrite every parameter with other's in one memcpy; the topologies must match
+    bool copyFrom(const ParameterArena& other);
+};
+
+} // namespace nnlcpp
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "allocations.hpp"
+
+namespace nnlcpp {
+
+// Phases of a training step that are timed separately for every layer
+enum class ProfilePhase : uint8_t {
+    Forward,          // Weighted input, W * x, with bias and activation where fused
+    BiasActivation,   // Bias add and activation
+    OutputError,      // (expected - output) * f'
+    DeltaPropagation, // W^T * delta * f' into the layer below
+    WeightUpdate,     // delta * x^T into the weights (or a gradient buffer)
+    BiasUpdate,       // delta into the biases (or a gradient buffer)
+    Count
+};
+
+// Collects per-layer, per-phase counters from ProfileScope and optionally a timeline of every
+// scope for chrome://tracing. Each thread records into its own log, so scopes never contend.
+class Profiler {
+public:
+    struct Counters {
+        uint64_t calls = 0;
+        uint64_t nanoseconds = 0;
+        uint64_t flops = 0;
+        uint64_t bytes = 0;
+        uint64_t allocations = 0;
+    };
+
+private:
+    static inline std::atomic<bool> s_active{false};
+
+public:
+    // Whether the NNL_PROFILE scopes were compiled in at all
+    static constexpr bool compiledIn() {
+#ifdef NNL_PROFILE
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // Discard anything recorded so far and start collecting; trace also keeps the timeline
+    static void start(bool trace);
+    static void stop();
+    static bool active() {
+        return s_active.load(std::memory_order_relaxed);
+    }
+
+    static uint64_t    now();
+    static void        record(ProfilePhase phase, uint32_t layer, uint64_t start, uint64_t end, uint64_t flops,
+                              uint64_t bytes, uint64_t allocations);
+    static const char* phaseName(ProfilePhase phase);
+
+    // Counters merged across threads, indexed [layer][phase]
+    static std::vector<std::vector<Counters>> collect();
+    static void                               printReport(FILE* file = stdout);
+    // Write the recorded timeline as Chrome trace-event JSON
+    static bool                               writeTrace(const std::string& path);
+};
+
+// Times the enclosing block and counts the allocations made in it. Costs one relaxed load when
+// the profiler is not running; use NNL_PROFILE_SCOPE so it vanishes when profiling is compiled out.
+class ProfileScope {
+private:
+    ProfilePhase m_phase;
+    uint32_t     m_layer;
+    uint64_t     m_flops;
+    uint64_t     m_bytes;
+    uint64_t     m_allocations = 0;
+    uint64_t     m_start = 0;
+    bool         m_active;
+
+public:
+    ProfileScope(ProfilePhase phase, size_t layer, uint64_t flops, uint64_t bytes)
+          : m_phase(phase),
+            m_layer(static_cast<uint32_t>(layer)),
+            m_flops(flops),
+            m_bytes(bytes),
+            m_active(Profiler::active()) {
+        if (m_active) {
+            m_allocations = Allocations::count();
+            m_start = Profiler::now();
+        }
+    }
+    ~ProfileScope() {
+        if (m_active) {
+            Profiler::record(m_phase, m_layer, m_start, Profiler::now(), m_flops, m_bytes,
+                             Allocations::count() - m_allocations);
+        }
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+} // namespace nnlcpp
+
+// NNL_PROFILE_SCOPE(Phase, layer, flops, bytes) profiles the rest of the enclosing block. Without
+// NNL_PROFILE it expands to nothing and its arguments are never evaluated.
+#ifdef NNL_PROFILE
+#define NNL_PROFILE_CONCAT_(a, b) a##b
+#define NNL_PROFILE_CONCAT(a, b) NNL_PROFILE_CONCAT_(a, b)
+#define NNL_PROFILE_SCOPE(phase, layer, flops, bytes)                                                     \
+    ::nnlcpp::ProfileScope NNL_PROFILE_CONCAT(nnl_profile_scope_, __LINE__)(::nnlcpp::ProfilePhase::phase, \
+                                                                           layer, flops, bytes)
+#else
+#define NNL_PROFILE_SCOPE(phase, layer, flops, bytes) static_cast<void>(0)
+#endif
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "neuralnetwork.hpp"
+
+namespace nnlcpp {
+
+// Inference-only int8 copy of a trained NeuralNetwork. Each weight row is quantized
+// symmetrically with its own scale (w ~ q * scale, q in [-127, 127]), which keeps one large row
+// from crushing the resolution of the others. Layer inputs are quantized the same way per call
+// from their max magnitude, the product runs on the int8 kernel with int32 accumulation, and the
+// sum is scaled back to float before the bias add and the layer's activation. Biases stay float:
+// there is one per row, so they cost nothing next to the weights.
+class QuantizedNetwork {
+public:
+    // Scratch memory for one predict call, sized for the widest layer by makeScratch
+    struct Scratch {
+        std::vector<int8_t>  input;   // The quantized layer input
+        std::vector<int32_t> sums;    // Integer dot products, one per row
+        std::vector<float>   current; // Float activations in and out of a layer
+        std::vector<float>   next;
+    };
+
+private:
+    struct QuantizedLayer {
+        uint32_t            rows;
+        uint32_t            cols;
+        std::vector<int8_t> weights; // rows x cols, row-major like Layer
+        std::vector<float>  scales;  // One per row
+        std::vector<float>  biases;
+        Activation          activation;
+    };
+
+    std::vector<QuantizedLayer> m_layers;
+
+public:
+    static QuantizedNetwork quantize(const NeuralNetwork& network);
+
+    // Neurons per layer, input first
+    std::vector<uint32_t> getTopology() const;
+    // Bytes of int8 weights plus float scales and biases
+    size_t                getBytes() const;
+    // Bytes the same weights and biases take as float, without arena padding, for comparison
+    static size_t         floatBytesFor(const std::vector<uint32_t>& topology);
+
+    Scratch            makeScratch() const;
+    std::vector<float> predict(const std::vector<float>& input) const;
+    // Inference into caller-owned output. The network is only read, so concurrent callers are
+    // safe as long as each uses its own scratch.
+    bool               predict(std::span<const float> input, std::span<float> output, Scratch& scratch) const;
+};
+
+} // namespace nnlcpp
@@ -0,0 +1,260 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <span>
+#include <stdio.h>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "expression.hpp"
+#include "kernels.hpp"
+#include "neuralnetwork.hpp"
+
+namespace nnlcpp {
+
+// Fully connected sigmoid network whose topology is fixed at compile time, e.g.
+// StaticNetwork<2, 4, 1>. Every parameter and activation lives in std::arrays inside the object
+// or on the stack, and the layer loop is unrolled by the compiler, so tiny models pay for the
+// arithmetic and nothing else.
+//
+// train and predict follow NeuralNetwork exactly: the same initialisation order from std::rand,
+// the same per-sample update that applies each layer's update before propagating its error.
+// Results agree with NeuralNetwork up to float rounding from summation order and exp.
+template <uint32_t... Sizes>
+class StaticNetwork {
+    static_assert(sizeof...(Sizes) >= 2, "a network needs at least an input and an output layer");
+
+public:
+    static constexpr std::array<uint32_t, sizeof...(Sizes)> TOPOLOGY = {Sizes...};
+    static constexpr size_t                                 LAYER_COUNT = sizeof...(Sizes) - 1;
+    static constexpr uint32_t                               INPUT_SIZE = TOPOLOGY.front();
+    static constexpr uint32_t                               OUTPUT_SIZE = TOPOLOGY.back();
+
+    using Input = std::array<float, INPUT_SIZE>;
+    using Output = std::array<float, OUTPUT_SIZE>;
+
+private:
+    template <uint32_t Rows, uint32_t Cols>
+    struct DenseLayer {
+        static constexpr uint32_t ROWS = Rows;
+        static constexpr uint32_t COLS = Cols;
+        std::array<float, static_cast<size_t>(Rows) * Cols> weights; // Row-major, like Layer
+        std::array<float, Rows>                             biases;
+    };
+
+    template <size_t... I>
+    static auto makeLayers(std::index_sequence<I...>) -> std::tuple<DenseLayer<TOPOLOGY[I + 1], TOPOLOGY[I]>...>;
+    template <size_t... I>
+    static auto makeActivations(std::index_sequence<I...>) -> std::tuple<std::array<float, TOPOLOGY[I + 1]>...>;
+
+    using Layers = decltype(makeLayers(std::make_index_sequence<LAYER_COUNT>{}));
+    // Output of every layer for one sample
+    using Activations = decltype(makeActivations(std::make_index_sequence<LAYER_COUNT>{}));
+
+    static constexpr uint32_t SIMD_ACTIVATION_ROWS = 8;
+
+    Layers m_layers;
+    float  m_learning_rate;
+
+    static float sigmoid(float x) {
+        return 1.0f / (1.0f + std::exp(-x));
+    }
+
+    // Apply f<0>() .. f<LAYER_COUNT - 1>() in order, or in reverse
+    template <typename F>
+    static void forEachLayer(F&& f) {
+        [&]<size_t... I>(std::index_sequence<I...>) {
+            (f.template operator()<I>(), ...);
+        }(std::make_index_sequence<LAYER_COUNT>{});
+    }
+    template <typename F>
+    static void forEachLayerReversed(F&& f) {
+        [&]<size_t... I>(std::index_sequence<I...>) {
+            (f.template operator()<LAYER_COUNT - 1 - I>(), ...);
+        }(std::make_index_sequence<LAYER_COUNT>{});
+    }
+
+    // The input to layer I: the network input for the first layer, else the previous activation
+    template <size_t I>
+    static const float* layerInput(const Input& input, const Activations& activations) {
+        if constexpr (I == 0) {
+            return input.data();
+        } else {
+            return std::get<I - 1>(activations).data();
+        }
+    }
+
+    void forward(const Input& input, Activations& activations) const {
+        forEachLayer([&]<size_t I>() {
+            const auto&        layer = std::get<I>(m_layers);
+            constexpr uint32_t ROWS = std::tuple_element_t<I, Layers>::ROWS;
+            constexpr uint32_t COLS = std::tuple_element_t<I, Layers>::COLS;
+            const float*       x = layerInput<I>(input, activations);
+            auto&              a = std::get<I>(activations);
+            for (uint32_t j = 0; j < ROWS; ++j) {
+                float sum = 0.0f;
+                for (uint32_t k = 0; k < COLS; ++k) {
+                    sum += layer.weights[j * COLS + k] * x[k];
+                }
+                a[j] = sum + layer.biases[j];
+            }
+
+            // A handful of scalar exps is cheaper than a call through the kernel table; wider
+            // layers are worth the vectorised sigmoid
+            if constexpr (ROWS >= SIMD_ACTIVATION_ROWS) {
+                Kernels::active().activation(Activation::Sigmoid).activate(a.data(), a.data(), ROWS);
+            } else {
+                for (uint32_t j = 0; j < ROWS; ++j) {
+                    a[j] = sigmoid(a[j]);
+                }
+            }
+        });
+    }
+
+public:
+    // Random Xavier-scaled weights and small biases, drawn from std::rand in the same order as
+    // NeuralNetwork, so the same seed gives the same starting point
+    explicit StaticNetwork(float learning_rate, bool randomize = true) : m_learning_rate(learning_rate) {
+        forEachLayer([&]<size_t I>() {
+            auto& layer = std::get<I>(m_layers);
+            layer.weights.fill(0.0f);
+            layer.biases.fill(0.0f);
+            if (!randomize)
+                return;
+
+            float scale = std::sqrt(2.0f / static_cast<float>(std::tuple_element_t<I, Layers>::COLS));
+            for (auto& weight : layer.weights) {
+                weight = scale * (2.0f * static_cast<float>(std::rand()) / static_cast<float>(RAND_MAX) - 1.0f);
+            }
+            for (auto& bias : layer.biases) {
+                bias = 0.01f * (2.0f * static_cast<float>(std::rand()) / static_cast<float>(RAND_MAX) - 1.0f);
+            }
+        });
+    }
+
+    // Copy the parameters of a runtime network with the same topology
+    static std::optional<StaticNetwork> fromNetwork(const NeuralNetwork& network) {
+        const std::vector<Layer>& layers = network.getLayers();
+        if (network.getTopology() != std::vector<uint32_t>(TOPOLOGY.begin(), TOPOLOGY.end())) {
+            printf("Error: fromNetwork needs a network with the static topology.\n");
+            return std::nullopt;
+        }
+
+        StaticNetwork result(network.getLearningRate(), false);
+        forEachLayer([&]<size_t I>() {
+            auto& layer = std::get<I>(result.m_layers);
+            std::copy(layers[I].getWeights().begin(), layers[I].getWeights().end(), layer.weights.begin());
+            std::copy(layers[I].getBiases().begin(), layers[I].getBiases().end(), layer.biases.begin());
+        });
+        return result;
+    }
+
+    // Copy the parameters into a runtime network, e.g. to save it with ModelFile
+    NeuralNetwork toNetwork() const {
+        ParameterArena parameters(std::vector<uint32_t>(TOPOLOGY.begin(), TOPOLOGY.end()));
+        forEachLayer([&]<size_t I>() {
+            const auto& layer = std::get<I>(m_layers);
+            std::copy(layer.weights.begin(), layer.weights.end(), parameters.weights(I).begin());
+            std::copy(layer.biases.begin(), layer.biases.end(), parameters.biases(I).begin());
+        });
+        return NeuralNetwork(std::move(parameters), m_learning_rate);
+    }
+
+    float getLearningRate() const {
+        return m_learning_rate;
+    }
+    template <size_t I>
+    std::span<const float> getWeights() const {
+        return std::get<I>(m_layers).weights;
+    }
+    template <size_t I>
+    std::span<const float> getBiases() const {
+        return std::get<I>(m_layers).biases;
+    }
+
+    // One stochastic gradient step on a single sample
+    void train(const Input& input, const Output& expected_output) {
+        Activations activations;
+        forward(input, activations);
+
+        // Each layer's error, shaped like its activations. The output error times the derivative
+        // of sigmoid seeds the last one.
+        Activations   deltas;
+        const Output& output = std::get<LAYER_COUNT - 1>(activations);
+        using expression::values;
+        expression::evaluate(std::get<LAYER_COUNT - 1>(deltas),
+                             (values(expected_output) - values(output)) * values(output) * (1.0f - values(output)));
+
+        forEachLayerReversed([&]<size_t I>() {
+            auto&              layer = std::get<I>(m_layers);
+            constexpr uint32_t ROWS = std::tuple_element_t<I, Layers>::ROWS;
+            constexpr uint32_t COLS = std::tuple_element_t<I, Layers>::COLS;
+            const auto&        delta = std::get<I>(deltas);
+            const std::span<const float, COLS> prev(layerInput<I>(input, activations), COLS);
+
+            // 1. Update biases, 2. update weights with the outer product of delta and the input and,
+            // in the same pass, propagate the error through the weights as they were
+            expression::evaluate(layer.biases, values(layer.biases) + m_learning_rate * values(delta));
+            float* new_delta = nullptr;
+            if constexpr (I > 0) {
+                new_delta = std::get<I - 1>(deltas).data();
+                std::fill_n(new_delta, COLS, 0.0f);
+            }
+            for (uint32_t j = 0; j < ROWS; ++j) {
+                float scaled_delta = m_learning_rate * delta[j];
+                for (uint32_t k = 0; k < COLS; ++k) {
+                    float& weight = layer.weights[j * COLS + k];
+                    if constexpr (I > 0)
+                        new_delta[k] += weight * delta[j];
+                    weight += scaled_delta * prev[k];
+                }
+            }
+
+            // 3. Apply the derivative of sigmoid to the propagated error
+            if constexpr (I > 0) {
+                auto& propagated = std::get<I - 1>(deltas);
+                expression::evaluate(propagated,
+                                     values(propagated) * values(prev) * (1.0f - values(prev)));
+            }
+        });
+    }
+
+    Output predict(const Input& input) const {
+        Activations activations;
+        forward(input, activations);
+        return std::get<LAYER_COUNT - 1>(activations);
+    }
+
+    // Drop-in overloads for code written against NeuralNetwork's vector interface
+    bool train(const std::vector<float>& input, const std::vector<float>& expected_output) {
+        if (input.size() != INPUT_SIZE || expected_output.size() != OUTPUT_SIZE) {
+            printf("Error: train expects %u inputs and %u outputs but got %zu and %zu.\n", INPUT_SIZE, OUTPUT_SIZE,
+                   input.size(), expected_output.size());
+            return false;
+        }
+        Input  in;
+        Output out;
+        std::copy(input.begin(), input.end(), in.begin());
+        std::copy(expected_output.begin(), expected_output.end(), out.begin());
+        train(in, out);
+        return true;
+    }
+    std::vector<float> predict(const std::vector<float>& input) const {
+        if (input.size() != INPUT_SIZE) {
+            printf("Error: predict expects %u inputs but got %zu.\n", INPUT_SIZE, input.size());
+            return {};
+        }
+        Input in;
+        std::copy(input.begin(), input.end(), in.begin());
+        Output out = predict(in);
+        return {out.begin(), out.end()};
+    }
+};
+
+} // namespace nnlcpp
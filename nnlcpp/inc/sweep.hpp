@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "activation.hpp"
+#include "dataset.hpp"
+#include "optimizer.hpp"
+
+namespace nnlcpp {
+
+// One point of a hyperparameter sweep
+struct SweepConfig {
+    std::vector<uint32_t> layers;
+    float                 learning_rate = 0.1f;
+    uint64_t              seed = 1;
+    Optimizer             optimizer = Optimizer::Sgd;
+    Activation            activation = Activation::Sigmoid; // On every layer
+};
+
+// The search space, parsed from keys separated by ';', each listing alternatives separated by
+// '|', e.g. "layers=2,4,1|2,8,1;lr=0.05|0.5;seed=1-4;optimizer=sgd|adam;activation=sigmoid|tanh".
+// seed also takes an inclusive range a-b, and lr a range lo~hi that random search samples
+// log-uniformly. Keys left out keep the value from the defaults.
+struct SweepSpace {
+    std::vector<std::vector<uint32_t>>     layers;
+    std::vector<float>                     learning_rates;
+    std::optional<std::pair<float, float>> learning_rate_range;
+    std::vector<uint64_t>                  seeds;
+    std::vector<Optimizer>                 optimizers;
+    std::vector<Activation>                activations;
+
+    static std::optional<SweepSpace> parse(const std::string& spec, const SweepConfig& defaults);
+
+    // Every combination; a learning rate range is an error here
+    std::optional<std::vector<SweepConfig>> grid() const;
+    // count configurations, each key drawn independently from a generator seeded with seed
+    std::vector<SweepConfig> sample(size_t count, uint64_t seed) const;
+};
+
+// A whole training set in memory, one sample per row, shared read-only by every run
+struct SweepData {
+    std::vector<float> inputs;
+    std::vector<float> outputs;
+    size_t             samples = 0;
+    uint32_t           input_size = 0;
+    uint32_t           output_size = 0;
+
+    // Read every sample of a dataset from the start
+    static SweepData load(Dataset& dataset);
+};
+
+struct SweepSettings {
+    uint32_t epochs = 1000;     // Budget of a configuration that survives every round
+    uint32_t batch_size = 1;    // 1 trains per sample
+    uint32_t halving = 2;       // Keep the best 1/halving after each round; below 2 trains all to the end
+    double   target_loss = 0.0; // A run stops early once its loss reaches this; 0 disables
+    size_t   threads = 1;
+};
+
+struct SweepResult {
+    SweepConfig config;
+    uint32_t    epochs = 0;   // Epochs actually trained
+    uint32_t    rounds = 0;   // Rounds the configuration took part in
+    bool        survived = false;
+    bool        converged = false;
+    double      loss = 0.0;   // Mean squared error over the whole training set after its last round
+    double      accuracy = 0.0;
+    double      seconds = 0.0; // Training and scoring time of this run alone
+};
+
+// Trains many independent networks at once on a work-stealing pool, one task per configuration
+// and round. Successive halving gives every configuration a small share of the epoch budget,
+// keeps the best 1/halving by loss, and repeats with a larger share until one is left with the
+// full budget, so hopeless configurations cost a fraction of a full run.
+class Sweep {
+public:
+    // Results ordered best first: survivors by loss, then the rest by how far they got
+    static std::vector<SweepResult> run(const std::vector<SweepConfig>& configs, const SweepData& data,
+                                        const SweepSettings& settings);
+    static void                     printTable(const std::vector<SweepResult>& results);
+};
+
+} // namespace nnlcpp
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace nnlcpp {
+
+// Persistent pool of worker threads for fork-join loops. The threads are created once and
+// parked on a condition variable between jobs.
+class ThreadPool {
+public:
+    using Job = std::function<void(size_t task, size_t worker)>;
+
+private:
+    std::vector<std::thread> m_threads;
+    std::mutex               m_mutex;
+    std::condition_variable  m_start;
+    std::condition_variable  m_done;
+    const Job*               m_job = nullptr;
+    size_t                   m_task_count = 0;
+    std::atomic<size_t>      m_next_task{0};
+    size_t                   m_generation = 0; // Bumped for every job so parked workers can tell it is new
+    size_t                   m_busy = 0;       // Workers that have not finished the current job
+    bool                     m_stop = false;
+
+    void workerLoop(size_t worker);
+    void drain(size_t worker);
+
+public:
+    // threads counts the calling thread, which takes part in every job as worker 0
+    explicit ThreadPool(size_t threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t getThreadCount() const {
+        return m_threads.size() + 1;
+    }
+
+    // Run job(task, worker) for every task in [0, task_count) and block until all have finished.
+    // worker is in [0, getThreadCount()) and identifies the thread, e.g. for per-thread scratch.
+    void parallelFor(size_t task_count, const Job& job);
+};
+
+} // namespace nnlcpp
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace nnlcpp {
+
+// How the ranks of a distributed run reach each other
+enum class TransportKind : uint8_t {
+    Socket,       // A Unix domain socket pair between each rank and the next
+    SharedMemory, // A byte ring in memory shared by the ranks between each rank and the next
+};
+constexpr size_t TRANSPORT_COUNT = 2;
+
+// Command line names: socket, shm
+const char*                  transportName(TransportKind kind);
+std::optional<TransportKind> parseTransport(const std::string& name);
+
+// One rank's links to its neighbours in a ring of ranks. Ring collectives only ever send to the
+// next rank while receiving from the previous one, so that is all a transport provides; doing
+// both at once is what keeps two ranks from blocking on each other's full buffers.
+class Transport {
+public:
+    virtual ~Transport() = default;
+
+    virtual uint32_t getRank() const = 0;
+    virtual uint32_t getRanks() const = 0;
+    // Send send_bytes to the next rank and receive receive_bytes from the previous one, returning
+    // once both are done; false if a neighbour has gone away
+    virtual bool exchange(const void* send, size_t send_bytes, void* receive, size_t receive_bytes) = 0;
+};
+
+// Over connected stream sockets, which the transport owns and puts in non-blocking mode
+class SocketTransport : public Transport {
+private:
+    uint32_t m_rank;
+    uint32_t m_ranks;
+    int      m_next;     // Connected to the next rank
+    int      m_previous; // Connected to the previous rank
+
+public:
+    SocketTransport(uint32_t rank, uint32_t ranks, int next, int previous);
+    ~SocketTransport() override;
+
+    SocketTransport(const SocketTransport&) = delete;
+    SocketTransport& operator=(const SocketTransport&) = delete;
+
+    uint32_t getRank() const override {
+        return m_rank;
+    }
+    uint32_t getRanks() const override {
+        return m_ranks;
+    }
+    bool exchange(const void* send, size_t send_bytes, void* receive, size_t receive_bytes) override;
+};
+
+// Over single-producer, single-consumer byte rings in shared memory, one per link, so a transfer
+// is two memcpys and no system calls. A side that finds nothing to do spins briefly and then sleeps
+// in poll on a socket to the neighbour, which carries no data but reports it if that rank dies.
+class SharedMemoryTransport : public Transport {
+public:
+    static constexpr size_t CHANNEL_BYTES = 1 << 20;
+
+    struct Channel;
+
+    // Memory for the channels of a ring of ranks, shared by every process forked after this
+    static std::shared_ptr<Channel> createChannels(uint32_t ranks);
+
+private:
+    uint32_t                 m_rank;
+    uint32_t                 m_ranks;
+    std::shared_ptr<Channel> m_channels; // Channel r carries rank r's data to rank r + 1
+    Channel*                 m_outgoing;
+    Channel*                 m_incoming;
+    int                      m_next;     // Liveness of the next rank
+    int                      m_previous; // Liveness of the previous rank
+
+public:
+    SharedMemoryTransport(uint32_t rank, uint32_t ranks, std::shared_ptr<Channel> channels, int next,
+                          int previous);
+    ~SharedMemoryTransport() override;
+
+    SharedMemoryTransport(const SharedMemoryTransport&) = delete;
+    SharedMemoryTransport& operator=(const SharedMemoryTransport&) = delete;
+
+    uint32_t getRank() const override {
+        return m_rank;
+    }
+    uint32_t getRanks() const override {
+        return m_ranks;
+    }
+    bool exchange(const void* send, size_t send_bytes, void* receive, size_t receive_bytes) override;
+};
+
+// Ranks on this machine: the calling process becomes rank 0 and forks the others, joined in a
+// ring over the chosen transport. Every rank runs worker with its transport; the forked ranks
+// exit as soon as it returns, with only rank 0 returning from run.
+class LocalCluster {
+public:
+    using Worker = std::function<bool(Transport& transport)>;
+
+    // True once every rank's worker has returned true
+    static bool run(uint32_t ranks, TransportKind kind, const Worker& worker);
+};
+
+} // namespace nnlcpp
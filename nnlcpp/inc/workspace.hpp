@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "layer.hpp"
+
+namespace nnlcpp {
+
+// Scratch memory for a training step, sized once from the network topology. Each buffer holds
+// room for `capacity` samples; growing the batch size past it reallocates, after which steady
+// state training steps touch no allocator at all.
+class Workspace {
+private:
+    std::vector<std::vector<float>> m_activations; // Output of each layer, rows x batch
+    std::vector<float>              m_delta;       // Error of the layer being backpropagated
+    std::vector<float>              m_next_delta;  // Error being propagated to the layer below
+    std::vector<float>              m_gradient;    // One layer's gradient, allocated on first use
+    std::vector<uint32_t>           m_rows;        // Neurons per layer
+    uint32_t                        m_max_rows = 0;
+    uint32_t                        m_capacity = 0; // Samples the buffers can currently hold
+    uint32_t                        m_batch_size = 0;
+
+public:
+    Workspace() = default;
+    Workspace(const std::vector<Layer>& layers, uint32_t batch_size = 1);
+
+    // Make room for batch_size samples, only allocating when it exceeds the current capacity
+    void     reserve(uint32_t batch_size);
+    uint32_t getCapacity() const {
+        return m_capacity;
+    }
+
+    std::span<float> activation(size_t layer) {
+        return {m_activations[layer].data(), static_cast<size_t>(m_rows[layer]) * m_batch_size};
+    }
+    std::span<float> delta(size_t rows) {
+        return {m_delta.data(), rows * m_batch_size};
+    }
+    std::span<float> nextDelta(size_t rows) {
+        return {m_next_delta.data(), rows * m_batch_size};
+    }
+    // Room for one layer's gradients, for optimizers that need them whole before updating. Only
+    // workspaces that ask pay for it, and only the first time a size is exceeded.
+    std::span<float> gradient(size_t size) {
+        if (m_gradient.size() < size)
+            m_gradient.resize(size);
+        return {m_gradient.data(), size};
+    }
+    void swapDeltas() {
+        m_delta.swap(m_next_delta);
+    }
+};
+
+} // namespace nnlcpp
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace nnlcpp {
+
+// Worker threads that each own a deque of tasks. A worker takes its newest task from the back of
+// its own deque and, once that runs dry, steals the oldest task from the front of another's. Built
+// for coarse tasks of very uneven cost, such as whole training runs: each deque's lock is only
+// contended when someone steals, and a worker stuck with one long task never holds up the rest.
+class WorkStealingPool {
+public:
+    // worker identifies the thread running the task, in [0, getThreadCount())
+    using Task = std::function<void(size_t worker)>;
+
+private:
+    struct Queue {
+        std::mutex       mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::thread> m_threads;
+    std::vector<Queue>       m_queues;   // One per worker, the calling thread's first
+    std::mutex               m_mutex;
+    std::condition_variable  m_wake;     // Workers wait here for tasks
+    std::condition_variable  m_idle;     // wait() waits here for the last task to finish
+    std::atomic<size_t>      m_queued{0};  // Tasks sitting in some deque
+    std::atomic<size_t>      m_pending{0}; // Tasks submitted and not yet finished
+    std::atomic<size_t>      m_next_queue{0};
+    bool                     m_stop = false;
+
+    void workerLoop(size_t worker);
+    // Pop from our own deque, else steal; false when every deque is empty
+    bool takeTask(size_t worker, Task& task);
+    void runTask(size_t worker, Task& task);
+
+public:
+    // threads counts the calling thread, which works on the queues during wait()
+    explicit WorkStealingPool(size_t threads);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    size_t getThreadCount() const {
+        return m_queues.size();
+    }
+
+    // Queue a task, dealing tasks round robin across the workers' deques. Tasks may submit more.
+    void submit(Task task);
+    // Help run tasks until every submitted task, including ones submitted meanwhile, has finished
+    void wait();
+};
+
+} // namespace nnlcpp
@@ -0,0 +1,38 @@
+#include "activation.hpp"
+
+namespace nnlcpp {
+
+namespace {
+
+constexpr const char* NAMES[ACTIVATION_COUNT] = {"sigmoid", "sigmoid-poly", "sigmoid-lut", "tanh", "relu",
+                                                 "leaky-relu"};
+
+} // namespace
+
+namespace activation {
+
+extern const std::array<float, SIGMOID_TABLE_INTERVALS + 1> SIGMOID_TABLE = [] {
+    std::array<float, SIGMOID_TABLE_INTERVALS + 1> table;
+    for (size_t i = 0; i < table.size(); ++i) {
+        double z = -SIGMOID_TABLE_LIMIT + static_cast<double>(i) / SIGMOID_TABLE_STEPS_PER_UNIT;
+        table[i] = static_cast<float>(1.0 / (1.0 + std::exp(-z)));
+    }
+    return table;
+}();
+
+} // namespace activation
+
+const char* activationName(Activation activation) {
+    size_t index = static_cast<size_t>(activation);
+    return (index < ACTIVATION_COUNT) ? NAMES[index] : "unknown";
+}
+
+std::optional<Activation> parseActivation(const std::string& name) {
+    for (size_t i = 0; i < ACTIVATION_COUNT; ++i) {
+        if (name == NAMES[i])
+            return static_cast<Activation>(i);
+    }
+    return std::nullopt;
+}
+
+} // namespace nnlcpp
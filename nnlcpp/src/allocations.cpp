@@ -0,0 +1,53 @@
+#include "allocations.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+// Per thread so a measurement on one thread isn't polluted by another's allocations
+thread_local uint64_t t_allocations = 0;
+
+} // namespace
+
+namespace nnlcpp {
+
+uint64_t Allocations::count() {
+    return t_allocations;
+}
+
+} // namespace nnlcpp
+
+// The array, nothrow and sized forms in the standard library all forward to these
+
+void* operator new(size_t size) {
+    ++t_allocations;
+    if (void* ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t align) {
+    ++t_allocations;
+    size_t alignment = static_cast<size_t>(align);
+    if (void* ptr = std::aligned_alloc(alignment, (std::max<size_t>(size, 1) + alignment - 1) / alignment * alignment))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept {
+    std::free(ptr);
+}
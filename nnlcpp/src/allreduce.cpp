@@ -0,0 +1,48 @@
+#include "allreduce.hpp"
+
+#include "kernels.hpp"
+
+namespace nnlcpp {
+
+RingAllReduce::RingAllReduce(Transport& transport) : m_transport(transport) {}
+
+bool RingAllReduce::sum(std::span<float> values) {
+    const size_t ranks = m_transport.getRanks();
+    const size_t rank = m_transport.getRank();
+    m_arrived = std::chrono::steady_clock::now();
+    if (ranks < 2 || values.empty())
+        return true;
+
+    auto begin = [&](size_t chunk) { return chunk * values.size() / ranks; };
+    auto length = [&](size_t chunk) { return begin(chunk + 1) - begin(chunk); };
+    m_incoming.resize(values.size() / ranks + 1);
+
+    // Reduce-scatter: in step s, pass chunk rank - s on and add chunk rank - s - 1 from the previous
+    // rank into our own, so after the last step this rank holds the whole sum of chunk rank + 1
+    const KernelTable& kernels = Kernels::active();
+    for (size_t step = 0; step + 1 < ranks; ++step) {
+        size_t outgoing = (rank + ranks - step) % ranks;
+        size_t incoming = (rank + 2 * ranks - step - 1) % ranks;
+        if (!m_transport.exchange(values.data() + begin(outgoing), length(outgoing) * sizeof(float),
+                                  m_incoming.data(), length(incoming) * sizeof(float)))
+            return false;
+        if (step == 0)
+            m_arrived = std::chrono::steady_clock::now();
+        kernels.add(values.data() + begin(incoming), m_incoming.data(), values.data() + begin(incoming),
+                    length(incoming));
+        m_bytes_sent += length(outgoing) * sizeof(float);
+    }
+
+    // All-gather: pass each finished chunk on, received straight into place
+    for (size_t step = 0; step + 1 < ranks; ++step) {
+        size_t outgoing = (rank + 1 + ranks - step) % ranks;
+        size_t incoming = (rank + ranks - step) % ranks;
+        if (!m_transport.exchange(values.data() + begin(outgoing), length(outgoing) * sizeof(float),
+                                  values.data() + begin(incoming), length(incoming) * sizeof(float)))
+            return false;
+        m_bytes_sent += length(outgoing) * sizeof(float);
+    }
+    return true;
+}
+
+} // namespace nnlcpp
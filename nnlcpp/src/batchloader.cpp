@@ -0,0 +1,134 @@
+#include "batchloader.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace nnlcpp {
+
+BatchLoader::BatchLoader(Dataset& dataset, uint32_t batch_size, size_t window_size, size_t ring_size,
+                         uint64_t seed)
+      : m_dataset(dataset),
+        m_batch_size(std::max<uint32_t>(batch_size, 1)),
+        m_window_size(std::max<size_t>(window_size, 1)),
+        m_rng(seed),
+        m_ring(std::max<size_t>(ring_size, 2)) {
+    for (auto& batch : m_ring) {
+        batch.inputs.resize(static_cast<size_t>(m_batch_size) * dataset.getInputSize());
+        batch.outputs.resize(static_cast<size_t>(m_batch_size) * dataset.getOutputSize());
+    }
+    m_producer = std::thread(&BatchLoader::produce, this);
+}
+
+BatchLoader::~BatchLoader() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_free.notify_all();
+    m_producer.join();
+}
+
+const BatchLoader::Batch& BatchLoader::next() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (m_holding) {
+        // Hand the previous batch's slot back to the producer
+        m_holding = false;
+        m_free.notify_one();
+    }
+
+    if (m_filled == 0) {
+        auto start = std::chrono::steady_clock::now();
+        m_ready.wait(lock, [this] { return m_filled > 0; });
+        m_stats.stall_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        ++m_stats.stalls;
+    }
+
+    const Batch& batch = m_ring[m_tail];
+    m_tail = (m_tail + 1) % m_ring.size();
+    --m_filled;
+    m_holding = true;
+    m_stats.samples += batch.size;
+    return batch;
+}
+
+BatchLoader::Stats BatchLoader::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats                       stats = m_stats;
+    stats.bytes = m_dataset.getBytesRead();
+    stats.load_seconds = m_load_seconds.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void BatchLoader::produce() {
+    const uint32_t input_size = m_dataset.getInputSize();
+    const uint32_t output_size = m_dataset.getOutputSize();
+
+    // Shuffle window: samples are read in order into the window and each emitted sample is drawn
+    // uniformly from it, its place taken by the last sample in the window
+    std::vector<float> window_inputs(m_window_size * input_size);
+    std::vector<float> window_outputs(m_window_size * output_size);
+    size_t             window_count = 0;
+    bool               exhausted = false;
+    double             load_seconds = 0.0;
+    auto               top_up = [&] {
+        if (!exhausted && window_count < m_window_size) {
+            size_t read = m_dataset.read(&window_inputs[window_count * input_size],
+                                         &window_outputs[window_count * output_size], m_window_size - window_count);
+            window_count += read;
+            exhausted = (read == 0);
+        }
+    };
+
+    while (true) {
+        // Wait for a free slot: the ring holds filled slots plus the one the consumer is using
+        Batch* batch;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_free.wait(lock, [this] { return m_stop || m_filled + (m_holding ? 1 : 0) < m_ring.size(); });
+            if (m_stop)
+                return;
+            batch = &m_ring[m_head];
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        if (window_count == 0 && exhausted) {
+            m_dataset.rewind();
+            exhausted = false;
+        }
+
+        uint32_t size = 0;
+        while (size < m_batch_size) {
+            // Top the window up before drawing from it
+            top_up();
+            if (window_count == 0)
+                break;
+
+            size_t pick = std::uniform_int_distribution<size_t>(0, window_count - 1)(m_rng);
+            std::copy_n(&window_inputs[pick * input_size], input_size, &batch->inputs[size * input_size]);
+            std::copy_n(&window_outputs[pick * output_size], output_size, &batch->outputs[size * output_size]);
+            ++size;
+
+            --window_count;
+            std::copy_n(&window_inputs[window_count * input_size], input_size, &window_inputs[pick * input_size]);
+            std::copy_n(&window_outputs[window_count * output_size], output_size,
+                        &window_outputs[pick * output_size]);
+        }
+
+        // And once more after, so the end of the dataset is found with the batch that drained the
+        // window rather than as an empty batch after it, which a one-sample window would give
+        top_up();
+        batch->size = size;
+        batch->last_in_epoch = exhausted && window_count == 0;
+        load_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        m_load_seconds.store(load_seconds, std::memory_order_relaxed);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_head = (m_head + 1) % m_ring.size();
+            ++m_filled;
+        }
+        m_ready.notify_one();
+    }
+}
+
+} // namespace nnlcpp
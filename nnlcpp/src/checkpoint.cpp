@@ -0,0 +1,315 @@
+#include "checkpoint.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "mappedfile.hpp"
+
+namespace nnlcpp {
+
+namespace {
+
+constexpr char     MAGIC[8] = {'N', 'N', 'L', 'C', 'H', 'K', 'P', 'T'};
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+constexpr size_t   ALIGNMENT = 64;
+
+size_t alignUp(size_t offset) {
+    return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+size_t activationsOffset(const std::vector<uint32_t>& topology) {
+    return sizeof(CheckpointHeader) + topology.size() * sizeof(uint32_t);
+}
+
+size_t parametersOffset(const std::vector<uint32_t>& topology) {
+    return alignUp(activationsOffset(topology) + topology.size() - 1);
+}
+
+size_t fileSize(const std::vector<uint32_t>& topology, size_t state_count) {
+    return parametersOffset(topology) + (1 + state_count) * ParameterArena::bytesFor(topology);
+}
+
+bool writeAt(FILE* file, size_t offset, const void* data, size_t size) {
+    return fseek(file, static_cast<long>(offset), SEEK_SET) == 0 && fwrite(data, 1, size, file) == size;
+}
+
+// Make a rename durable by syncing the directory that holds the file
+void syncDirectory(const std::string& path) {
+    size_t      slash = path.rfind('/');
+    std::string directory = (slash == std::string::npos) ? "." : path.substr(0, std::max<size_t>(slash, 1));
+    int         fd = ::open(directory.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        fsync(fd);
+        ::close(fd);
+    }
+}
+
+} // namespace
+
+TrainingSnapshot::TrainingSnapshot(const NeuralNetwork& network)
+      : parameters(network.getParameters().getTopology()),
+        activations(network.getActivations()),
+        learning_rate(network.getLearningRate()),
+        optimizer(network.getOptimizer().getSettings()) {
+    const OptimizerState& state = network.getOptimizer();
+    if (state.getFirst().data())
+        first = ParameterArena(state.getFirst().getTopology());
+    if (state.getSecond().data())
+        second = ParameterArena(state.getSecond().getTopology());
+}
+
+void TrainingSnapshot::capture(const NeuralNetwork& network, uint64_t epoch) {
+    const OptimizerState& state = network.getOptimizer();
+    parameters.copyFrom(network.getParameters());
+    if (first.data())
+        first.copyFrom(state.getFirst());
+    if (second.data())
+        second.copyFrom(state.getSecond());
+    activations = network.getActivations();
+    learning_rate = network.getLearningRate();
+    steps = state.getSteps();
+    this->epoch = epoch;
+}
+
+bool CheckpointFile::save(const TrainingSnapshot& snapshot, const std::string& path) {
+    const std::vector<uint32_t>& topology = snapshot.parameters.getTopology();
+    uint8_t state_count = static_cast<uint8_t>((snapshot.first.data() ? 1 : 0) + (snapshot.second.data() ? 1 : 0));
+
+    CheckpointHeader header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = CHECKPOINT_FILE_VERSION;
+    header.byte_order = BYTE_ORDER_MARK;
+    header.layer_count = static_cast<uint32_t>(snapshot.parameters.getLayerCount());
+    header.learning_rate = snapshot.learning_rate;
+    header.file_size = fileSize(topology, state_count);
+    header.epoch = snapshot.epoch;
+    header.steps = snapshot.steps;
+    header.optimizer = static_cast<uint8_t>(snapshot.optimizer.type);
+    header.state_count = state_count;
+    header.momentum = snapshot.optimizer.momentum;
+    header.rho = snapshot.optimizer.rho;
+    header.beta1 = snapshot.optimizer.beta1;
+    header.beta2 = snapshot.optimizer.beta2;
+    header.epsilon = snapshot.optimizer.epsilon;
+
+    std::vector<uint8_t> activations;
+    for (Activation activation : snapshot.activations) {
+        activations.push_back(static_cast<uint8_t>(activation));
+    }
+
+    std::string tmp_path = path + ".tmp";
+    FILE*       file = fopen(tmp_path.c_str(), "wb");
+    if (file == nullptr) {
+        printf("Error: Cannot open %s for writing.\n", tmp_path.c_str());
+        return false;
+    }
+
+    size_t arena_bytes = ParameterArena::bytesFor(topology);
+    size_t offset = parametersOffset(topology);
+    bool   ok = writeAt(file, 0, &header, sizeof(header)) &&
+              writeAt(file, sizeof(CheckpointHeader), topology.data(), topology.size() * sizeof(uint32_t)) &&
+              writeAt(file, activationsOffset(topology), activations.data(), activations.size()) &&
+              writeAt(file, offset, snapshot.parameters.data(), arena_bytes);
+    for (const ParameterArena* state : {&snapshot.first, &snapshot.second}) {
+        if (ok && state->data()) {
+            offset += arena_bytes;
+            ok = writeAt(file, offset, state->data(), arena_bytes);
+        }
+    }
+    ok = ok && fflush(file) == 0 && fsync(fileno(file)) == 0;
+    ok = (fclose(file) == 0) && ok;
+
+    if (!ok || std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        printf("Error: Failed to write checkpoint %s.\n", path.c_str());
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+    syncDirectory(path);
+    return true;
+}
+
+std::optional<CheckpointFile::Checkpoint> CheckpointFile::load(const std::string& path) {
+    std::shared_ptr<MappedFile> mapping = MappedFile::open(path);
+    if (!mapping)
+        return std::nullopt;
+
+    const auto*             base = static_cast<const uint8_t*>(mapping->data());
+    const CheckpointHeader* header = reinterpret_cast<const CheckpointHeader*>(base);
+    if (mapping->size() < sizeof(CheckpointHeader) || std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0) {
+        printf("Error: %s is not an nnl checkpoint.\n", path.c_str());
+        return std::nullopt;
+    }
+    if (header->version != CHECKPOINT_FILE_VERSION || header->byte_order != BYTE_ORDER_MARK) {
+        printf("Error: %s has unsupported version %u or byte order 0x%08x.\n", path.c_str(), header->version,
+               header->byte_order);
+        return std::nullopt;
+    }
+    if (header->optimizer >= OPTIMIZER_COUNT || header->state_count > 2) {
+        printf("Error: %s has unknown optimizer %u.\n", path.c_str(), header->optimizer);
+        return std::nullopt;
+    }
+
+    size_t topology_bytes = (static_cast<size_t>(header->layer_count) + 1) * sizeof(uint32_t);
+    if (header->layer_count == 0 || sizeof(CheckpointHeader) + topology_bytes > mapping->size()) {
+        printf("Error: %s has a truncated topology.\n", path.c_str());
+        return std::nullopt;
+    }
+    const uint32_t*       sizes = reinterpret_cast<const uint32_t*>(base + sizeof(CheckpointHeader));
+    std::vector<uint32_t> topology(sizes, sizes + header->layer_count + 1);
+
+    size_t file_size = fileSize(topology, header->state_count);
+    if (file_size != header->file_size || file_size != mapping->size()) {
+        printf("Error: %s is %zu bytes but its topology needs %zu.\n", path.c_str(), mapping->size(), file_size);
+        return std::nullopt;
+    }
+
+    std::vector<Activation> activations(header->layer_count);
+    const uint8_t*          stored = base + activationsOffset(topology);
+    for (size_t i = 0; i < activations.size(); ++i) {
+        if (stored[i] >= ACTIVATION_COUNT) {
+            printf("Error: %s has unknown activation %u on layer %zu.\n", path.c_str(), stored[i], i);
+            return std::nullopt;
+        }
+        activations[i] = static_cast<Activation>(stored[i]);
+    }
+
+    // Training writes to the parameters, so copy them out rather than keep the mapping
+    size_t         arena_bytes = ParameterArena::bytesFor(topology);
+    const float*   blocks = reinterpret_cast<const float*>(base + parametersOffset(topology));
+    size_t         block_floats = arena_bytes / sizeof(float);
+    ParameterArena parameters(topology);
+    std::copy_n(blocks, block_floats, parameters.data());
+
+    OptimizerSettings settings;
+    settings.type = static_cast<Optimizer>(header->optimizer);
+    settings.momentum = header->momentum;
+    settings.rho = header->rho;
+    settings.beta1 = header->beta1;
+    settings.beta2 = header->beta2;
+    settings.epsilon = header->epsilon;
+
+    Checkpoint checkpoint{NeuralNetwork(std::move(parameters), header->learning_rate), header->epoch};
+    checkpoint.network.setActivations(activations);
+    checkpoint.network.setOptimizer(settings);
+    const float* first = header->state_count >= 1 ? blocks + block_floats : nullptr;
+    const float* second = header->state_count >= 2 ? blocks + 2 * block_floats : nullptr;
+    if (!checkpoint.network.restoreOptimizer(first, second, header->steps))
+        return std::nullopt;
+    return checkpoint;
+}
+
+Checkpointer::Checkpointer(const NeuralNetwork& network, std::string path, uint32_t interval, uint64_t first_epoch,
+                           bool synchronous)
+      : m_path(std::move(path)),
+        m_interval(std::max<uint32_t>(interval, 1)),
+        m_epoch(first_epoch),
+        m_synchronous(synchronous),
+        m_snapshots{TrainingSnapshot(network), synchronous ? TrainingSnapshot() : TrainingSnapshot(network)} {
+    if (!m_synchronous) {
+        m_writer = std::thread(&Checkpointer::write, this);
+    }
+}
+
+Checkpointer::~Checkpointer() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_work.notify_one();
+    if (m_writer.joinable()) {
+        m_writer.join();
+    }
+}
+
+void Checkpointer::epochDone(const NeuralNetwork& network) {
+    if (++m_epoch % m_interval != 0)
+        return;
+
+    auto start = std::chrono::steady_clock::now();
+    if (m_synchronous) {
+        m_snapshots[0].capture(network, m_epoch);
+        bool ok = CheckpointFile::save(m_snapshots[0], m_path);
+        record(ok, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    } else {
+        // The writer only picks up or releases a snapshot under the lock, so the one it is not
+        // writing is ours to overwrite, queued or not
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            int target = (m_writing == 0) ? 1 : 0;
+            m_snapshots[target].capture(network, m_epoch);
+            if (m_queued == target)
+                ++m_stats.superseded;
+            m_queued = target;
+        }
+        m_work.notify_one();
+    }
+
+    double                      stall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_stats.captured;
+    m_stats.stall_seconds += stall;
+    m_stats.max_stall_seconds = std::max(m_stats.max_stall_seconds, stall);
+}
+
+void Checkpointer::flush() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this] { return m_queued < 0 && m_writing < 0; });
+}
+
+Checkpointer::Stats Checkpointer::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void Checkpointer::printReport() const {
+    Stats stats = getStats();
+    if (stats.captured == 0)
+        return;
+    double writes = static_cast<double>(std::max<uint64_t>(stats.written + stats.failures, 1));
+    printf("Checkpoints: %llu taken, %llu written to %s", static_cast<unsigned long long>(stats.captured),
+           static_cast<unsigned long long>(stats.written), m_path.c_str());
+    if (stats.superseded > 0)
+        printf(", %llu superseded before writing", static_cast<unsigned long long>(stats.superseded));
+    if (stats.failures > 0)
+        printf(", %llu failed", static_cast<unsigned long long>(stats.failures));
+    printf("\n");
+    printf("Trainer stalled %.3f ms per checkpoint (max %.3f ms, %s); serialising and fsync took %.3f ms each\n",
+           1e3 * stats.stall_seconds / static_cast<double>(stats.captured), 1e3 * stats.max_stall_seconds,
+           m_synchronous ? "synchronous" : "asynchronous", 1e3 * stats.write_seconds / writes);
+}
+
+void Checkpointer::record(bool ok, double seconds) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++(ok ? m_stats.written : m_stats.failures);
+    m_stats.write_seconds += seconds;
+}
+
+void Checkpointer::write() {
+    while (true) {
+        int snapshot;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_work.wait(lock, [this] { return m_stop || m_queued >= 0; });
+            if (m_queued < 0)
+                return; // Stopping with nothing left to write
+            snapshot = m_writing = m_queued;
+            m_queued = -1;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        bool ok = CheckpointFile::save(m_snapshots[snapshot], m_path);
+        record(ok, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_writing = -1;
+        }
+        m_idle.notify_all();
+    }
+}
+
+} // namespace nnlcpp
@@ -0,0 +1,233 @@
+#include "dataset.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <stdio.h>
+#include <sys/mman.h>
+
+namespace nnlcpp {
+
+namespace {
+
+constexpr char     MAGIC[8] = {'N', 'N', 'L', 'D', 'A', 'T', 'A', '\0'};
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+constexpr size_t   CSV_CHUNK_SIZE = 1 << 20;
+
+bool hasSuffix(const std::string& value, const std::string& suffix) {
+    return value.size() >= suffix.size() && value.compare(value.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+} // namespace
+
+std::unique_ptr<Dataset> Dataset::open(const std::string& path, uint32_t input_size, uint32_t output_size) {
+    if (hasSuffix(path, ".csv")) {
+        return CsvDataset::open(path, input_size, output_size);
+    }
+
+    std::unique_ptr<BinaryDataset> dataset = BinaryDataset::open(path);
+    if (dataset && (dataset->getInputSize() != input_size || dataset->getOutputSize() != output_size)) {
+        printf("Error: %s has %u inputs and %u outputs, the network expects %u and %u.\n", path.c_str(),
+               dataset->getInputSize(), dataset->getOutputSize(), input_size, output_size);
+        return nullptr;
+    }
+    return dataset;
+}
+
+bool Dataset::writeBinary(Dataset& source, const std::string& path) {
+    FILE* file = fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        printf("Error: Cannot open %s for writing.\n", path.c_str());
+        return false;
+    }
+
+    DatasetFileHeader header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = DATASET_FILE_VERSION;
+    header.byte_order = BYTE_ORDER_MARK;
+    header.input_size = source.getInputSize();
+    header.output_size = source.getOutputSize();
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+
+    // Convert in fixed-size blocks so arbitrarily large sources stream through
+    const size_t       block = 4096;
+    const size_t       record = header.input_size + header.output_size;
+    std::vector<float> inputs(block * header.input_size);
+    std::vector<float> outputs(block * header.output_size);
+    std::vector<float> records(block * record);
+    source.rewind();
+    size_t count;
+    while (ok && (count = source.read(inputs.data(), outputs.data(), block)) > 0) {
+        for (size_t n = 0; n < count; ++n) {
+            float* out = &records[n * record];
+            std::copy_n(&inputs[n * header.input_size], header.input_size, out);
+            std::copy_n(&outputs[n * header.output_size], header.output_size, out + header.input_size);
+        }
+        ok = fwrite(records.data(), sizeof(float), count * record, file) == count * record;
+        header.sample_count += count;
+    }
+
+    // Patch the final sample count into the header
+    ok = ok && fseek(file, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = (fclose(file) == 0) && ok;
+    if (!ok) {
+        printf("Error: Failed to write dataset file %s.\n", path.c_str());
+    }
+    return ok;
+}
+
+std::unique_ptr<BinaryDataset> BinaryDataset::open(const std::string& path) {
+    std::shared_ptr<MappedFile> mapping = MappedFile::open(path);
+    if (!mapping)
+        return nullptr;
+
+    const auto* header = static_cast<const DatasetFileHeader*>(mapping->data());
+    if (mapping->size() < sizeof(DatasetFileHeader) || std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0) {
+        printf("Error: %s is not an nnl dataset file.\n", path.c_str());
+        return nullptr;
+    }
+    if (header->version != DATASET_FILE_VERSION || header->byte_order != BYTE_ORDER_MARK) {
+        printf("Error: %s has unsupported version %u or byte order 0x%08x.\n", path.c_str(), header->version,
+               header->byte_order);
+        return nullptr;
+    }
+
+    uint64_t record_bytes = (static_cast<uint64_t>(header->input_size) + header->output_size) * sizeof(float);
+    // Compared by division, since a corrupt sample count can overflow the product
+    if (record_bytes != 0 && header->sample_count > (mapping->size() - sizeof(DatasetFileHeader)) / record_bytes) {
+        printf("Error: %s is truncated.\n", path.c_str());
+        return nullptr;
+    }
+
+    // Samples are consumed front to back, so let the kernel read ahead aggressively
+    madvise(mapping->data(), mapping->size(), MADV_SEQUENTIAL);
+
+    auto dataset = std::make_unique<BinaryDataset>();
+    dataset->m_records = reinterpret_cast<const float*>(static_cast<const uint8_t*>(mapping->data()) +
+                                                        sizeof(DatasetFileHeader));
+    dataset->m_sample_count = header->sample_count;
+    dataset->m_input_size = header->input_size;
+    dataset->m_output_size = header->output_size;
+    dataset->m_mapping = std::move(mapping);
+    return dataset;
+}
+
+size_t BinaryDataset::read(float* inputs, float* outputs, size_t count) {
+    count = static_cast<size_t>(std::min<uint64_t>(count, m_sample_count - m_position));
+    const size_t record = m_input_size + m_output_size;
+    const float* src = m_records + m_position * record;
+    for (size_t n = 0; n < count; ++n, src += record) {
+        std::copy_n(src, m_input_size, inputs + n * m_input_size);
+        std::copy_n(src + m_input_size, m_output_size, outputs + n * m_output_size);
+    }
+    m_position += count;
+    m_bytes_read += count * record * sizeof(float);
+    return count;
+}
+
+void BinaryDataset::rewind() {
+    m_position = 0;
+}
+
+CsvDataset::CsvDataset(FILE* file, const std::string& path, uint32_t input_size, uint32_t output_size)
+      : m_file(file),
+        m_chunk(CSV_CHUNK_SIZE),
+        m_input_size(input_size),
+        m_output_size(output_size),
+        m_path(path) {}
+
+CsvDataset::~CsvDataset() {
+    if (m_file != nullptr) {
+        fclose(m_file);
+    }
+}
+
+std::unique_ptr<CsvDataset> CsvDataset::open(const std::string& path, uint32_t input_size, uint32_t output_size) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        printf("Error: Cannot open %s.\n", path.c_str());
+        return nullptr;
+    }
+    return std::make_unique<CsvDataset>(file, path, input_size, output_size);
+}
+
+bool CsvDataset::nextLine(std::string& line) {
+    line.clear();
+    while (true) {
+        if (m_chunk_begin == m_chunk_end) {
+            m_chunk_begin = 0;
+            m_chunk_end = fread(m_chunk.data(), 1, m_chunk.size(), m_file);
+            m_bytes_read += m_chunk_end;
+            if (m_chunk_end == 0)
+                return !line.empty();
+        }
+
+        const char* begin = m_chunk.data() + m_chunk_begin;
+        const char* newline = static_cast<const char*>(std::memchr(begin, '\n', m_chunk_end - m_chunk_begin));
+        if (newline == nullptr) {
+            // The line continues in the next chunk
+            line.append(begin, m_chunk_end - m_chunk_begin);
+            m_chunk_begin = m_chunk_end;
+            continue;
+        }
+        line.append(begin, newline - begin);
+        m_chunk_begin += (newline - begin) + 1;
+        ++m_line;
+        return true;
+    }
+}
+
+size_t CsvDataset::read(float* inputs, float* outputs, size_t count) {
+    // The line buffer keeps its capacity across calls, so parsing does not allocate per line
+    thread_local std::string line;
+    const size_t             values = m_input_size + m_output_size;
+
+    size_t read = 0;
+    while (read < count && nextLine(line)) {
+        if (line.empty() || line[0] == '#' || line == "\r")
+            continue;
+
+        const char* cursor = line.c_str();
+        size_t      parsed = 0;
+        for (; parsed < values; ++parsed) {
+            char* end;
+            float value = std::strtof(cursor, &end);
+            if (end == cursor)
+                break;
+            if (parsed < m_input_size) {
+                inputs[read * m_input_size + parsed] = value;
+            } else {
+                outputs[read * m_output_size + parsed - m_input_size] = value;
+            }
+            cursor = end;
+            while (*cursor == ',' || *cursor == ' ' || *cursor == '\t') {
+                ++cursor;
+            }
+        }
+
+        if (parsed != values) {
+            // A non-numeric first line is a header; anything later is reported and skipped
+            if (m_line > 1) {
+                printf("Warning: %s:%llu has %zu of %zu values, skipping.\n", m_path.c_str(),
+                       static_cast<unsigned long long>(m_line), parsed, values);
+            }
+            continue;
+        }
+        if (*cursor != '\0' && *cursor != '\r') {
+            printf("Warning: %s:%llu has more than %zu values, skipping.\n", m_path.c_str(),
+                   static_cast<unsigned long long>(m_line), values);
+            continue;
+        }
+        ++read;
+    }
+    return read;
+}
+
+void CsvDataset::rewind() {
+    fseek(m_file, 0, SEEK_SET);
+    m_chunk_begin = 0;
+    m_chunk_end = 0;
+    m_line = 0;
+}
+
+} // namespace nnlcpp
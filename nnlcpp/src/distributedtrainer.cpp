@@ -0,0 +1,127 @@
+#include "distributedtrainer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <stdio.h>
+
+namespace nnlcpp {
+
+DistributedTrainer::DistributedTrainer(NeuralNetwork& network, Transport& transport, uint32_t batch_size)
+      : m_network(network),
+        m_reduce(transport),
+        m_workspace(network.getLayers(), batch_size),
+        m_gradients(network.getLayers()),
+        m_transfers(m_gradients.getLayerCount()),
+        m_communicator(&DistributedTrainer::communicate, this) {}
+
+DistributedTrainer::~DistributedTrainer() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_work.notify_one();
+    m_communicator.join();
+}
+
+void DistributedTrainer::communicate() {
+    const size_t layers = m_gradients.getLayerCount();
+    while (true) {
+        size_t index;
+        bool   failed;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_work.wait(lock, [this] { return m_stop || m_reduced < m_ready; });
+            if (m_stop)
+                return;
+            index = m_reduced;
+            failed = m_failed;
+        }
+
+        // A layer's weights and biases are adjacent in the arena, so it goes as one array. Once a
+        // link has failed the remaining layers are only counted, to let the step finish.
+        size_t layer = layers - 1 - index;
+        float* first = m_gradients.weights(layer).data();
+        float* last = m_gradients.biases(layer).data() + m_gradients.biases(layer).size();
+        auto   start = std::chrono::steady_clock::now();
+        bool   ok = failed || m_reduce.sum({first, static_cast<size_t>(last - first)});
+        auto   end = std::chrono::steady_clock::now();
+        auto   arrived = failed ? end : std::max(start, std::min(m_reduce.getLastArrival(), end));
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stats.communication_seconds += std::chrono::duration<double>(end - start).count();
+            m_stats.synchronization_seconds += std::chrono::duration<double>(arrived - start).count();
+            m_transfers[index] = {arrived, end};
+            m_failed = m_failed || !ok;
+            ++m_reduced;
+        }
+        m_done.notify_one();
+    }
+}
+
+bool DistributedTrainer::trainBatch(const float* inputs, const float* expected_outputs, uint32_t batch_size,
+                                    uint32_t global_batch_size) {
+    if (global_batch_size == 0 || batch_size > global_batch_size) {
+        printf("Error: A batch of %u samples cannot be part of a global batch of %u.\n", batch_size,
+               global_batch_size);
+        return false;
+    }
+
+    const size_t layers = m_gradients.getLayerCount();
+    auto         handOver = [this](size_t) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ++m_ready;
+        }
+        m_work.notify_one();
+    };
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_ready = 0;
+        m_reduced = 0;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    if (batch_size > 0) {
+        if (!m_network.computeGradients(inputs, expected_outputs, batch_size, m_workspace, m_gradients, handOver))
+            return false;
+    } else {
+        m_gradients.zero();
+        for (size_t i = 0; i < layers; ++i) {
+            handOver(i);
+        }
+    }
+    auto computed = std::chrono::steady_clock::now();
+
+    bool failed;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [&] { return m_reduced == layers; });
+        failed = m_failed;
+    }
+    auto reduced = std::chrono::steady_clock::now();
+
+    // Transfers, or the parts of them, that ran after the backward pass were not hidden by it
+    double exposed = 0.0;
+    for (const Transfer& transfer : m_transfers) {
+        if (transfer.end > computed)
+            exposed += std::chrono::duration<double>(transfer.end - std::max(transfer.start, computed)).count();
+    }
+    double waited = std::chrono::duration<double>(reduced - computed).count();
+    m_stats.compute_seconds += std::chrono::duration<double>(computed - start).count();
+    m_stats.exposed_seconds += exposed;
+    m_stats.stall_seconds += std::max(0.0, waited - exposed);
+    m_stats.bytes_sent = m_reduce.getBytesSent();
+    ++m_stats.steps;
+    m_stats.samples += batch_size;
+    if (failed)
+        return false;
+
+    return m_network.applyGradients(m_gradients, 1.0f / static_cast<float>(global_batch_size));
+}
+
+bool DistributedTrainer::sumAcrossRanks(std::span<float> values) {
+    // The communication thread is idle between steps, so the transport is free to use here
+    return m_reduce.sum(values);
+}
+
+} // namespace nnlcpp
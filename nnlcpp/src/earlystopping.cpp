@@ -0,0 +1,86 @@
+#include "earlystopping.hpp"
+
+#include <stdio.h>
+
+namespace nnlcpp {
+
+void LossTally::add(const float* values, const float* expected, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        double diff = values[i] - expected[i];
+        squared_error += diff * diff;
+        correct += (values[i] >= 0.5f) == (expected[i] >= 0.5f);
+    }
+    outputs += n;
+}
+
+EarlyStopping::EarlyStopping(const Settings& settings) : m_settings(settings) {
+    restart();
+}
+
+void EarlyStopping::restart() {
+    m_start = std::chrono::steady_clock::now();
+    m_epochs = 0;
+    m_loss = 0.0;
+    m_accuracy = 0.0;
+    m_best_loss = std::numeric_limits<double>::infinity();
+    m_stale_epochs = 0;
+    m_reason = Reason::None;
+    m_loss_reached.reset();
+    m_accuracy_reached.reset();
+}
+
+bool EarlyStopping::update(double loss, double accuracy) {
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - m_start;
+    ++m_epochs;
+    m_loss = loss;
+    m_accuracy = accuracy;
+
+    if (!m_accuracy_reached && accuracy >= m_settings.target_accuracy)
+        m_accuracy_reached = Milestone{m_epochs, elapsed.count()};
+    if (m_settings.target_loss > 0.0 && loss <= m_settings.target_loss) {
+        if (!m_loss_reached)
+            m_loss_reached = Milestone{m_epochs, elapsed.count()};
+        m_reason = Reason::TargetLoss;
+        return true;
+    }
+
+    if (loss < m_best_loss - m_settings.min_improvement) {
+        m_best_loss = loss;
+        m_stale_epochs = 0;
+    } else if (m_settings.patience > 0 && ++m_stale_epochs >= m_settings.patience) {
+        m_reason = Reason::Plateau;
+        return true;
+    }
+    return false;
+}
+
+void EarlyStopping::printReport() const {
+    switch (m_reason) {
+    case Reason::TargetLoss:
+        printf("Converged: loss %.6f reached the target %.6f", m_loss, m_settings.target_loss);
+        break;
+    case Reason::Plateau:
+        printf("Stopped: no improvement for %u epochs, loss %.6f", m_settings.patience, m_loss);
+        break;
+    default:
+        printf("Ran to the iteration limit: loss %.6f", m_loss);
+        if (m_settings.target_loss > 0.0)
+            printf(", target %.6f not reached", m_settings.target_loss);
+        break;
+    }
+    printf(" after %llu epochs\n", static_cast<unsigned long long>(m_epochs));
+
+    if (m_loss_reached) {
+        printf("Time to target loss: %.4f s (%llu epochs)\n", m_loss_reached->seconds,
+               static_cast<unsigned long long>(m_loss_reached->epoch));
+    }
+    if (m_accuracy_reached) {
+        printf("Time to %.2f%% accuracy: %.4f s (%llu epochs)\n", 100.0 * m_settings.target_accuracy,
+               m_accuracy_reached->seconds, static_cast<unsigned long long>(m_accuracy_reached->epoch));
+    } else {
+        printf("Accuracy target %.2f%% not reached (%.2f%% at the end)\n", 100.0 * m_settings.target_accuracy,
+               100.0 * m_accuracy);
+    }
+}
+
+} // namespace nnlcpp
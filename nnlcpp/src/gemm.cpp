@@ -0,0 +1,254 @@
+#include "gemm.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace nnlcpp {
+
+namespace {
+
+// Register tile: each micro-kernel call produces an MR x NR block of C held in registers.
+constexpr size_t MR = 6;
+constexpr size_t NR = 8;
+
+// Cache tiles: a KC x NR sliver of packed B stays in L1, an MC x KC block of packed A stays in L2
+// and a KC x NC panel of packed B is shared by every A block of the current column panel.
+constexpr size_t KC = 256;
+constexpr size_t MC = 120;
+constexpr size_t NC = 4096;
+
+// Below this many multiply-adds packing costs more than it saves.
+constexpr size_t SMALL_PROBLEM = 32 * 32 * 32;
+
+struct Operand {
+    ConstMatrixView view;
+    bool            transposed;
+
+    size_t rows() const {
+        return transposed ? view.cols : view.rows;
+    }
+    size_t cols() const {
+        return transposed ? view.rows : view.cols;
+    }
+    float at(size_t row, size_t col) const {
+        return transposed ? view(col, row) : view(row, col);
+    }
+};
+
+// Packing buffers are reused across calls so steady-state multiplies do not allocate.
+std::vector<float>& packBufferA() {
+    thread_local std::vector<float> buffer;
+    return buffer;
+}
+
+std::vector<float>& packBufferB() {
+    thread_local std::vector<float> buffer;
+    return buffer;
+}
+
+// Pack op(A)[row0:row0+mc, k0:k0+kc] into MR-row panels, each stored k-major and zero padded.
+void packA(const Operand& a, size_t row0, size_t mc, size_t k0, size_t kc, float* packed) {
+    for (size_t i = 0; i < mc; i += MR) {
+        size_t rows = std::min(MR, mc - i);
+        for (size_t k = 0; k < kc; ++k) {
+            for (size_t r = 0; r < rows; ++r) {
+                packed[r] = a.at(row0 + i + r, k0 + k);
+            }
+            for (size_t r = rows; r < MR; ++r) {
+                packed[r] = 0.0f;
+            }
+            packed += MR;
+        }
+    }
+}
+
+// Pack op(B)[k0:k0+kc, col0:col0+nc] into NR-column panels, each stored k-major and zero padded.
+void packB(const Operand& b, size_t k0, size_t kc, size_t col0, size_t nc, float* packed) {
+    for (size_t j = 0; j < nc; j += NR) {
+        size_t cols = std::min(NR, nc - j);
+        for (size_t k = 0; k < kc; ++k) {
+            if (!b.transposed && cols == NR) {
+                const float* src = &b.view.data[(k0 + k) * b.view.stride + col0 + j];
+                std::copy(src, src + NR, packed);
+            } else {
+                for (size_t c = 0; c < cols; ++c) {
+                    packed[c] = b.at(k0 + k, col0 + j + c);
+                }
+                for (size_t c = cols; c < NR; ++c) {
+                    packed[c] = 0.0f;
+                }
+            }
+            packed += NR;
+        }
+    }
+}
+
+// C[0:rows, 0:cols] += alpha * Ap * Bp for one MR x NR register tile.
+void microKernel(size_t kc, float alpha, const float* ap, const float* bp, float* c, size_t ldc, size_t rows,
+                 size_t cols) {
+    float acc[MR][NR] = {};
+    for (size_t k = 0; k < kc; ++k) {
+        for (size_t i = 0; i < MR; ++i) {
+            float a_ik = ap[i];
+            for (size_t j = 0; j < NR; ++j) {
+                acc[i][j] += a_ik * bp[j];
+            }
+        }
+        ap += MR;
+        bp += NR;
+    }
+
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            c[i * ldc + j] += alpha * acc[i][j];
+        }
+    }
+}
+
+void scale(MatrixView c, float beta) {
+    if (beta == 1.0f)
+        return;
+    for (size_t i = 0; i < c.rows; ++i) {
+        float* row = &c.data[i * c.stride];
+        if (beta == 0.0f) {
+            std::fill(row, row + c.cols, 0.0f);
+        } else {
+            for (size_t j = 0; j < c.cols; ++j) {
+                row[j] *= beta;
+            }
+        }
+    }
+}
+
+// Unpacked i-k-j loop for shapes too small to amortise packing.
+void multiplySmall(float alpha, const Operand& a, const Operand& b, MatrixView c) {
+    for (size_t i = 0; i < c.rows; ++i) {
+        float* c_row = &c.data[i * c.stride];
+        for (size_t k = 0; k < a.cols(); ++k) {
+            float a_ik = alpha * a.at(i, k);
+            for (size_t j = 0; j < c.cols; ++j) {
+                c_row[j] += a_ik * b.at(k, j);
+            }
+        }
+    }
+}
+
+void multiplyBlocked(float alpha, const Operand& a, const Operand& b, MatrixView c) {
+    size_t m = c.rows;
+    size_t n = c.cols;
+    size_t k = a.cols();
+
+    std::vector<float>& buffer_a = packBufferA();
+    std::vector<float>& buffer_b = packBufferB();
+    size_t              size_a = MC * KC;
+    size_t              size_b = KC * ((std::min(NC, n) + NR - 1) / NR) * NR;
+    if (buffer_a.size() < size_a)
+        buffer_a.resize(size_a);
+    if (buffer_b.size() < size_b)
+        buffer_b.resize(size_b);
+
+    for (size_t jc = 0; jc < n; jc += NC) {
+        size_t nc = std::min(NC, n - jc);
+        for (size_t pc = 0; pc < k; pc += KC) {
+            size_t kc = std::min(KC, k - pc);
+            packB(b, pc, kc, jc, nc, buffer_b.data());
+
+            for (size_t ic = 0; ic < m; ic += MC) {
+                size_t mc = std::min(MC, m - ic);
+                packA(a, ic, mc, pc, kc, buffer_a.data());
+
+                for (size_t jr = 0; jr < nc; jr += NR) {
+                    const float* bp = &buffer_b[jr * kc];
+                    for (size_t ir = 0; ir < mc; ir += MR) {
+                        const float* ap = &buffer_a[ir * kc];
+                        float*       cp = &c.data[(ic + ir) * c.stride + jc + jr];
+                        microKernel(kc, alpha, ap, bp, cp, c.stride, std::min(MR, mc - ir), std::min(NR, nc - jr));
+                    }
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+bool Gemm::multiply(float alpha, ConstMatrixView a, Transpose trans_a, ConstMatrixView b, Transpose trans_b,
+                    float beta, MatrixView c) {
+    Operand op_a{a, trans_a == Transpose::Yes};
+    Operand op_b{b, trans_b == Transpose::Yes};
+
+    if (op_a.cols() != op_b.rows() || c.rows != op_a.rows() || c.cols != op_b.cols()) {
+        printf("Error: Cannot multiply matrix shape [%d,%d] and [%d,%d] into [%d,%d]\n",
+               static_cast<int>(op_a.rows()), static_cast<int>(op_a.cols()), static_cast<int>(op_b.rows()),
+               static_cast<int>(op_b.cols()), static_cast<int>(c.rows), static_cast<int>(c.cols));
+        return false;
+    }
+
+    // A single output column is a matrix-vector product as long as both vectors are contiguous
+    bool x_contiguous = op_b.transposed || b.stride == 1;
+    if (c.cols == 1 && c.stride == 1 && x_contiguous) {
+        return multiplyVector(alpha, a, trans_a, b.data, beta, c.data);
+    }
+
+    scale(c, beta);
+    if (c.rows == 0 || c.cols == 0 || op_a.cols() == 0 || alpha == 0.0f)
+        return true;
+
+    if (c.rows * c.cols * op_a.cols() < SMALL_PROBLEM) {
+        multiplySmall(alpha, op_a, op_b, c);
+    } else {
+        multiplyBlocked(alpha, op_a, op_b, c);
+    }
+    return true;
+}
+
+bool Gemm::multiplyVector(float alpha, ConstMatrixView a, Transpose trans_a, const float* x, float beta,
+                          float* y) {
+    if (trans_a == Transpose::Yes) {
+        // y = alpha * A^T * x walks A row by row and accumulates each row into y, so the
+        // matrix is still streamed contiguously.
+        for (size_t j = 0; j < a.cols; ++j) {
+            y[j] = (beta == 0.0f) ? 0.0f : beta * y[j];
+        }
+        for (size_t i = 0; i < a.rows; ++i) {
+            const float* row = &a.data[i * a.stride];
+            float        scaled_x = alpha * x[i];
+            for (size_t j = 0; j < a.cols; ++j) {
+                y[j] += scaled_x * row[j];
+            }
+        }
+        return true;
+    }
+
+    // Four rows at a time so x is loaded once per group, each row with its own accumulator chain
+    size_t i = 0;
+    for (; i + 4 <= a.rows; i += 4) {
+        const float* r0 = &a.data[i * a.stride];
+        const float* r1 = r0 + a.stride;
+        const float* r2 = r1 + a.stride;
+        const float* r3 = r2 + a.stride;
+        float        s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+        for (size_t k = 0; k < a.cols; ++k) {
+            float x_k = x[k];
+            s0 += r0[k] * x_k;
+            s1 += r1[k] * x_k;
+            s2 += r2[k] * x_k;
+            s3 += r3[k] * x_k;
+        }
+        float sums[4] = {s0, s1, s2, s3};
+        for (size_t r = 0; r < 4; ++r) {
+            y[i + r] = alpha * sums[r] + ((beta == 0.0f) ? 0.0f : beta * y[i + r]);
+        }
+    }
+    for (; i < a.rows; ++i) {
+        const float* row = &a.data[i * a.stride];
+        float        sum = 0.0f;
+        for (size_t k = 0; k < a.cols; ++k) {
+            sum += row[k] * x[k];
+        }
+        y[i] = alpha * sum + ((beta == 0.0f) ? 0.0f : beta * y[i]);
+    }
+    return true;
+}
+
+} // namespace nnlcpp
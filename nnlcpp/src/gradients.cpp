@@ -0,0 +1,36 @@
+#include "gradients.hpp"
+
+#include <stdio.h>
+
+#include "kernels.hpp"
+
+namespace nnlcpp {
+
+Gradients::Gradients(const std::vector<Layer>& layers) {
+    std::vector<uint32_t> topology;
+    if (!layers.empty()) {
+        topology.push_back(layers.front().getCols());
+    }
+    for (const auto& layer : layers) {
+        topology.push_back(layer.getRows());
+    }
+    m_arena = ParameterArena(topology);
+}
+
+void Gradients::zero() {
+    m_arena.zero();
+}
+
+bool Gradients::add(const Gradients& other) {
+    if (!other.m_arena.sameLayout(m_arena)) {
+        printf("Error: Cannot add gradients of %zu layers to %zu layers of a different shape.\n",
+               other.getLayerCount(), getLayerCount());
+        return false;
+    }
+
+    // One kernel call over the whole arena, padding included
+    Kernels::active().add(m_arena.data(), other.m_arena.data(), m_arena.data(), m_arena.size());
+    return true;
+}
+
+} // namespace nnlcpp
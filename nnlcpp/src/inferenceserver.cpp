@@ -0,0 +1,369 @@
+#include "inferenceserver.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace nnlcpp {
+
+size_t LatencyHistogram::bucketOf(uint64_t ns) {
+    if (ns < SUB_BUCKETS)
+        return static_cast<size_t>(ns);
+    int exponent = std::bit_width(ns) - 1; // At least 4
+    return static_cast<size_t>(exponent - 3) * SUB_BUCKETS + ((ns >> (exponent - 4)) & (SUB_BUCKETS - 1));
+}
+
+uint64_t LatencyHistogram::lowerBound(size_t bucket) {
+    if (bucket < SUB_BUCKETS)
+        return bucket;
+    size_t exponent = bucket / SUB_BUCKETS + 3;
+    return (SUB_BUCKETS + bucket % SUB_BUCKETS) << (exponent - 4);
+}
+
+void LatencyHistogram::add(uint64_t ns) {
+    ++m_counts[bucketOf(ns)];
+    ++m_total;
+    m_sum_ns += static_cast<double>(ns);
+}
+
+double LatencyHistogram::percentileNs(double q) const {
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * static_cast<double>(m_total))));
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < m_counts.size(); ++bucket) {
+        seen += m_counts[bucket];
+        if (seen >= rank)
+            return static_cast<double>(lowerBound(bucket));
+    }
+    return 0.0;
+}
+
+InferenceServer::InferenceServer(const NeuralNetwork& network, const Settings& settings)
+      : m_network(network),
+        m_settings(settings),
+        m_input_size(network.getLayers().front().getCols()),
+        m_output_size(network.getLayers().back().getRows()),
+        m_start(std::chrono::steady_clock::now()) {
+    m_settings.max_batch = std::max<uint32_t>(m_settings.max_batch, 1);
+    m_workspace = Workspace(network.getLayers(), m_settings.max_batch);
+    m_inputs.resize(static_cast<size_t>(m_settings.max_batch) * m_input_size);
+    m_outputs.resize(static_cast<size_t>(m_settings.max_batch) * m_output_size);
+    m_batch.reserve(m_settings.max_batch);
+    m_batcher = std::thread(&InferenceServer::batch, this);
+}
+
+InferenceServer::~InferenceServer() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_arrived.notify_one();
+    m_batcher.join();
+}
+
+void InferenceServer::enqueue(Request& request) {
+    request.done = false;
+    request.arrived = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_queue.push_back(&request);
+    // The batcher sleeps until the first request of a batch arrives and then until the batch is
+    // full or due, so only those two moments need waking it
+    if (m_queue.size() == 1 || m_queue.size() == m_settings.max_batch)
+        m_arrived.notify_one();
+}
+
+void InferenceServer::waitFor(Request& request) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_completed.wait(lock, [&request] { return request.done; });
+}
+
+void InferenceServer::batch() {
+    const auto max_wait = std::chrono::microseconds(m_settings.max_wait_us);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_arrived.wait(lock, [this] { return m_stop || !m_queue.empty(); });
+        if (m_queue.empty())
+            return; // Stopping with nothing left to answer
+        m_arrived.wait_until(lock, m_queue.front()->arrived + max_wait,
+                             [this] { return m_stop || m_queue.size() >= m_settings.max_batch; });
+
+        size_t count = std::min<size_t>(m_queue.size(), m_settings.max_batch);
+        m_batch.assign(m_queue.begin(), m_queue.begin() + count);
+        m_queue.erase(m_queue.begin(), m_queue.begin() + count);
+        lock.unlock();
+
+        for (size_t i = 0; i < count; ++i) {
+            std::copy_n(m_batch[i]->input, m_input_size, &m_inputs[i * m_input_size]);
+        }
+        bool ok = m_network.predictBatch(m_inputs.data(), static_cast<uint32_t>(count), m_outputs.data(),
+                                         m_workspace);
+        for (size_t i = 0; i < count; ++i) {
+            if (ok) {
+                std::copy_n(&m_outputs[i * m_output_size], m_output_size, m_batch[i]->output);
+            } else {
+                std::fill_n(m_batch[i]->output, m_output_size, std::nanf(""));
+            }
+        }
+        auto finished = std::chrono::steady_clock::now();
+
+        lock.lock();
+        for (Request* request : m_batch) {
+            request->done = true;
+            m_stats.latency.add(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(finished - request->arrived).count()));
+        }
+        m_stats.requests += count;
+        ++m_stats.batches;
+        m_completed.notify_all();
+    }
+}
+
+bool InferenceServer::parse(const std::string& line, std::vector<float>& input, std::string& reply) {
+    if (line == "?") {
+        reply = "inputs " + std::to_string(m_input_size) + " outputs " + std::to_string(m_output_size) + "\n";
+        return false;
+    }
+
+    input.clear();
+    const char* cursor = line.c_str();
+    while (true) {
+        while (*cursor == ',' || *cursor == ' ' || *cursor == '\t' || *cursor == '\r') {
+            ++cursor;
+        }
+        if (*cursor == '\0')
+            break;
+        char* end = nullptr;
+        float value = std::strtof(cursor, &end);
+        if (end == cursor) {
+            input.clear();
+            break;
+        }
+        input.push_back(value);
+        cursor = end;
+    }
+    if (input.size() == m_input_size)
+        return true;
+
+    reply = "error: expected " + std::to_string(m_input_size) + " numbers\n";
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_stats.rejected;
+    return false;
+}
+
+void InferenceServer::formatOutput(const float* output, std::string& reply) const {
+    char value[32];
+    reply.clear();
+    for (uint32_t i = 0; i < m_output_size; ++i) {
+        snprintf(value, sizeof(value), "%s%.6g", i ? "," : "", output[i]);
+        reply += value;
+    }
+    reply += '\n';
+}
+
+void InferenceServer::serveConnection(int fd) {
+    std::vector<float> input;
+    std::vector<float> output(m_output_size);
+    std::string        pending; // Bytes received after the last complete line
+    std::string        reply;
+    char               buffer[4096];
+    Request            request;
+    request.output = output.data();
+
+    while (true) {
+        ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+        if (received <= 0)
+            return;
+        pending.append(buffer, static_cast<size_t>(received));
+
+        size_t start = 0;
+        size_t newline;
+        while ((newline = pending.find('\n', start)) != std::string::npos) {
+            std::string line = pending.substr(start, newline - start);
+            start = newline + 1;
+            if (line.empty())
+                continue;
+            if (parse(line, input, reply)) {
+                request.input = input.data();
+                enqueue(request);
+                waitFor(request);
+                formatOutput(output.data(), reply);
+            }
+            for (size_t sent = 0; sent < reply.size();) {
+                ssize_t written = send(fd, reply.data() + sent, reply.size() - sent, MSG_NOSIGNAL);
+                if (written <= 0)
+                    return;
+                sent += static_cast<size_t>(written);
+            }
+        }
+        pending.erase(0, start);
+    }
+}
+
+bool InferenceServer::serveSocket(const std::string& path, const std::atomic<bool>& stop) {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        printf("Error: Socket path %s is too long.\n", path.c_str());
+        return false;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    unlink(path.c_str());
+    if (listener < 0 || bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listener, 128) != 0) {
+        printf("Error: Cannot listen on %s: %s\n", path.c_str(), std::strerror(errno));
+        if (listener >= 0)
+            close(listener);
+        return false;
+    }
+    printf("Serving on %s (max batch %u, max wait %u us)\n", path.c_str(), m_settings.max_batch,
+           m_settings.max_wait_us);
+    fflush(stdout);
+
+    struct Connection {
+        int               fd;
+        std::atomic<bool> finished{false};
+        std::thread       thread;
+    };
+    std::list<std::unique_ptr<Connection>> connections;
+    auto                                   reap = [&connections](bool all) {
+        for (auto it = connections.begin(); it != connections.end();) {
+            if (all || (*it)->finished.load()) {
+                shutdown((*it)->fd, SHUT_RDWR); // Unblocks a connection still waiting in recv
+                (*it)->thread.join();
+                close((*it)->fd);
+                it = connections.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    };
+
+    // Poll with a timeout so a stop request is noticed without a connection arriving
+    while (!stop.load()) {
+        pollfd ready = {listener, POLLIN, 0};
+        if (poll(&ready, 1, 100) <= 0)
+            continue;
+        int fd = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0)
+            continue;
+        reap(false);
+        auto connection = std::make_unique<Connection>();
+        connection->fd = fd;
+        connection->thread = std::thread([this, state = connection.get()] {
+            serveConnection(state->fd);
+            state->finished.store(true);
+        });
+        connections.push_back(std::move(connection));
+    }
+
+    reap(true);
+    close(listener);
+    unlink(path.c_str());
+    return true;
+}
+
+bool InferenceServer::serveStream(FILE* in, FILE* out) {
+    // A line on its way through: either a request in flight or an immediate reply
+    struct Pending {
+        Request            request;
+        std::vector<float> input;
+        std::vector<float> output;
+        std::string        reply;
+        bool               queued = false;
+    };
+    std::deque<std::unique_ptr<Pending>> pending;
+    std::mutex                           mutex;
+    std::condition_variable              changed;
+    bool                                 ended = false;
+    const size_t                         max_pending = 4 * static_cast<size_t>(m_settings.max_batch);
+
+    // Answers go out in order from their own thread while the caller keeps reading
+    std::thread writer([&] {
+        while (true) {
+            std::unique_ptr<Pending> next;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&] { return ended || !pending.empty(); });
+                if (pending.empty())
+                    return;
+                next = std::move(pending.front());
+                pending.pop_front();
+            }
+            changed.notify_all();
+            if (next->queued) {
+                waitFor(next->request);
+                formatOutput(next->output.data(), next->reply);
+            }
+            fputs(next->reply.c_str(), out);
+            std::lock_guard<std::mutex> lock(mutex);
+            if (pending.empty())
+                fflush(out);
+        }
+    });
+
+    char*   line = nullptr;
+    size_t  capacity = 0;
+    ssize_t length;
+    while ((length = getline(&line, &capacity, in)) > 0) {
+        std::string text(line, static_cast<size_t>(length));
+        while (!text.empty() && (text.back() == '\n' || text.back() == '\r')) {
+            text.pop_back();
+        }
+        if (text.empty())
+            continue;
+
+        auto next = std::make_unique<Pending>();
+        if (parse(text, next->input, next->reply)) {
+            next->output.resize(m_output_size);
+            next->request.input = next->input.data();
+            next->request.output = next->output.data();
+            next->queued = true;
+            enqueue(next->request);
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [&] { return pending.size() < max_pending; });
+        pending.push_back(std::move(next));
+        changed.notify_all();
+    }
+    free(line);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ended = true;
+    }
+    changed.notify_all();
+    writer.join();
+    fflush(out);
+    return true;
+}
+
+InferenceServer::Stats InferenceServer::getStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Stats                       stats = m_stats;
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+    return stats;
+}
+
+void InferenceServer::printReport() const {
+    Stats stats = getStats();
+    printf("Served %llu requests in %llu batches (%.1f per batch, %llu rejected) over %.3f s: %.0f requests/s\n",
+           static_cast<unsigned long long>(stats.requests), static_cast<unsigned long long>(stats.batches),
+           stats.batches ? static_cast<double>(stats.requests) / static_cast<double>(stats.batches) : 0.0,
+           static_cast<unsigned long long>(stats.rejected), stats.seconds,
+           stats.seconds > 0 ? static_cast<double>(stats.requests) / stats.seconds : 0.0);
+    printf("Server latency: p50 %.1f us, p99 %.1f us, mean %.1f us\n", stats.latency.percentileNs(0.50) / 1e3,
+           stats.latency.percentileNs(0.99) / 1e3, stats.latency.meanNs() / 1e3);
+}
+
+} // namespace nnlcpp
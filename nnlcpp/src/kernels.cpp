@@ -0,0 +1,250 @@
+#include "kernels.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <stdio.h>
+
+#if defined(NNL_X86_KERNELS)
+#include <cpuid.h>
+#endif
+
+namespace nnlcpp {
+
+#if defined(NNL_X86_KERNELS)
+// Defined in the per-ISA translation units, each compiled with its own target flags
+namespace detail {
+extern const KernelTable SSE2_KERNELS;
+extern const KernelTable AVX2_KERNELS;
+extern const KernelTable AVX512_KERNELS;
+} // namespace detail
+#endif
+
+namespace {
+
+void addScalar(const float* a, const float* b, float* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = a[i] + b[i];
+    }
+}
+
+void subtractScalar(const float* a, const float* b, float* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = a[i] - b[i];
+    }
+}
+
+void multiplyScalar(const float* a, const float* b, float* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = a[i] * b[i];
+    }
+}
+
+void divideScalar(const float* a, const float* b, float* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = (b[i] == 0.0f) ? 0.0f : a[i] / b[i];
+    }
+}
+
+template <typename A>
+void activateScalar(const float* x, float* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = A::apply(x[i]);
+    }
+}
+
+template <typename A>
+void multiplyDerivativeScalar(const float* delta, const float* y, float* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = delta[i] * A::derivative(y[i]);
+    }
+}
+
+template <typename A>
+void denseScalar(const float* w, const float* x, const float* b, float* z, float* out, size_t rows, size_t cols) {
+    for (size_t j = 0; j < rows; ++j) {
+        const float* row = w + j * cols;
+        float        sum = b[j];
+        for (size_t k = 0; k < cols; ++k) {
+            sum += row[k] * x[k];
+        }
+        if (z != nullptr)
+            z[j] = sum;
+        out[j] = A::apply(sum);
+    }
+}
+
+template <typename A>
+constexpr ActivationKernels activationKernelsScalar() {
+    return {activateScalar<A>, multiplyDerivativeScalar<A>, denseScalar<A>};
+}
+
+template <typename R>
+void updateScalar(float* w, const float* g, float scale, float* first, float* second, size_t n,
+                  const OptimizerStep& step) {
+    for (size_t i = 0; i < n; ++i) {
+        optimizer::applyAt<R>(w, first, second, i, scale * g[i], step);
+    }
+}
+
+template <typename R>
+void updateOuterScalar(float* w, const float* delta, const float* x, float* next, float* first, float* second,
+                       size_t rows, size_t cols, const OptimizerStep& step) {
+    if (next)
+        std::fill_n(next, cols, 0.0f);
+    for (size_t j = 0; j < rows; ++j) {
+        for (size_t k = 0; k < cols; ++k) {
+            if (next)
+                next[k] += w[j * cols + k] * delta[j];
+            optimizer::applyAt<R>(w, first, second, j * cols + k, delta[j] * x[k], step);
+        }
+    }
+}
+
+template <typename R>
+constexpr OptimizerKernels optimizerKernelsScalar() {
+    return {updateScalar<R>, updateOuterScalar<R>};
+}
+
+void gemvInt8Scalar(const int8_t* a, const int8_t* x, int32_t* out, size_t rows, size_t cols) {
+    for (size_t j = 0; j < rows; ++j) {
+        const int8_t* row = a + j * cols;
+        int32_t       sum = 0;
+        for (size_t k = 0; k < cols; ++k) {
+            sum += static_cast<int32_t>(row[k]) * x[k];
+        }
+        out[j] = sum;
+    }
+}
+
+const KernelTable SCALAR_KERNELS = {
+    "scalar",
+    addScalar,
+    subtractScalar,
+    multiplyScalar,
+    divideScalar,
+    gemvInt8Scalar,
+    {
+        activationKernelsScalar<activation::Sigmoid>(),
+        activationKernelsScalar<activation::SigmoidPoly>(),
+        activationKernelsScalar<activation::SigmoidTable>(),
+        activationKernelsScalar<activation::Tanh>(),
+        activationKernelsScalar<activation::Relu>(),
+        activationKernelsScalar<activation::LeakyRelu>(),
+    },
+    {
+        optimizerKernelsScalar<optimizer::Sgd>(),
+        optimizerKernelsScalar<optimizer::Momentum>(),
+        optimizerKernelsScalar<optimizer::Nesterov>(),
+        optimizerKernelsScalar<optimizer::RmsProp>(),
+        optimizerKernelsScalar<optimizer::Adam>(),
+    },
+};
+
+#if defined(NNL_X86_KERNELS)
+// XCR0 tells us which register files the OS saves on context switch; cpuid alone only says
+// the silicon has them.
+uint64_t readXcr0() {
+    uint32_t eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<uint64_t>(edx) << 32) | eax;
+}
+
+struct CpuFeatures {
+    bool sse2 = false;
+    bool avx2 = false;
+    bool avx512 = false;
+};
+
+CpuFeatures detectCpu() {
+    CpuFeatures  features;
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return features;
+
+    features.sse2 = (edx & bit_SSE2) != 0;
+    bool fma = (ecx & bit_FMA) != 0;
+    bool osxsave = (ecx & bit_OSXSAVE) != 0;
+    if (!osxsave)
+        return features;
+
+    uint64_t xcr0 = readXcr0();
+    bool     os_avx = (xcr0 & 0x6) == 0x6;       // XMM and YMM state
+    bool     os_avx512 = (xcr0 & 0xe6) == 0xe6;  // plus opmask and ZMM state
+
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+        return features;
+
+    features.avx2 = os_avx && fma && (ebx & bit_AVX2) != 0;
+    // The int8 kernels need the byte and word instructions of AVX-512BW, which every AVX-512
+    // core except Xeon Phi has
+    features.avx512 = os_avx512 && (ebx & bit_AVX512F) != 0 && (ebx & bit_AVX512BW) != 0;
+    return features;
+}
+
+const CpuFeatures& cpuFeatures() {
+    static const CpuFeatures features = detectCpu();
+    return features;
+}
+#endif
+
+const KernelTable& select() {
+    const KernelTable* best = &Kernels::scalar();
+    if (const KernelTable* table = Kernels::sse2())
+        best = table;
+    if (const KernelTable* table = Kernels::avx2())
+        best = table;
+    if (const KernelTable* table = Kernels::avx512())
+        best = table;
+
+    const char* requested = std::getenv("NNL_KERNELS");
+    if (requested == nullptr)
+        return *best;
+
+    const KernelTable* candidates[] = {&Kernels::scalar(), Kernels::sse2(), Kernels::avx2(), Kernels::avx512()};
+    for (const KernelTable* table : candidates) {
+        if (table != nullptr && std::strcmp(table->name, requested) == 0)
+            return *table;
+    }
+    printf("Warning: NNL_KERNELS=%s is not available on this CPU, using %s.\n", requested, best->name);
+    return *best;
+}
+
+} // namespace
+
+const KernelTable& Kernels::active() {
+    static const KernelTable& table = select();
+    return table;
+}
+
+const KernelTable& Kernels::scalar() {
+    return SCALAR_KERNELS;
+}
+
+const KernelTable* Kernels::sse2() {
+#if defined(NNL_X86_KERNELS)
+    return cpuFeatures().sse2 ? &detail::SSE2_KERNELS : nullptr;
+#else
+    return nullptr;
+#endif
+}
+
+const KernelTable* Kernels::avx2() {
+#if defined(NNL_X86_KERNELS)
+    return cpuFeatures().avx2 ? &detail::AVX2_KERNELS : nullptr;
+#else
+    return nullptr;
+#endif
+}
+
+const KernelTable* Kernels::avx512() {
+#if defined(NNL_X86_KERNELS)
+    return cpuFeatures().avx512 ? &detail::AVX512_KERNELS : nullptr;
+#else
+    return nullptr;
+#endif
+}
+
+} // namespace nnlcpp
@@ -0,0 +1,424 @@
+#include "kernels.hpp"
+
+#include <algorithm>
+#include <immintrin.h>
+
+namespace nnlcpp {
+
+namespace {
+
+constexpr size_t WIDTH = 8;
+
+// Same range reduction and polynomial as the SSE2 variant, with FMA and a native floor.
+inline __m256 expVec(__m256 x) {
+    x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(-88.0f)), _mm256_set1_ps(88.0f));
+
+    __m256 fx = _mm256_floor_ps(_mm256_fmadd_ps(x, _mm256_set1_ps(1.44269504088896341f), _mm256_set1_ps(0.5f)));
+    x = _mm256_fnmadd_ps(fx, _mm256_set1_ps(0.693359375f), x);
+    x = _mm256_fnmadd_ps(fx, _mm256_set1_ps(-2.12194440e-4f), x);
+
+    __m256 y = _mm256_set1_ps(1.9875691500e-4f);
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(1.3981999507e-3f));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(8.3334519073e-3f));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(4.1665795894e-2f));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(1.6666665459e-1f));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(5.0000001201e-1f));
+    y = _mm256_fmadd_ps(y, _mm256_mul_ps(x, x), _mm256_add_ps(x, _mm256_set1_ps(1.0f)));
+
+    __m256i exponent = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvttps_epi32(fx), _mm256_set1_epi32(127)), 23);
+    return _mm256_mul_ps(y, _mm256_castsi256_ps(exponent));
+}
+
+inline __m256 sigmoidVec(__m256 x) {
+    __m256 one = _mm256_set1_ps(1.0f);
+    return _mm256_div_ps(one, _mm256_add_ps(one, expVec(_mm256_sub_ps(_mm256_setzero_ps(), x))));
+}
+
+// Lane mask with the first `count` lanes enabled, for the masked tail loads and stores
+inline __m256i tailMask(size_t count) {
+    __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    return _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(count)), lanes);
+}
+
+template <typename Op>
+inline void binary(const float* a, const float* b, float* out, size_t n, Op op) {
+    size_t i = 0;
+    for (; i + WIDTH <= n; i += WIDTH) {
+        _mm256_storeu_ps(out + i, op(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    }
+    if (i < n) {
+        __m256i mask = tailMask(n - i);
+        _mm256_maskstore_ps(out + i, mask, op(_mm256_maskload_ps(a + i, mask), _mm256_maskload_ps(b + i, mask)));
+    }
+}
+
+void add(const float* a, const float* b, float* out, size_t n) {
+    binary(a, b, out, n, [](__m256 x, __m256 y) { return _mm256_add_ps(x, y); });
+}
+
+void subtract(const float* a, const float* b, float* out, size_t n) {
+    binary(a, b, out, n, [](__m256 x, __m256 y) { return _mm256_sub_ps(x, y); });
+}
+
+void multiply(const float* a, const float* b, float* out, size_t n) {
+    binary(a, b, out, n, [](__m256 x, __m256 y) { return _mm256_mul_ps(x, y); });
+}
+
+void divide(const float* a, const float* b, float* out, size_t n) {
+    binary(a, b, out, n, [](__m256 x, __m256 y) {
+        __m256 nonzero = _mm256_cmp_ps(y, _mm256_setzero_ps(), _CMP_NEQ_UQ);
+        return _mm256_and_ps(nonzero, _mm256_div_ps(x, y));
+    });
+}
+
+// Dot products of WIDTH rows with x, one FMA accumulator per row, folded with a hadd tree so
+// lane r holds row r's total. The column tail is a masked load. Rows past the end of the matrix
+// point at a valid row and are discarded.
+inline __m256 dotRows(const float* const (&rows)[WIDTH], const float* x, size_t cols) {
+    __m256 acc[WIDTH];
+    for (size_t r = 0; r < WIDTH; ++r) {
+        acc[r] = _mm256_setzero_ps();
+    }
+    size_t k = 0;
+    for (; k + WIDTH <= cols; k += WIDTH) {
+        __m256 v = _mm256_loadu_ps(x + k);
+        for (size_t r = 0; r < WIDTH; ++r) {
+            acc[r] = _mm256_fmadd_ps(_mm256_loadu_ps(rows[r] + k), v, acc[r]);
+        }
+    }
+    if (k < cols) {
+        __m256i mask = tailMask(cols - k);
+        __m256  v = _mm256_maskload_ps(x + k, mask);
+        for (size_t r = 0; r < WIDTH; ++r) {
+            acc[r] = _mm256_fmadd_ps(_mm256_maskload_ps(rows[r] + k, mask), v, acc[r]);
+        }
+    }
+
+    __m256 pairs01 = _mm256_hadd_ps(acc[0], acc[1]);
+    __m256 pairs23 = _mm256_hadd_ps(acc[2], acc[3]);
+    __m256 pairs45 = _mm256_hadd_ps(acc[4], acc[5]);
+    __m256 pairs67 = _mm256_hadd_ps(acc[6], acc[7]);
+    __m256 quads0 = _mm256_hadd_ps(pairs01, pairs23);
+    __m256 quads1 = _mm256_hadd_ps(pairs45, pairs67);
+    return _mm256_add_ps(_mm256_permute2f128_ps(quads0, quads1, 0x20), _mm256_permute2f128_ps(quads0, quads1, 0x31));
+}
+
+// Vector activation policies mirroring activation::*
+struct Sigmoid {
+    static __m256 apply(__m256 z) {
+        return sigmoidVec(z);
+    }
+    static __m256 derivative(__m256 y) {
+        return _mm256_mul_ps(y, _mm256_sub_ps(_mm256_set1_ps(1.0f), y));
+    }
+};
+
+// The eight pieces' coefficients each fit one register, so a lane picks its piece with a
+// variable permute instead of a gather
+struct SigmoidPoly {
+    static __m256 apply(__m256 z) {
+        __m256  one = _mm256_set1_ps(1.0f);
+        __m256  magnitude = _mm256_andnot_ps(_mm256_set1_ps(-0.0f), z);
+        __m256i piece = _mm256_min_epi32(_mm256_cvttps_epi32(magnitude),
+                                         _mm256_set1_epi32(activation::SIGMOID_POLY_PIECES - 1));
+        __m256  t = _mm256_sub_ps(magnitude, _mm256_cvtepi32_ps(piece));
+        auto    coefficient = [&](size_t power) {
+            return _mm256_permutevar8x32_ps(_mm256_loadu_ps(activation::SIGMOID_POLY_COEFFICIENTS[power]), piece);
+        };
+
+        __m256 p = _mm256_fmadd_ps(coefficient(3), t, coefficient(2));
+        p = _mm256_fmadd_ps(p, t, coefficient(1));
+        p = _mm256_fmadd_ps(p, t, coefficient(0));
+        p = _mm256_blendv_ps(p, one, _mm256_cmp_ps(magnitude, _mm256_set1_ps(activation::SIGMOID_POLY_LIMIT), _CMP_GE_OQ));
+        return _mm256_blendv_ps(p, _mm256_sub_ps(one, p), z); // Mirror where z's sign bit is set
+    }
+    static __m256 derivative(__m256 y) {
+        return Sigmoid::derivative(y);
+    }
+};
+
+struct SigmoidTable {
+    static __m256 apply(__m256 z) {
+        __m256  limit = _mm256_set1_ps(activation::SIGMOID_TABLE_LIMIT);
+        __m256  clamped = _mm256_min_ps(_mm256_max_ps(z, _mm256_sub_ps(_mm256_setzero_ps(), limit)), limit);
+        __m256  u = _mm256_mul_ps(_mm256_add_ps(clamped, limit), _mm256_set1_ps(activation::SIGMOID_TABLE_STEPS_PER_UNIT));
+        __m256i i = _mm256_min_epi32(_mm256_cvttps_epi32(u), _mm256_set1_epi32(activation::SIGMOID_TABLE_INTERVALS - 1));
+        __m256  t = _mm256_sub_ps(u, _mm256_cvtepi32_ps(i));
+        __m256  low = _mm256_i32gather_ps(activation::SIGMOID_TABLE.data(), i, sizeof(float));
+        __m256  high = _mm256_i32gather_ps(activation::SIGMOID_TABLE.data() + 1, i, sizeof(float));
+        return _mm256_fmadd_ps(t, _mm256_sub_ps(high, low), low);
+    }
+    static __m256 derivative(__m256 y) {
+        return Sigmoid::derivative(y);
+    }
+};
+
+// tanh(z) = 2 sigmoid(2z) - 1
+struct Tanh {
+    static __m256 apply(__m256 z) {
+        __m256 two = _mm256_set1_ps(2.0f);
+        return _mm256_fmsub_ps(two, sigmoidVec(_mm256_mul_ps(two, z)), _mm256_set1_ps(1.0f));
+    }
+    static __m256 derivative(__m256 y) {
+        return _mm256_fnmadd_ps(y, y, _mm256_set1_ps(1.0f));
+    }
+};
+
+struct Relu {
+    static __m256 apply(__m256 z) {
+        return _mm256_max_ps(z, _mm256_setzero_ps());
+    }
+    static __m256 derivative(__m256 y) {
+        return _mm256_and_ps(_mm256_cmp_ps(y, _mm256_setzero_ps(), _CMP_GT_OQ), _mm256_set1_ps(1.0f));
+    }
+};
+
+struct LeakyRelu {
+    static __m256 apply(__m256 z) {
+        return _mm256_max_ps(z, _mm256_mul_ps(z, _mm256_set1_ps(activation::LEAKY_RELU_SLOPE)));
+    }
+    static __m256 derivative(__m256 y) {
+        return _mm256_blendv_ps(_mm256_set1_ps(activation::LEAKY_RELU_SLOPE), _mm256_set1_ps(1.0f),
+                                _mm256_cmp_ps(y, _mm256_setzero_ps(), _CMP_GT_OQ));
+    }
+};
+
+template <typename A>
+void activate(const float* x, float* out, size_t n) {
+    binary(x, x, out, n, [](__m256 v, __m256) { return A::apply(v); });
+}
+
+template <typename A>
+void multiplyDerivative(const float* delta, const float* y, float* out, size_t n) {
+    binary(delta, y, out, n, [](__m256 d, __m256 v) { return _mm256_mul_ps(d, A::derivative(v)); });
+}
+
+template <typename A>
+void dense(const float* w, const float* x, const float* b, float* z, float* out, size_t rows, size_t cols) {
+    for (size_t j = 0; j < rows; j += WIDTH) {
+        size_t       count = std::min(WIDTH, rows - j);
+        const float* row_ptrs[WIDTH];
+        for (size_t r = 0; r < WIDTH; ++r) {
+            row_ptrs[r] = w + (j + std::min(r, count - 1)) * cols;
+        }
+        __m256i mask = tailMask(count);
+        __m256  sums = _mm256_add_ps(dotRows(row_ptrs, x, cols), _mm256_maskload_ps(b + j, mask));
+        if (z != nullptr)
+            _mm256_maskstore_ps(z + j, mask, sums);
+        _mm256_maskstore_ps(out + j, mask, A::apply(sums));
+    }
+}
+
+template <typename A>
+constexpr ActivationKernels activationKernels() {
+    return {activate<A>, multiplyDerivative<A>, dense<A>};
+}
+
+// One optimizer step's hyperparameters, broadcast once per kernel call
+struct StepVec {
+    __m256 learning_rate;
+    __m256 first_decay;
+    __m256 second_decay;
+    __m256 first_rest;  // 1 - first_decay
+    __m256 second_rest; // 1 - second_decay
+    __m256 epsilon;
+
+    explicit StepVec(const OptimizerStep& step)
+          : learning_rate(_mm256_set1_ps(step.learning_rate)),
+            first_decay(_mm256_set1_ps(step.first_decay)),
+            second_decay(_mm256_set1_ps(step.second_decay)),
+            first_rest(_mm256_set1_ps(1.0f - step.first_decay)),
+            second_rest(_mm256_set1_ps(1.0f - step.second_decay)),
+            epsilon(_mm256_set1_ps(step.epsilon)) {}
+};
+
+// Vector update rules mirroring optimizer::*
+struct Sgd {
+    static constexpr int STATES = 0;
+    static __m256 apply(__m256 w, __m256 g, __m256&, __m256&, const StepVec& c) {
+        return _mm256_fmadd_ps(c.learning_rate, g, w);
+    }
+};
+
+struct Momentum {
+    static constexpr int STATES = 1;
+    static __m256 apply(__m256 w, __m256 g, __m256& v, __m256&, const StepVec& c) {
+        v = _mm256_fmadd_ps(c.first_decay, v, g);
+        return _mm256_fmadd_ps(c.learning_rate, v, w);
+    }
+};
+
+struct Nesterov {
+    static constexpr int STATES = 1;
+    static __m256 apply(__m256 w, __m256 g, __m256& v, __m256&, const StepVec& c) {
+        v = _mm256_fmadd_ps(c.first_decay, v, g);
+        return _mm256_fmadd_ps(c.learning_rate, _mm256_fmadd_ps(c.first_decay, v, g), w);
+    }
+};
+
+struct RmsProp {
+    static constexpr int STATES = 1;
+    static __m256 apply(__m256 w, __m256 g, __m256& s, __m256&, const StepVec& c) {
+        s = _mm256_fmadd_ps(c.second_decay, s, _mm256_mul_ps(c.second_rest, _mm256_mul_ps(g, g)));
+        return _mm256_fmadd_ps(c.learning_rate, _mm256_div_ps(g, _mm256_add_ps(_mm256_sqrt_ps(s), c.epsilon)), w);
+    }
+};
+
+struct Adam {
+    static constexpr int STATES = 2;
+    static __m256 apply(__m256 w, __m256 g, __m256& m, __m256& v, const StepVec& c) {
+        m = _mm256_fmadd_ps(c.first_decay, m, _mm256_mul_ps(c.first_rest, g));
+        v = _mm256_fmadd_ps(c.second_decay, v, _mm256_mul_ps(c.second_rest, _mm256_mul_ps(g, g)));
+        return _mm256_fmadd_ps(c.learning_rate, _mm256_div_ps(m, _mm256_add_ps(_mm256_sqrt_ps(v), c.epsilon)), w);
+    }
+};
+
+// Full-width and masked-tail memory access for the update kernels
+struct FullLanes {
+    __m256 load(const float* p) const {
+        return _mm256_loadu_ps(p);
+    }
+    void store(float* p, __m256 v) const {
+        _mm256_storeu_ps(p, v);
+    }
+};
+
+struct TailLanes {
+    __m256i mask;
+    __m256  load(const float* p) const {
+        return _mm256_maskload_ps(p, mask);
+    }
+    void store(float* p, __m256 v) const {
+        _mm256_maskstore_ps(p, mask, v);
+    }
+};
+
+// Load the weights and the state R uses at offset i, apply R with gradient g and store them back.
+// Returns the weights as they were.
+template <typename R, typename Lanes>
+inline __m256 updateLanes(const Lanes& lanes, float* w, float* first, float* second, size_t i, __m256 g,
+                          const StepVec& c) {
+    __m256 s1 = _mm256_setzero_ps();
+    __m256 s2 = _mm256_setzero_ps();
+    if constexpr (R::STATES >= 1)
+        s1 = lanes.load(first + i);
+    if constexpr (R::STATES >= 2)
+        s2 = lanes.load(second + i);
+    __m256 old = lanes.load(w + i);
+    lanes.store(w + i, R::apply(old, g, s1, s2, c));
+    if constexpr (R::STATES >= 1)
+        lanes.store(first + i, s1);
+    if constexpr (R::STATES >= 2)
+        lanes.store(second + i, s2);
+    return old;
+}
+
+template <typename R>
+void update(float* w, const float* g, float scale, float* first, float* second, size_t n, const OptimizerStep& step) {
+    const StepVec c(step);
+    const __m256  s = _mm256_set1_ps(scale);
+    size_t        i = 0;
+    for (; i + WIDTH <= n; i += WIDTH) {
+        FullLanes lanes;
+        updateLanes<R>(lanes, w, first, second, i, _mm256_mul_ps(s, lanes.load(g + i)), c);
+    }
+    if (i < n) {
+        TailLanes lanes{tailMask(n - i)};
+        updateLanes<R>(lanes, w, first, second, i, _mm256_mul_ps(s, lanes.load(g + i)), c);
+    }
+}
+
+template <typename R>
+void updateOuter(float* w, const float* delta, const float* x, float* next, float* first, float* second,
+                 size_t rows, size_t cols, const OptimizerStep& step) {
+    const StepVec c(step);
+    if (next)
+        std::fill_n(next, cols, 0.0f);
+    // Rows go in blocks so each slice of x and next is loaded, and next stored, once per block
+    constexpr size_t BLOCK = 4;
+    for (size_t j = 0; j < rows; j += BLOCK) {
+        const size_t block = std::min(BLOCK, rows - j);
+        auto         tile = [&](const auto& lanes, size_t k) {
+            const __m256 xk = lanes.load(x + k);
+            __m256       sum = _mm256_setzero_ps();
+            for (size_t r = 0; r < block; ++r) {
+                const __m256 d = _mm256_set1_ps(delta[j + r]);
+                __m256       old = updateLanes<R>(lanes, w, first, second, (j + r) * cols + k, _mm256_mul_ps(d, xk), c);
+                sum = _mm256_fmadd_ps(old, d, sum);
+            }
+            if (next)
+                lanes.store(next + k, _mm256_add_ps(lanes.load(next + k), sum));
+        };
+        size_t k = 0;
+        for (; k + WIDTH <= cols; k += WIDTH) {
+            tile(FullLanes{}, k);
+        }
+        if (k < cols)
+            tile(TailLanes{tailMask(cols - k)}, k);
+    }
+}
+
+template <typename R>
+constexpr OptimizerKernels optimizerKernels() {
+    return {update<R>, updateOuter<R>};
+}
+
+inline int32_t horizontalSum(__m256i v) {
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum);
+}
+
+// maddubs multiplies unsigned by signed bytes, so move x's sign onto w: |x| * (w * sign(x)) is
+// w * x. With both in [-127, 127] each pair sums to at most 32258 and never saturates int16.
+void gemvInt8(const int8_t* a, const int8_t* x, int32_t* out, size_t rows, size_t cols) {
+    constexpr size_t BYTES = 32;
+    const __m256i    ones = _mm256_set1_epi16(1);
+    for (size_t j = 0; j < rows; ++j) {
+        const int8_t* row = a + j * cols;
+        __m256i       acc = _mm256_setzero_si256();
+        size_t        k = 0;
+        for (; k + BYTES <= cols; k += BYTES) {
+            __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + k));
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + k));
+            __m256i pairs = _mm256_maddubs_epi16(_mm256_sign_epi8(v, v), _mm256_sign_epi8(w, v));
+            acc = _mm256_add_epi32(acc, _mm256_madd_epi16(pairs, ones));
+        }
+        int32_t sum = horizontalSum(acc);
+        for (; k < cols; ++k) {
+            sum += static_cast<int32_t>(row[k]) * x[k];
+        }
+        out[j] = sum;
+    }
+}
+
+} // namespace
+
+namespace detail {
+extern const KernelTable AVX2_KERNELS = {
+    "avx2",
+    add,
+    subtract,
+    multiply,
+    divide,
+    gemvInt8,
+    {
+        activationKernels<Sigmoid>(),
+        activationKernels<SigmoidPoly>(),
+        activationKernels<SigmoidTable>(),
+        activationKernels<Tanh>(),
+        activationKernels<Relu>(),
+        activationKernels<LeakyRelu>(),
+    },
+    {
+        optimizerKernels<Sgd>(),
+        optimizerKernels<Momentum>(),
+        optimizerKernels<Nesterov>(),
+        optimizerKernels<RmsProp>(),
+        optimizerKernels<Adam>(),
+    },
+};
+} // namespace detail
+
+} // namespace nnlcpp
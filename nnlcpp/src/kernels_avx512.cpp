@@ -0,0 +1,429 @@
+#include "kernels.hpp"
+
+#include <algorithm>
+#include <immintrin.h>
+
+namespace nnlcpp {
+
+namespace {
+
+constexpr size_t WIDTH = 16;
+
+// Same range reduction and polynomial as the SSE2 variant; scalef applies 2^n without the
+// exponent bit splice.
+inline __m512 expVec(__m512 x) {
+    x = _mm512_min_ps(_mm512_max_ps(x, _mm512_set1_ps(-88.0f)), _mm512_set1_ps(88.0f));
+
+    __m512 fx = _mm512_roundscale_ps(_mm512_fmadd_ps(x, _mm512_set1_ps(1.44269504088896341f), _mm512_set1_ps(0.5f)),
+                                     _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+    x = _mm512_fnmadd_ps(fx, _mm512_set1_ps(0.693359375f), x);
+    x = _mm512_fnmadd_ps(fx, _mm512_set1_ps(-2.12194440e-4f), x);
+
+    __m512 y = _mm512_set1_ps(1.9875691500e-4f);
+    y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(1.3981999507e-3f));
+    y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(8.3334519073e-3f));
+    y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(4.1665795894e-2f));
+    y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(1.6666665459e-1f));
+    y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(5.0000001201e-1f));
+    y = _mm512_fmadd_ps(y, _mm512_mul_ps(x, x), _mm512_add_ps(x, _mm512_set1_ps(1.0f)));
+
+    return _mm512_scalef_ps(y, fx);
+}
+
+inline __m512 sigmoidVec(__m512 x) {
+    __m512 one = _mm512_set1_ps(1.0f);
+    return _mm512_div_ps(one, _mm512_add_ps(one, expVec(_mm512_sub_ps(_mm512_setzero_ps(), x))));
+}
+
+template <typename Op>
+inline void binary(const float* a, const float* b, float* out, size_t n, Op op) {
+    size_t i = 0;
+    for (; i + WIDTH <= n; i += WIDTH) {
+        _mm512_storeu_ps(out + i, op(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i)));
+    }
+    if (i < n) {
+        __mmask16 mask = static_cast<__mmask16>((1u << (n - i)) - 1);
+        _mm512_mask_storeu_ps(out + i, mask, op(_mm512_maskz_loadu_ps(mask, a + i), _mm512_maskz_loadu_ps(mask, b + i)));
+    }
+}
+
+void add(const float* a, const float* b, float* out, size_t n) {
+    binary(a, b, out, n, [](__m512 x, __m512 y) { return _mm512_add_ps(x, y); });
+}
+
+void subtract(const float* a, const float* b, float* out, size_t n) {
+    binary(a, b, out, n, [](__m512 x, __m512 y) { return _mm512_sub_ps(x, y); });
+}
+
+void multiply(const float* a, const float* b, float* out, size_t n) {
+    binary(a, b, out, n, [](__m512 x, __m512 y) { return _mm512_mul_ps(x, y); });
+}
+
+void divide(const float* a, const float* b, float* out, size_t n) {
+    binary(a, b, out, n, [](__m512 x, __m512 y) {
+        __mmask16 nonzero = _mm512_cmp_ps_mask(y, _mm512_setzero_ps(), _CMP_NEQ_UQ);
+        return _mm512_maskz_div_ps(nonzero, x, y);
+    });
+}
+
+// Dot products of eight rows with x, one zmm accumulator per row, folded to 256 bits and then
+// through a hadd tree so lane r holds row r's total. The column tail is a masked load.
+inline __m256 dotEightRows(const float* const* rows, const float* x, size_t cols) {
+    constexpr size_t ROWS = 8;
+    __m512           acc[ROWS];
+    for (size_t r = 0; r < ROWS; ++r) {
+        acc[r] = _mm512_setzero_ps();
+    }
+    size_t k = 0;
+    for (; k + WIDTH <= cols; k += WIDTH) {
+        __m512 v = _mm512_loadu_ps(x + k);
+        for (size_t r = 0; r < ROWS; ++r) {
+            acc[r] = _mm512_fmadd_ps(_mm512_loadu_ps(rows[r] + k), v, acc[r]);
+        }
+    }
+    if (k < cols) {
+        __mmask16 mask = static_cast<__mmask16>((1u << (cols - k)) - 1);
+        __m512    v = _mm512_maskz_loadu_ps(mask, x + k);
+        for (size_t r = 0; r < ROWS; ++r) {
+            acc[r] = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, rows[r] + k), v, acc[r]);
+        }
+    }
+
+    __m256 halves[ROWS];
+    for (size_t r = 0; r < ROWS; ++r) {
+        __m256 high = _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(acc[r]), 1));
+        halves[r] = _mm256_add_ps(_mm512_castps512_ps256(acc[r]), high);
+    }
+    __m256 pairs01 = _mm256_hadd_ps(halves[0], halves[1]);
+    __m256 pairs23 = _mm256_hadd_ps(halves[2], halves[3]);
+    __m256 pairs45 = _mm256_hadd_ps(halves[4], halves[5]);
+    __m256 pairs67 = _mm256_hadd_ps(halves[6], halves[7]);
+    __m256 quads0 = _mm256_hadd_ps(pairs01, pairs23);
+    __m256 quads1 = _mm256_hadd_ps(pairs45, pairs67);
+    return _mm256_add_ps(_mm256_permute2f128_ps(quads0, quads1, 0x20), _mm256_permute2f128_ps(quads0, quads1, 0x31));
+}
+
+// Vector activation policies mirroring activation::*
+struct Sigmoid {
+    static __m512 apply(__m512 z) {
+        return sigmoidVec(z);
+    }
+    static __m512 derivative(__m512 y) {
+        return _mm512_mul_ps(y, _mm512_sub_ps(_mm512_set1_ps(1.0f), y));
+    }
+};
+
+// Each lane picks its piece's coefficients with a variable permute of an eight-entry register
+struct SigmoidPoly {
+    static __m512 apply(__m512 z) {
+        __m512  one = _mm512_set1_ps(1.0f);
+        __m512  magnitude = _mm512_abs_ps(z);
+        __m512i piece = _mm512_min_epi32(_mm512_cvttps_epi32(magnitude),
+                                         _mm512_set1_epi32(activation::SIGMOID_POLY_PIECES - 1));
+        __m512  t = _mm512_sub_ps(magnitude, _mm512_cvtepi32_ps(piece));
+        auto    coefficient = [&](size_t power) {
+            return _mm512_permutexvar_ps(piece, _mm512_maskz_loadu_ps(0xff, activation::SIGMOID_POLY_COEFFICIENTS[power]));
+        };
+
+        __m512 p = _mm512_fmadd_ps(coefficient(3), t, coefficient(2));
+        p = _mm512_fmadd_ps(p, t, coefficient(1));
+        p = _mm512_fmadd_ps(p, t, coefficient(0));
+        __mmask16 saturated = _mm512_cmp_ps_mask(magnitude, _mm512_set1_ps(activation::SIGMOID_POLY_LIMIT), _CMP_GE_OQ);
+        p = _mm512_mask_blend_ps(saturated, p, one);
+        __mmask16 negative = _mm512_cmp_ps_mask(z, _mm512_setzero_ps(), _CMP_LT_OQ);
+        return _mm512_mask_sub_ps(p, negative, one, p);
+    }
+    static __m512 derivative(__m512 y) {
+        return Sigmoid::derivative(y);
+    }
+};
+
+struct SigmoidTable {
+    static __m512 apply(__m512 z) {
+        __m512  limit = _mm512_set1_ps(activation::SIGMOID_TABLE_LIMIT);
+        __m512  clamped = _mm512_min_ps(_mm512_max_ps(z, _mm512_sub_ps(_mm512_setzero_ps(), limit)), limit);
+        __m512  u = _mm512_mul_ps(_mm512_add_ps(clamped, limit), _mm512_set1_ps(activation::SIGMOID_TABLE_STEPS_PER_UNIT));
+        __m512i i = _mm512_min_epi32(_mm512_cvttps_epi32(u), _mm512_set1_epi32(activation::SIGMOID_TABLE_INTERVALS - 1));
+        __m512  t = _mm512_sub_ps(u, _mm512_cvtepi32_ps(i));
+        __m512  low = _mm512_i32gather_ps(i, activation::SIGMOID_TABLE.data(), sizeof(float));
+        __m512  high = _mm512_i32gather_ps(i, activation::SIGMOID_TABLE.data() + 1, sizeof(float));
+        return _mm512_fmadd_ps(t, _mm512_sub_ps(high, low), low);
+    }
+    static __m512 derivative(__m512 y) {
+        return Sigmoid::derivative(y);
+    }
+};
+
+// tanh(z) = 2 sigmoid(2z) - 1
+struct Tanh {
+    static __m512 apply(__m512 z) {
+        __m512 two = _mm512_set1_ps(2.0f);
+        return _mm512_fmsub_ps(two, sigmoidVec(_mm512_mul_ps(two, z)), _mm512_set1_ps(1.0f));
+    }
+    static __m512 derivative(__m512 y) {
+        return _mm512_fnmadd_ps(y, y, _mm512_set1_ps(1.0f));
+    }
+};
+
+struct Relu {
+    static __m512 apply(__m512 z) {
+        return _mm512_max_ps(z, _mm512_setzero_ps());
+    }
+    static __m512 derivative(__m512 y) {
+        return _mm512_maskz_mov_ps(_mm512_cmp_ps_mask(y, _mm512_setzero_ps(), _CMP_GT_OQ), _mm512_set1_ps(1.0f));
+    }
+};
+
+struct LeakyRelu {
+    static __m512 apply(__m512 z) {
+        return _mm512_max_ps(z, _mm512_mul_ps(z, _mm512_set1_ps(activation::LEAKY_RELU_SLOPE)));
+    }
+    static __m512 derivative(__m512 y) {
+        return _mm512_mask_blend_ps(_mm512_cmp_ps_mask(y, _mm512_setzero_ps(), _CMP_GT_OQ),
+                                    _mm512_set1_ps(activation::LEAKY_RELU_SLOPE), _mm512_set1_ps(1.0f));
+    }
+};
+
+template <typename A>
+void activate(const float* x, float* out, size_t n) {
+    binary(x, x, out, n, [](__m512 v, __m512) { return A::apply(v); });
+}
+
+template <typename A>
+void multiplyDerivative(const float* delta, const float* y, float* out, size_t n) {
+    binary(delta, y, out, n, [](__m512 d, __m512 v) { return _mm512_mul_ps(d, A::derivative(v)); });
+}
+
+// Sixteen rows per step as two groups of eight, so the accumulators fit in registers. Rows past
+// the end of the matrix point at a valid row and are masked off on store.
+template <typename A>
+void dense(const float* w, const float* x, const float* b, float* z, float* out, size_t rows, size_t cols) {
+    for (size_t j = 0; j < rows; j += WIDTH) {
+        size_t       count = std::min(WIDTH, rows - j);
+        const float* row_ptrs[WIDTH];
+        for (size_t r = 0; r < WIDTH; ++r) {
+            row_ptrs[r] = w + (j + std::min(r, count - 1)) * cols;
+        }
+        __m256 low = dotEightRows(row_ptrs, x, cols);
+        __m256 high = (count > 8) ? dotEightRows(row_ptrs + 8, x, cols) : _mm256_setzero_ps();
+
+        __mmask16 mask = static_cast<__mmask16>((1u << count) - 1);
+        __m512    sums = _mm512_castpd_ps(_mm512_insertf64x4(_mm512_castps_pd(_mm512_castps256_ps512(low)),
+                                                              _mm256_castps_pd(high), 1));
+        sums = _mm512_add_ps(sums, _mm512_maskz_loadu_ps(mask, b + j));
+        if (z != nullptr)
+            _mm512_mask_storeu_ps(z + j, mask, sums);
+        _mm512_mask_storeu_ps(out + j, mask, A::apply(sums));
+    }
+}
+
+template <typename A>
+constexpr ActivationKernels activationKernels() {
+    return {activate<A>, multiplyDerivative<A>, dense<A>};
+}
+
+// One optimizer step's hyperparameters, broadcast once per kernel call
+struct StepVec {
+    __m512 learning_rate;
+    __m512 first_decay;
+    __m512 second_decay;
+    __m512 first_rest;  // 1 - first_decay
+    __m512 second_rest; // 1 - second_decay
+    __m512 epsilon;
+
+    explicit StepVec(const OptimizerStep& step)
+          : learning_rate(_mm512_set1_ps(step.learning_rate)),
+            first_decay(_mm512_set1_ps(step.first_decay)),
+            second_decay(_mm512_set1_ps(step.second_decay)),
+            first_rest(_mm512_set1_ps(1.0f - step.first_decay)),
+            second_rest(_mm512_set1_ps(1.0f - step.second_decay)),
+            epsilon(_mm512_set1_ps(step.epsilon)) {}
+};
+
+// Vector update rules mirroring optimizer::*
+struct Sgd {
+    static constexpr int STATES = 0;
+    static __m512 apply(__m512 w, __m512 g, __m512&, __m512&, const StepVec& c) {
+        return _mm512_fmadd_ps(c.learning_rate, g, w);
+    }
+};
+
+struct Momentum {
+    static constexpr int STATES = 1;
+    static __m512 apply(__m512 w, __m512 g, __m512& v, __m512&, const StepVec& c) {
+        v = _mm512_fmadd_ps(c.first_decay, v, g);
+        return _mm512_fmadd_ps(c.learning_rate, v, w);
+    }
+};
+
+struct Nesterov {
+    static constexpr int STATES = 1;
+    static __m512 apply(__m512 w, __m512 g, __m512& v, __m512&, const StepVec& c) {
+        v = _mm512_fmadd_ps(c.first_decay, v, g);
+        return _mm512_fmadd_ps(c.learning_rate, _mm512_fmadd_ps(c.first_decay, v, g), w);
+    }
+};
+
+struct RmsProp {
+    static constexpr int STATES = 1;
+    static __m512 apply(__m512 w, __m512 g, __m512& s, __m512&, const StepVec& c) {
+        s = _mm512_fmadd_ps(c.second_decay, s, _mm512_mul_ps(c.second_rest, _mm512_mul_ps(g, g)));
+        return _mm512_fmadd_ps(c.learning_rate, _mm512_div_ps(g, _mm512_add_ps(_mm512_sqrt_ps(s), c.epsilon)), w);
+    }
+};
+
+struct Adam {
+    static constexpr int STATES = 2;
+    static __m512 apply(__m512 w, __m512 g, __m512& m, __m512& v, const StepVec& c) {
+        m = _mm512_fmadd_ps(c.first_decay, m, _mm512_mul_ps(c.first_rest, g));
+        v = _mm512_fmadd_ps(c.second_decay, v, _mm512_mul_ps(c.second_rest, _mm512_mul_ps(g, g)));
+        return _mm512_fmadd_ps(c.learning_rate, _mm512_div_ps(m, _mm512_add_ps(_mm512_sqrt_ps(v), c.epsilon)), w);
+    }
+};
+
+// Full-width and masked-tail memory access for the update kernels
+struct FullLanes {
+    __m512 load(const float* p) const {
+        return _mm512_loadu_ps(p);
+    }
+    void store(float* p, __m512 v) const {
+        _mm512_storeu_ps(p, v);
+    }
+};
+
+struct TailLanes {
+    __mmask16 mask;
+    __m512    load(const float* p) const {
+        return _mm512_maskz_loadu_ps(mask, p);
+    }
+    void store(float* p, __m512 v) const {
+        _mm512_mask_storeu_ps(p, mask, v);
+    }
+};
+
+// Load the weights and the state R uses at offset i, apply R with gradient g and store them back.
+// Returns the weights as they were.
+template <typename R, typename Lanes>
+inline __m512 updateLanes(const Lanes& lanes, float* w, float* first, float* second, size_t i, __m512 g,
+                          const StepVec& c) {
+    __m512 s1 = _mm512_setzero_ps();
+    __m512 s2 = _mm512_setzero_ps();
+    if constexpr (R::STATES >= 1)
+        s1 = lanes.load(first + i);
+    if constexpr (R::STATES >= 2)
+        s2 = lanes.load(second + i);
+    __m512 old = lanes.load(w + i);
+    lanes.store(w + i, R::apply(old, g, s1, s2, c));
+    if constexpr (R::STATES >= 1)
+        lanes.store(first + i, s1);
+    if constexpr (R::STATES >= 2)
+        lanes.store(second + i, s2);
+    return old;
+}
+
+template <typename R>
+void update(float* w, const float* g, float scale, float* first, float* second, size_t n, const OptimizerStep& step) {
+    const StepVec c(step);
+    const __m512  s = _mm512_set1_ps(scale);
+    size_t        i = 0;
+    for (; i + WIDTH <= n; i += WIDTH) {
+        FullLanes lanes;
+        updateLanes<R>(lanes, w, first, second, i, _mm512_mul_ps(s, lanes.load(g + i)), c);
+    }
+    if (i < n) {
+        TailLanes lanes{static_cast<__mmask16>((1u << (n - i)) - 1)};
+        updateLanes<R>(lanes, w, first, second, i, _mm512_mul_ps(s, lanes.load(g + i)), c);
+    }
+}
+
+template <typename R>
+void updateOuter(float* w, const float* delta, const float* x, float* next, float* first, float* second,
+                 size_t rows, size_t cols, const OptimizerStep& step) {
+    const StepVec c(step);
+    if (next)
+        std::fill_n(next, cols, 0.0f);
+    // Rows go in blocks so each slice of x and next is loaded, and next stored, once per block
+    constexpr size_t BLOCK = 4;
+    for (size_t j = 0; j < rows; j += BLOCK) {
+        const size_t block = std::min(BLOCK, rows - j);
+        auto         tile = [&](const auto& lanes, size_t k) {
+            const __m512 xk = lanes.load(x + k);
+            __m512       sum = _mm512_setzero_ps();
+            for (size_t r = 0; r < block; ++r) {
+                const __m512 d = _mm512_set1_ps(delta[j + r]);
+                __m512       old = updateLanes<R>(lanes, w, first, second, (j + r) * cols + k, _mm512_mul_ps(d, xk), c);
+                sum = _mm512_fmadd_ps(old, d, sum);
+            }
+            if (next)
+                lanes.store(next + k, _mm512_add_ps(lanes.load(next + k), sum));
+        };
+        size_t k = 0;
+        for (; k + WIDTH <= cols; k += WIDTH) {
+            tile(FullLanes{}, k);
+        }
+        if (k < cols)
+            tile(TailLanes{static_cast<__mmask16>((1u << (cols - k)) - 1)}, k);
+    }
+}
+
+template <typename R>
+constexpr OptimizerKernels optimizerKernels() {
+    return {update<R>, updateOuter<R>};
+}
+
+// The AVX2 sign trick; AVX-512 has no sign_epi8, so w is negated under the mask of negative x.
+// The tail is a masked load whose zeroed lanes add nothing.
+void gemvInt8(const int8_t* a, const int8_t* x, int32_t* out, size_t rows, size_t cols) {
+    constexpr size_t BYTES = 64;
+    const __m512i    ones = _mm512_set1_epi16(1);
+    const __m512i    zero = _mm512_setzero_si512();
+    auto             step = [&](__m512i acc, __m512i w, __m512i v) {
+        __mmask64 negative = _mm512_movepi8_mask(v);
+        __m512i   pairs = _mm512_maddubs_epi16(_mm512_abs_epi8(v), _mm512_mask_sub_epi8(w, negative, zero, w));
+        return _mm512_add_epi32(acc, _mm512_madd_epi16(pairs, ones));
+    };
+
+    size_t    body = cols / BYTES * BYTES;
+    __mmask64 tail = (cols > body) ? (~0ull >> (BYTES - (cols - body))) : 0;
+    for (size_t j = 0; j < rows; ++j) {
+        const int8_t* row = a + j * cols;
+        __m512i       acc = _mm512_setzero_si512();
+        for (size_t k = 0; k < body; k += BYTES) {
+            acc = step(acc, _mm512_loadu_si512(row + k), _mm512_loadu_si512(x + k));
+        }
+        if (tail != 0) {
+            acc = step(acc, _mm512_maskz_loadu_epi8(tail, row + body), _mm512_maskz_loadu_epi8(tail, x + body));
+        }
+        out[j] = _mm512_reduce_add_epi32(acc);
+    }
+}
+
+} // namespace
+
+namespace detail {
+extern const KernelTable AVX512_KERNELS = {
+    "avx512",
+    add,
+    subtract,
+    multiply,
+    divide,
+    gemvInt8,
+    {
+        activationKernels<Sigmoid>(),
+        activationKernels<SigmoidPoly>(),
+        activationKernels<SigmoidTable>(),
+        activationKernels<Tanh>(),
+        activationKernels<Relu>(),
+        activationKernels<LeakyRelu>(),
+    },
+    {
+        optimizerKernels<Sgd>(),
+        optimizerKernels<Momentum>(),
+        optimizerKernels<Nesterov>(),
+        optimizerKernels<RmsProp>(),
+        optimizerKernels<Adam>(),
+    },
+};
+} // namespace detail
+
+} // namespace nnlcpp
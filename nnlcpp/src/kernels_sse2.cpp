@@ -0,0 +1,377 @@
+#include "kernels.hpp"
+
+#include <algorithm>
+#include <emmintrin.h>
+
+namespace nnlcpp {
+
+namespace {
+
+constexpr size_t WIDTH = 4;
+
+// exp(x) by range reduction to x = n * ln2 + r, a degree-5 polynomial for e^r and an exponent
+// splice for 2^n (the Cephes expf scheme). Relative error is below 2 ulp over the clamped range.
+inline __m128 expVec(__m128 x) {
+    x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-88.0f)), _mm_set1_ps(88.0f));
+
+    // n = floor(x / ln2 + 0.5); SSE2 has no floor so truncate and correct negative values
+    __m128  fx = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(1.44269504088896341f)), _mm_set1_ps(0.5f));
+    __m128  truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(fx));
+    __m128  correction = _mm_and_ps(_mm_cmpgt_ps(truncated, fx), _mm_set1_ps(1.0f));
+    fx = _mm_sub_ps(truncated, correction);
+
+    // ln2 is split in two so the reduction stays exact in float
+    x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(0.693359375f)));
+    x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(-2.12194440e-4f)));
+
+    __m128 y = _mm_set1_ps(1.9875691500e-4f);
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.3981999507e-3f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(8.3334519073e-3f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(4.1665795894e-2f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.6666665459e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(5.0000001201e-1f));
+    y = _mm_add_ps(_mm_mul_ps(y, _mm_mul_ps(x, x)), _mm_add_ps(x, _mm_set1_ps(1.0f)));
+
+    __m128i exponent = _mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(fx), _mm_set1_epi32(127)), 23);
+    return _mm_mul_ps(y, _mm_castsi128_ps(exponent));
+}
+
+inline __m128 sigmoidVec(__m128 x) {
+    __m128 one = _mm_set1_ps(1.0f);
+    return _mm_div_ps(one, _mm_add_ps(one, expVec(_mm_sub_ps(_mm_setzero_ps(), x))));
+}
+
+// Runs a two-input vector operation over n elements. The tail is staged through a padded
+// buffer so every element goes through the same vector code.
+template <typename Op>
+inline void binary(const float* a, const float* b, float* out, size_t n, Op op) {
+    size_t i = 0;
+    for (; i + WIDTH <= n; i += WIDTH) {
+        _mm_storeu_ps(out + i, op(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    if (i < n) {
+        alignas(16) float ta[WIDTH] = {};
+        alignas(16) float tb[WIDTH] = {};
+        std::copy(a + i, a + n, ta);
+        std::copy(b + i, b + n, tb);
+        _mm_store_ps(ta, op(_mm_load_ps(ta), _mm_load_ps(tb)));
+        std::copy(ta, ta + (n - i), out + i);
+    }
+}
+
+void add(const float* a, const float* b, float* out, size_t n) {
+    binary(a, b, out, n, [](__m128 x, __m128 y) { return _mm_add_ps(x, y); });
+}
+
+void subtract(const float* a, const float* b, float* out, size_t n) {
+    binary(a, b, out, n, [](__m128 x, __m128 y) { return _mm_sub_ps(x, y); });
+}
+
+void multiply(const float* a, const float* b, float* out, size_t n) {
+    binary(a, b, out, n, [](__m128 x, __m128 y) { return _mm_mul_ps(x, y); });
+}
+
+void divide(const float* a, const float* b, float* out, size_t n) {
+    binary(a, b, out, n, [](__m128 x, __m128 y) {
+        __m128 nonzero = _mm_cmpneq_ps(y, _mm_setzero_ps());
+        return _mm_and_ps(nonzero, _mm_div_ps(x, y));
+    });
+}
+
+// Dot products of WIDTH rows with x, one accumulator per row, transposed and summed so lane r
+// holds row r's total. Rows past the end of the matrix point at a valid row and are discarded.
+inline __m128 dotRows(const float* const (&rows)[WIDTH], const float* x, size_t cols) {
+    __m128 a0 = _mm_setzero_ps(), a1 = _mm_setzero_ps(), a2 = _mm_setzero_ps(), a3 = _mm_setzero_ps();
+    size_t k = 0;
+    for (; k + WIDTH <= cols; k += WIDTH) {
+        __m128 v = _mm_loadu_ps(x + k);
+        a0 = _mm_add_ps(a0, _mm_mul_ps(_mm_loadu_ps(rows[0] + k), v));
+        a1 = _mm_add_ps(a1, _mm_mul_ps(_mm_loadu_ps(rows[1] + k), v));
+        a2 = _mm_add_ps(a2, _mm_mul_ps(_mm_loadu_ps(rows[2] + k), v));
+        a3 = _mm_add_ps(a3, _mm_mul_ps(_mm_loadu_ps(rows[3] + k), v));
+    }
+    _MM_TRANSPOSE4_PS(a0, a1, a2, a3);
+    __m128 sums = _mm_add_ps(_mm_add_ps(a0, a1), _mm_add_ps(a2, a3));
+    if (k < cols) {
+        alignas(16) float tail[WIDTH] = {};
+        for (size_t r = 0; r < WIDTH; ++r) {
+            for (size_t t = k; t < cols; ++t) {
+                tail[r] += rows[r][t] * x[t];
+            }
+        }
+        sums = _mm_add_ps(sums, _mm_load_ps(tail));
+    }
+    return sums;
+}
+
+// Vector activation policies mirroring activation::*. SSE2 has neither a variable permute nor a
+// gather, so the piecewise and table sigmoids would have to run lane by lane, which is slower
+// than the polynomial exp; they use the exact sigmoid here, which is well inside their bounds.
+struct Sigmoid {
+    static __m128 apply(__m128 z) {
+        return sigmoidVec(z);
+    }
+    static __m128 derivative(__m128 y) {
+        return _mm_mul_ps(y, _mm_sub_ps(_mm_set1_ps(1.0f), y));
+    }
+};
+
+// tanh(z) = 2 sigmoid(2z) - 1
+struct Tanh {
+    static __m128 apply(__m128 z) {
+        __m128 two = _mm_set1_ps(2.0f);
+        return _mm_sub_ps(_mm_mul_ps(two, sigmoidVec(_mm_mul_ps(two, z))), _mm_set1_ps(1.0f));
+    }
+    static __m128 derivative(__m128 y) {
+        return _mm_sub_ps(_mm_set1_ps(1.0f), _mm_mul_ps(y, y));
+    }
+};
+
+struct Relu {
+    static __m128 apply(__m128 z) {
+        return _mm_max_ps(z, _mm_setzero_ps());
+    }
+    static __m128 derivative(__m128 y) {
+        return _mm_and_ps(_mm_cmpgt_ps(y, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+    }
+};
+
+struct LeakyRelu {
+    static __m128 apply(__m128 z) {
+        return _mm_max_ps(z, _mm_mul_ps(z, _mm_set1_ps(activation::LEAKY_RELU_SLOPE)));
+    }
+    static __m128 derivative(__m128 y) {
+        __m128 positive = _mm_cmpgt_ps(y, _mm_setzero_ps());
+        return _mm_or_ps(_mm_and_ps(positive, _mm_set1_ps(1.0f)),
+                         _mm_andnot_ps(positive, _mm_set1_ps(activation::LEAKY_RELU_SLOPE)));
+    }
+};
+
+template <typename A>
+void activate(const float* x, float* out, size_t n) {
+    binary(x, x, out, n, [](__m128 v, __m128) { return A::apply(v); });
+}
+
+template <typename A>
+void multiplyDerivative(const float* delta, const float* y, float* out, size_t n) {
+    binary(delta, y, out, n, [](__m128 d, __m128 v) { return _mm_mul_ps(d, A::derivative(v)); });
+}
+
+template <typename A>
+void dense(const float* w, const float* x, const float* b, float* z, float* out, size_t rows, size_t cols) {
+    for (size_t j = 0; j < rows; j += WIDTH) {
+        size_t       count = std::min(WIDTH, rows - j);
+        const float* row_ptrs[WIDTH];
+        for (size_t r = 0; r < WIDTH; ++r) {
+            row_ptrs[r] = w + (j + std::min(r, count - 1)) * cols;
+        }
+        __m128 sums = dotRows(row_ptrs, x, cols);
+
+        if (count == WIDTH) {
+            sums = _mm_add_ps(sums, _mm_loadu_ps(b + j));
+            if (z != nullptr)
+                _mm_storeu_ps(z + j, sums);
+            _mm_storeu_ps(out + j, A::apply(sums));
+        } else {
+            alignas(16) float staged[WIDTH] = {};
+            std::copy(b + j, b + j + count, staged);
+            sums = _mm_add_ps(sums, _mm_load_ps(staged));
+            _mm_store_ps(staged, sums);
+            if (z != nullptr)
+                std::copy(staged, staged + count, z + j);
+            _mm_store_ps(staged, A::apply(sums));
+            std::copy(staged, staged + count, out + j);
+        }
+    }
+}
+
+template <typename A>
+constexpr ActivationKernels activationKernels() {
+    return {activate<A>, multiplyDerivative<A>, dense<A>};
+}
+
+// One optimizer step's hyperparameters, broadcast once per kernel call
+struct StepVec {
+    __m128 learning_rate;
+    __m128 first_decay;
+    __m128 second_decay;
+    __m128 first_rest;  // 1 - first_decay
+    __m128 second_rest; // 1 - second_decay
+    __m128 epsilon;
+
+    explicit StepVec(const OptimizerStep& step)
+          : learning_rate(_mm_set1_ps(step.learning_rate)),
+            first_decay(_mm_set1_ps(step.first_decay)),
+            second_decay(_mm_set1_ps(step.second_decay)),
+            first_rest(_mm_set1_ps(1.0f - step.first_decay)),
+            second_rest(_mm_set1_ps(1.0f - step.second_decay)),
+            epsilon(_mm_set1_ps(step.epsilon)) {}
+};
+
+// Vector update rules mirroring optimizer::*, which also handles the tails SSE2 cannot mask
+struct Sgd {
+    using Scalar = optimizer::Sgd;
+    static __m128 apply(__m128 w, __m128 g, __m128&, __m128&, const StepVec& c) {
+        return _mm_add_ps(w, _mm_mul_ps(c.learning_rate, g));
+    }
+};
+
+struct Momentum {
+    using Scalar = optimizer::Momentum;
+    static __m128 apply(__m128 w, __m128 g, __m128& v, __m128&, const StepVec& c) {
+        v = _mm_add_ps(_mm_mul_ps(c.first_decay, v), g);
+        return _mm_add_ps(w, _mm_mul_ps(c.learning_rate, v));
+    }
+};
+
+struct Nesterov {
+    using Scalar = optimizer::Nesterov;
+    static __m128 apply(__m128 w, __m128 g, __m128& v, __m128&, const StepVec& c) {
+        v = _mm_add_ps(_mm_mul_ps(c.first_decay, v), g);
+        return _mm_add_ps(w, _mm_mul_ps(c.learning_rate, _mm_add_ps(g, _mm_mul_ps(c.first_decay, v))));
+    }
+};
+
+struct RmsProp {
+    using Scalar = optimizer::RmsProp;
+    static __m128 apply(__m128 w, __m128 g, __m128& s, __m128&, const StepVec& c) {
+        s = _mm_add_ps(_mm_mul_ps(c.second_decay, s), _mm_mul_ps(c.second_rest, _mm_mul_ps(g, g)));
+        return _mm_add_ps(w, _mm_mul_ps(c.learning_rate, _mm_div_ps(g, _mm_add_ps(_mm_sqrt_ps(s), c.epsilon))));
+    }
+};
+
+struct Adam {
+    using Scalar = optimizer::Adam;
+    static __m128 apply(__m128 w, __m128 g, __m128& m, __m128& v, const StepVec& c) {
+        m = _mm_add_ps(_mm_mul_ps(c.first_decay, m), _mm_mul_ps(c.first_rest, g));
+        v = _mm_add_ps(_mm_mul_ps(c.second_decay, v), _mm_mul_ps(c.second_rest, _mm_mul_ps(g, g)));
+        return _mm_add_ps(w, _mm_mul_ps(c.learning_rate, _mm_div_ps(m, _mm_add_ps(_mm_sqrt_ps(v), c.epsilon))));
+    }
+};
+
+// Load the weights and the state R uses at offset i, apply R with gradient g and store them back.
+// Returns the weights as they were.
+template <typename R>
+inline __m128 updateLanes(float* w, float* first, float* second, size_t i, __m128 g, const StepVec& c) {
+    constexpr int STATES = R::Scalar::STATES;
+    __m128        s1 = _mm_setzero_ps();
+    __m128        s2 = _mm_setzero_ps();
+    if constexpr (STATES >= 1)
+        s1 = _mm_loadu_ps(first + i);
+    if constexpr (STATES >= 2)
+        s2 = _mm_loadu_ps(second + i);
+    __m128 old = _mm_loadu_ps(w + i);
+    _mm_storeu_ps(w + i, R::apply(old, g, s1, s2, c));
+    if constexpr (STATES >= 1)
+        _mm_storeu_ps(first + i, s1);
+    if constexpr (STATES >= 2)
+        _mm_storeu_ps(second + i, s2);
+    return old;
+}
+
+template <typename R>
+void update(float* w, const float* g, float scale, float* first, float* second, size_t n, const OptimizerStep& step) {
+    const StepVec c(step);
+    const __m128  s = _mm_set1_ps(scale);
+    size_t        i = 0;
+    for (; i + WIDTH <= n; i += WIDTH) {
+        updateLanes<R>(w, first, second, i, _mm_mul_ps(s, _mm_loadu_ps(g + i)), c);
+    }
+    for (; i < n; ++i) {
+        optimizer::applyAt<typename R::Scalar>(w, first, second, i, scale * g[i], step);
+    }
+}
+
+template <typename R>
+void updateOuter(float* w, const float* delta, const float* x, float* next, float* first, float* second,
+                 size_t rows, size_t cols, const OptimizerStep& step) {
+    const StepVec c(step);
+    if (next)
+        std::fill_n(next, cols, 0.0f);
+    for (size_t j = 0; j < rows; ++j) {
+        const __m128 d = _mm_set1_ps(delta[j]);
+        const size_t row = j * cols;
+        size_t       k = 0;
+        for (; k + WIDTH <= cols; k += WIDTH) {
+            __m128 old = updateLanes<R>(w, first, second, row + k, _mm_mul_ps(d, _mm_loadu_ps(x + k)), c);
+            if (next)
+                _mm_storeu_ps(next + k, _mm_add_ps(_mm_loadu_ps(next + k), _mm_mul_ps(old, d)));
+        }
+        for (; k < cols; ++k) {
+            if (next)
+                next[k] += w[row + k] * delta[j];
+            optimizer::applyAt<typename R::Scalar>(w, first, second, row + k, delta[j] * x[k], step);
+        }
+    }
+}
+
+template <typename R>
+constexpr OptimizerKernels optimizerKernels() {
+    return {update<R>, updateOuter<R>};
+}
+
+// Sign-extend the low and high eight bytes of v to int16. SSE2 has no pmovsx, so each byte is
+// duplicated into a word and shifted back down arithmetically.
+inline __m128i widenLow(__m128i v) {
+    return _mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8);
+}
+
+inline __m128i widenHigh(__m128i v) {
+    return _mm_srai_epi16(_mm_unpackhi_epi8(v, v), 8);
+}
+
+inline int32_t horizontalSum(__m128i v) {
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(v);
+}
+
+void gemvInt8(const int8_t* a, const int8_t* x, int32_t* out, size_t rows, size_t cols) {
+    constexpr size_t BYTES = 16;
+    for (size_t j = 0; j < rows; ++j) {
+        const int8_t* row = a + j * cols;
+        __m128i       acc = _mm_setzero_si128();
+        size_t        k = 0;
+        for (; k + BYTES <= cols; k += BYTES) {
+            __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + k));
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(x + k));
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(widenLow(w), widenLow(v)));
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(widenHigh(w), widenHigh(v)));
+        }
+        int32_t sum = horizontalSum(acc);
+        for (; k < cols; ++k) {
+            sum += static_cast<int32_t>(row[k]) * x[k];
+        }
+        out[j] = sum;
+    }
+}
+
+} // namespace
+
+namespace detail {
+extern const KernelTable SSE2_KERNELS = {
+    "sse2",
+    add,
+    subtract,
+    multiply,
+    divide,
+    gemvInt8,
+    {
+        activationKernels<Sigmoid>(),
+        activationKernels<Sigmoid>(),
+        activationKernels<Sigmoid>(),
+        activationKernels<Tanh>(),
+        activationKernels<Relu>(),
+        activationKernels<LeakyRelu>(),
+    },
+    {
+        optimizerKernels<Sgd>(),
+        optimizerKernels<Momentum>(),
+        optimizerKernels<Nesterov>(),
+        optimizerKernels<RmsProp>(),
+        optimizerKernels<Adam>(),
+    },
+};
+} // namespace detail
+
+} // namespace nnlcpp
@@ -1,26 +1,66 @@
 #include "layer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdio.h>
+
 namespace nnlcpp {
 
-Layer::Layer(uint32_t rows, uint32_t cols, bool randomize)
-      : m_weights(rows * cols),
-        m_biases(rows),
+Layer::Layer(uint32_t rows, uint32_t cols, float* weights, float* biases, Activation activation)
+      : m_weights(weights),
+        m_biases(biases),
         m_rows(rows),
-        m_cols(cols) {
-    if (!randomize)
-        return;
+        m_cols(cols),
+        m_activation(activation) {}
 
+namespace {
+
+// Fill a layer's parameters from draw(), which returns uniform values in [-1, 1]
+template <typename Draw>
+void fillRandom(std::span<float> weights, std::span<float> biases, uint32_t cols, Draw&& draw) {
     // Xavier/Glorot initialization - scale weights by sqrt(1/n) where n is number of inputs
     float scale = std::sqrt(2.0f / static_cast<float>(cols));
 
-    for (auto& weight : m_weights) {
+    for (auto& weight : weights) {
         // Generate weights between -scale and +scale for better training
-        weight = scale * (2.0f * static_cast<float>(std::rand()) / static_cast<float>(RAND_MAX) - 1.0f);
+        weight = scale * draw();
     }
 
     // Initialize biases to small values close to zero
-    for (auto& bias : m_biases) {
-        bias = 0.01f * (2.0f * static_cast<float>(std::rand()) / static_cast<float>(RAND_MAX) - 1.0f);
+    for (auto& bias : biases) {
+        bias = 0.01f * draw();
+    }
+}
+
+} // namespace
+
+void Layer::randomize() {
+    fillRandom(weights(), biases(), m_cols, [] {
+        return 2.0f * static_cast<float>(std::rand()) / static_cast<float>(RAND_MAX) - 1.0f;
+    });
+}
+
+void Layer::randomize(std::mt19937& rng) {
+    std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+    fillRandom(weights(), biases(), m_cols, [&] { return uniform(rng); });
+}
+
+bool Layer::setWeights(std::span<const float> weights) {
+    if (weights.size() != static_cast<size_t>(m_rows) * m_cols) {
+        printf("Error: setWeights expects %u values but got %zu.\n", m_rows * m_cols, weights.size());
+        return false;
+    }
+    std::copy(weights.begin(), weights.end(), m_weights);
+    return true;
+}
+
+bool Layer::setBiases(std::span<const float> biases) {
+    if (biases.size() != m_rows) {
+        printf("Error: setBiases expects %u values but got %zu.\n", m_rows, biases.size());
+        return false;
     }
+    std::copy(biases.begin(), biases.end(), m_biases);
+    return true;
 }
 
 } // namespace nnlcpp
\ No newline at end of file
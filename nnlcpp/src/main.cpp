@@ -1,20 +1,66 @@
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <cmath>
+#include <csignal>
 #include <cstdint>
 #include <cstring>  // for strrchr
 #include <iostream>
+#include <memory>
+#include <numeric>
+#include <optional>
 #include <random>
+#include <span>
+#include <thread>
+#include <unistd.h>
 #include <utility> // for std::pair
 #include <vector>
 
+#include "batchloader.hpp"
+#include "checkpoint.hpp"
+#include "dataset.hpp"
+#include "distributedtrainer.hpp"
+#include "earlystopping.hpp"
+#include "inferenceserver.hpp"
+#include "kernels.hpp"
+#include "modelfile.hpp"
 #include "neuralnetwork.hpp"
+#include "paralleltrainer.hpp"
+#include "profiler.hpp"
+#include "quantizednetwork.hpp"
+#include "sparsenetwork.hpp"
+#include "sweep.hpp"
+#include "transport.hpp"
 
 // This is a simple neural network implementation in C++ based in first principles.
 const std::vector<std::pair<std::vector<float>, std::vector<float>>> TRAINING_DATA = {
     {{0, 0}, {0}}, {{0, 1}, {1}}, {{1, 0}, {1}}, {{1, 1}, {0}}};
 
-void train(nnlcpp::NeuralNetwork& nn, uint32_t iterations) {
-    const int display_interval = 1000;
+// Loss and accuracy of the network over the whole XOR table
+nnlcpp::LossTally measure(const nnlcpp::NeuralNetwork& nn, nnlcpp::Workspace& workspace) {
+    nnlcpp::LossTally  tally;
+    std::vector<float> output(TRAINING_DATA[0].second.size());
+    for (const auto& entry : TRAINING_DATA) {
+        if (nn.predict(entry.first, output, workspace))
+            tally.add(output.data(), entry.second.data(), output.size());
+    }
+    return tally;
+}
+
+// With early stopping, score the network after an iteration over the XOR table; true to stop
+bool converged(const nnlcpp::NeuralNetwork& nn, nnlcpp::EarlyStopping* stopping, nnlcpp::Workspace& workspace) {
+    if (!stopping)
+        return false;
+    nnlcpp::LossTally tally = measure(nn, workspace);
+    return stopping->update(tally.loss(), tally.accuracy());
+}
+
+void train(nnlcpp::NeuralNetwork& nn, uint32_t iterations, nnlcpp::EarlyStopping* stopping = nullptr,
+           nnlcpp::Checkpointer* checkpointer = nullptr) {
+    const int         display_interval = 1000;
+    nnlcpp::Workspace workspace(nn.getLayers());
 
     for (uint32_t i = 0; i < iterations; ++i) {
         // Train on each example in the training set
@@ -28,6 +74,63 @@ void train(nnlcpp::NeuralNetwork& nn, uint32_t iterations) {
                 return;
             }
         }
+        if (checkpointer) {
+            checkpointer->epochDone(nn);
+        }
+        if (converged(nn, stopping, workspace)) {
+            printf("\rTraining stopped after %u iterations      \n", i + 1);
+            return;
+        }
+
+        // Display progress periodically
+        if (i % display_interval == 0) {
+            printf("\rTraining progress: %6.2f%% complete", 100.0f * i / iterations);
+            fflush(stdout);
+        }
+    }
+    printf("\rTraining progress: 100.00%% complete\n");
+}
+
+void trainBatched(nnlcpp::NeuralNetwork& nn, uint32_t iterations, uint32_t batch_size,
+                  nnlcpp::ParallelTrainer* trainer = nullptr, nnlcpp::EarlyStopping* stopping = nullptr,
+                  nnlcpp::Checkpointer* checkpointer = nullptr) {
+    const int         display_interval = 1000;
+    const size_t      input_size = TRAINING_DATA[0].first.size();
+    const size_t      output_size = TRAINING_DATA[0].second.size();
+    nnlcpp::Workspace workspace(nn.getLayers());
+
+    // Flatten the training set once, one sample per row, so each batch is a contiguous slice
+    std::vector<float> inputs;
+    std::vector<float> outputs;
+    for (const auto& entry : TRAINING_DATA) {
+        inputs.insert(inputs.end(), entry.first.begin(), entry.first.end());
+        outputs.insert(outputs.end(), entry.second.begin(), entry.second.end());
+    }
+
+    std::vector<float> batch_inputs;
+    std::vector<float> batch_outputs;
+    for (uint32_t i = 0; i < iterations; ++i) {
+        // Walk the training set in batches; the last one is short if the sizes don't divide
+        for (size_t start = 0; start < TRAINING_DATA.size(); start += batch_size) {
+            uint32_t count = static_cast<uint32_t>(std::min<size_t>(batch_size, TRAINING_DATA.size() - start));
+            batch_inputs.assign(inputs.begin() + start * input_size, inputs.begin() + (start + count) * input_size);
+            batch_outputs.assign(outputs.begin() + start * output_size,
+                                 outputs.begin() + (start + count) * output_size);
+
+            bool ok = trainer ? trainer->trainBatch(batch_inputs, batch_outputs, count)
+                              : nn.trainBatch(batch_inputs, batch_outputs, count);
+            if (!ok) {
+                printf("Error: Training failed for batch starting at sample %zu.\n", start);
+                return;
+            }
+        }
+        if (checkpointer) {
+            checkpointer->epochDone(nn);
+        }
+        if (converged(nn, stopping, workspace)) {
+            printf("\rTraining stopped after %u iterations      \n", i + 1);
+            return;
+        }
 
         // Display progress periodically
         if (i % display_interval == 0) {
@@ -38,6 +141,369 @@ void train(nnlcpp::NeuralNetwork& nn, uint32_t iterations) {
     printf("\rTraining progress: 100.00%% complete\n");
 }
 
+// Train for the given number of epochs on batches streamed from a dataset by a background
+// loader, then report loader throughput and how long the trainer sat waiting for data. With early
+// stopping, each batch is scored just before it is trained on and the epoch's running loss is
+// what decides; the loader owns the dataset, so there is no separate evaluation pass.
+bool trainStreamed(nnlcpp::NeuralNetwork& nn, nnlcpp::Dataset& dataset, uint32_t epochs, uint32_t batch_size,
+                   size_t shuffle_window, nnlcpp::ParallelTrainer* trainer = nullptr,
+                   nnlcpp::EarlyStopping* stopping = nullptr, nnlcpp::Checkpointer* checkpointer = nullptr) {
+    nnlcpp::BatchLoader loader(dataset, batch_size, shuffle_window, 4, static_cast<uint64_t>(std::rand()));
+    nnlcpp::Workspace   workspace(nn.getLayers(), batch_size);
+    std::vector<float>  batch_inputs;
+    std::vector<float>  batch_outputs;
+    std::vector<float>  predictions(stopping ? static_cast<size_t>(batch_size) * dataset.getOutputSize() : 0);
+    nnlcpp::LossTally   tally;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (uint32_t epoch = 0; epoch < epochs;) {
+        const nnlcpp::BatchLoader::Batch& batch = loader.next();
+        if (batch.size == 0) {
+            printf("Error: The dataset contains no samples.\n");
+            return false;
+        }
+
+        if (stopping) {
+            if (!nn.predictBatch(batch.inputs.data(), batch.size, predictions.data(), workspace))
+                return false;
+            tally.add(predictions.data(), batch.outputs.data(), batch.size * dataset.getOutputSize());
+        }
+
+        bool ok;
+        if (trainer) {
+            batch_inputs.assign(batch.inputs.begin(), batch.inputs.begin() + batch.size * dataset.getInputSize());
+            batch_outputs.assign(batch.outputs.begin(),
+                                 batch.outputs.begin() + batch.size * dataset.getOutputSize());
+            ok = trainer->trainBatch(batch_inputs, batch_outputs, batch.size);
+        } else {
+            ok = nn.trainBatch(batch.inputs.data(), batch.outputs.data(), batch.size, workspace);
+        }
+        if (!ok) {
+            printf("Error: Training failed in epoch %u.\n", epoch);
+            return false;
+        }
+
+        if (batch.last_in_epoch) {
+            ++epoch;
+            if (checkpointer) {
+                checkpointer->epochDone(nn);
+            }
+            printf("\rTraining progress: %6.2f%% complete", 100.0f * epoch / epochs);
+            fflush(stdout);
+            if (stopping && stopping->update(tally.loss(), tally.accuracy())) {
+                printf("\rTraining stopped after %u epochs      ", epoch);
+                break;
+            }
+            tally = {};
+        }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+    printf("\n");
+
+    nnlcpp::BatchLoader::Stats stats = loader.getStats();
+    printf("Loader: %llu samples, %.1f MB read, %.0f samples/s and %.1f MB/s while loading\n",
+           static_cast<unsigned long long>(stats.samples), stats.bytes / 1e6,
+           stats.load_seconds > 0 ? stats.samples / stats.load_seconds : 0.0,
+           stats.load_seconds > 0 ? stats.bytes / 1e6 / stats.load_seconds : 0.0);
+    printf("Trainer stalled %.3f s waiting for batches (%.1f%% of %.3f s, %llu stalls)\n", stats.stall_seconds,
+           100.0 * stats.stall_seconds / elapsed.count(), elapsed.count(),
+           static_cast<unsigned long long>(stats.stalls));
+    return true;
+}
+
+// Train in ranks processes, this one and ranks - 1 forked from it, each a replica of nn training
+// on its own contiguous shard of the data, reshuffled every epoch. A step takes up to batch_size
+// samples from every shard and sums the gradients over the ring, so the global batch is ranks x
+// batch_size. Rank 0 keeps the trained network and reports throughput and how much of the
+// all-reduce the backward pass hid; the other ranks exit once training ends.
+bool trainDistributed(nnlcpp::NeuralNetwork& nn, const nnlcpp::SweepData& data, uint32_t ranks,
+                      nnlcpp::TransportKind transport_kind, uint32_t epochs, uint32_t batch_size) {
+    const size_t input_size = data.input_size;
+    const size_t output_size = data.output_size;
+    auto         shardBegin = [&](uint32_t rank) { return rank * data.samples / ranks; };
+    auto         shardSize = [&](uint32_t rank) { return shardBegin(rank + 1) - shardBegin(rank); };
+    // Samples a rank trains on in a step. Shards differ by at most one sample, and every rank runs
+    // as many steps as the largest needs, so a rank may have a short or empty last step.
+    auto         stepSize = [&](uint32_t rank, size_t step) {
+        size_t taken = std::min(shardSize(rank), step * batch_size);
+        return static_cast<uint32_t>(std::min<size_t>(batch_size, shardSize(rank) - taken));
+    };
+    if (data.samples == 0) {
+        printf("Error: The dataset contains no samples.\n");
+        return false;
+    }
+    if (batch_size == 0) {
+        printf("Error: Distributed training needs a batch size of at least 1.\n");
+        return false;
+    }
+    const size_t steps = ((data.samples + ranks - 1) / ranks + batch_size - 1) / batch_size;
+
+    return nnlcpp::LocalCluster::run(ranks, transport_kind, [&](nnlcpp::Transport& transport) {
+        const uint32_t             rank = transport.getRank();
+        nnlcpp::DistributedTrainer trainer(nn, transport, batch_size);
+        std::vector<size_t>        order(shardSize(rank));
+        std::iota(order.begin(), order.end(), shardBegin(rank));
+        std::mt19937_64    rng(static_cast<uint64_t>(std::rand()) + rank);
+        std::vector<float> batch_inputs(static_cast<size_t>(batch_size) * input_size);
+        std::vector<float> batch_outputs(static_cast<size_t>(batch_size) * output_size);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (uint32_t epoch = 0; epoch < epochs; ++epoch) {
+            std::shuffle(order.begin(), order.end(), rng);
+            for (size_t step = 0; step < steps; ++step) {
+                uint32_t count = stepSize(rank, step);
+                uint32_t global_count = 0;
+                for (uint32_t r = 0; r < ranks; ++r) {
+                    global_count += stepSize(r, step);
+                }
+                for (uint32_t n = 0; n < count; ++n) {
+                    size_t sample = order[step * batch_size + n];
+                    std::copy_n(&data.inputs[sample * input_size], input_size, &batch_inputs[n * input_size]);
+                    std::copy_n(&data.outputs[sample * output_size], output_size, &batch_outputs[n * output_size]);
+                }
+                if (!trainer.trainBatch(batch_inputs.data(), batch_outputs.data(), count, global_count)) {
+                    printf("Error: Rank %u failed in epoch %u.\n", rank, epoch);
+                    return false;
+                }
+            }
+            if (rank == 0) {
+                printf("\rTraining progress: %6.2f%% complete", 100.0f * (epoch + 1) / epochs);
+                fflush(stdout);
+            }
+        }
+        std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+        // Every rank's times summed over the ring, reported as means per rank
+        const nnlcpp::DistributedTrainer::Stats stats = trainer.getStats();
+        std::array<float, 6> totals = {
+            static_cast<float>(stats.compute_seconds), static_cast<float>(stats.communication_seconds),
+            static_cast<float>(stats.synchronization_seconds), static_cast<float>(stats.exposed_seconds),
+            static_cast<float>(stats.stall_seconds), static_cast<float>(elapsed.count())};
+        if (!trainer.sumAcrossRanks(totals))
+            return false;
+        if (rank != 0)
+            return true;
+
+        double samples = static_cast<double>(epochs) * static_cast<double>(data.samples);
+        printf("\nDistributed: %u ranks over %s, %.0f samples in %.3f s (%.0f samples/s, %.0f per rank)\n", ranks,
+               nnlcpp::transportName(transport_kind), samples, elapsed.count(), samples / elapsed.count(),
+               samples / elapsed.count() / ranks);
+        float transfer = totals[1] - totals[2];
+        auto  ofTraining = [&](float seconds) { return totals[5] > 0 ? 100.0 * seconds / totals[5] : 0.0; };
+        printf("All-reduce: %.1f KB sent per rank and step, %llu steps; per rank %.3f s computing, %.3f s "
+               "communicating (%.3f s transferring, %.3f s waiting for neighbours to reach the same layer)\n",
+               stats.steps ? stats.bytes_sent / 1e3 / static_cast<double>(stats.steps) : 0.0,
+               static_cast<unsigned long long>(stats.steps), totals[0] / ranks, totals[1] / ranks,
+               transfer / ranks, totals[2] / ranks);
+        printf("After the backward pass, per rank: %.3f s of transfers it did not hide (%.1f%% of training, "
+               "%.1f%% of transfer time hidden), %.3f s waiting for slower ranks (%.1f%% of training)\n",
+               totals[3] / ranks, ofTraining(totals[3]), transfer > 0 ? 100.0 * (1.0 - totals[3] / transfer) : 0.0,
+               totals[4] / ranks, ofTraining(totals[4]));
+        return true;
+    });
+}
+
+// Report mean squared error and thresholded accuracy over every sample of a dataset
+void evaluate(const nnlcpp::NeuralNetwork& nn, nnlcpp::Dataset& dataset) {
+    const size_t       block = 1024;
+    const size_t       input_size = dataset.getInputSize();
+    const size_t       output_size = dataset.getOutputSize();
+    std::vector<float> inputs(block * input_size);
+    std::vector<float> expected(block * output_size);
+    std::vector<float> outputs(block * output_size);
+    nnlcpp::Workspace  workspace(nn.getLayers(), block);
+
+    nnlcpp::LossTally tally;
+    size_t            count;
+    dataset.rewind();
+    while ((count = dataset.read(inputs.data(), expected.data(), block)) > 0) {
+        if (!nn.predictBatch(inputs.data(), static_cast<uint32_t>(count), outputs.data(), workspace))
+            return;
+        tally.add(outputs.data(), expected.data(), count * output_size);
+    }
+
+    printf("Evaluated %llu samples: MSE %.6f, %llu of %llu outputs correct (%.2f%%)\n",
+           static_cast<unsigned long long>(tally.outputs / output_size), tally.loss(),
+           static_cast<unsigned long long>(tally.correct), static_cast<unsigned long long>(tally.outputs),
+           100.0 * tally.accuracy());
+}
+
+// Train on a synthetic dataset shaped by the topology with 1..max_threads threads and report
+// throughput and parallel efficiency relative to the single-threaded run.
+void reportScaling(const std::vector<uint32_t>& layers, const std::vector<nnlcpp::Activation>& activations,
+                   float learning_rate, uint32_t max_threads, uint32_t batch_size,
+                   nnlcpp::ParallelTrainer::Mode mode) {
+    const uint32_t samples = batch_size * 32;
+    const size_t   input_size = layers.front();
+    const size_t   output_size = layers.back();
+
+    std::vector<float> inputs(samples * input_size);
+    std::vector<float> outputs(samples * output_size);
+    for (auto& value : inputs) {
+        value = static_cast<float>(std::rand()) / static_cast<float>(RAND_MAX);
+    }
+    for (auto& value : outputs) {
+        value = (std::rand() % 2) ? 1.0f : 0.0f;
+    }
+
+    printf("\nScaling report (%s, batch size %u, %u samples per run):\n",
+           mode == nnlcpp::ParallelTrainer::Mode::Hogwild ? "hogwild" : "synchronous", batch_size, samples);
+    printf("%8s %16s %10s %12s\n", "Threads", "Samples/sec", "Speedup", "Efficiency");
+
+    double baseline = 0.0;
+    for (uint32_t threads = 1; threads <= max_threads; ++threads) {
+        nnlcpp::NeuralNetwork nn(layers, learning_rate);
+        nn.setActivations(activations);
+        nnlcpp::ParallelTrainer trainer(nn, threads, mode);
+
+        std::vector<float> batch_inputs;
+        std::vector<float> batch_outputs;
+        auto               run = [&] {
+            for (uint32_t start = 0; start < samples; start += batch_size) {
+                batch_inputs.assign(inputs.begin() + start * input_size,
+                                    inputs.begin() + (start + batch_size) * input_size);
+                batch_outputs.assign(outputs.begin() + start * output_size,
+                                     outputs.begin() + (start + batch_size) * output_size);
+                trainer.trainBatch(batch_inputs, batch_outputs, batch_size);
+            }
+        };
+
+        run(); // Warm-up sizes the workspaces and wakes the workers
+        auto start = std::chrono::high_resolution_clock::now();
+        run();
+        std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+        double rate = samples / elapsed.count();
+        if (threads == 1)
+            baseline = rate;
+        double speedup = rate / baseline;
+        printf("%8u %16.0f %9.2fx %11.1f%%\n", threads, rate, speedup, 100.0 * speedup / threads);
+    }
+}
+
+// Train on synthetic data in 1..max_ranks processes, every rank taking batch_size samples per
+// step, and report throughput, efficiency against one rank, and the shares of time ranks spent
+// on all-reduce transfers the backward pass could not hide and waiting for slower ranks.
+void reportRankScaling(const std::vector<uint32_t>& layers, const std::vector<nnlcpp::Activation>& activations,
+                       float learning_rate, uint32_t max_ranks, uint32_t batch_size,
+                       nnlcpp::TransportKind transport_kind) {
+    const uint32_t samples = batch_size * 32; // Per rank and run
+    const size_t   input_size = layers.front();
+    const size_t   output_size = layers.back();
+
+    std::vector<float> inputs(samples * input_size);
+    std::vector<float> outputs(samples * output_size);
+    for (auto& value : inputs) {
+        value = static_cast<float>(std::rand()) / static_cast<float>(RAND_MAX);
+    }
+    for (auto& value : outputs) {
+        value = (std::rand() % 2) ? 1.0f : 0.0f;
+    }
+
+    printf("\nRank scaling (%s, batch size %u per rank, %u samples per rank and run):\n",
+           nnlcpp::transportName(transport_kind), batch_size, samples);
+    printf("%8s %16s %10s %12s %10s %12s\n", "Ranks", "Samples/sec", "Speedup", "Efficiency", "Unhidden",
+           "Rank waits");
+
+    double baseline = 0.0;
+    for (uint32_t ranks = 1; ranks <= max_ranks; ++ranks) {
+        nnlcpp::NeuralNetwork nn(layers, learning_rate);
+        nn.setActivations(activations);
+
+        double rate = 0.0;
+        double exposed = 0.0;
+        double stalled = 0.0;
+        bool   ok = nnlcpp::LocalCluster::run(ranks, transport_kind, [&](nnlcpp::Transport& transport) {
+            nnlcpp::DistributedTrainer trainer(nn, transport, batch_size);
+            auto                       run = [&] {
+                for (uint32_t start = 0; start < samples; start += batch_size) {
+                    if (!trainer.trainBatch(&inputs[start * input_size], &outputs[start * output_size], batch_size,
+                                            batch_size * ranks))
+                        return false;
+                }
+                return true;
+            };
+
+            if (!run()) // Warm-up sizes the buffers and starts every rank together
+                return false;
+            nnlcpp::DistributedTrainer::Stats before = trainer.getStats();
+            auto                              start = std::chrono::high_resolution_clock::now();
+            if (!run())
+                return false;
+            std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+            const nnlcpp::DistributedTrainer::Stats& after = trainer.getStats();
+            std::array<float, 2>                     share = {
+                static_cast<float>((after.exposed_seconds - before.exposed_seconds) / elapsed.count()),
+                static_cast<float>((after.stall_seconds - before.stall_seconds) / elapsed.count())};
+            if (!trainer.sumAcrossRanks(share))
+                return false;
+            if (transport.getRank() == 0) {
+                rate = static_cast<double>(ranks) * samples / elapsed.count();
+                exposed = share[0] / ranks;
+                stalled = share[1] / ranks;
+            }
+            return true;
+        });
+        if (!ok)
+            return;
+
+        if (ranks == 1)
+            baseline = rate;
+        double speedup = rate / baseline;
+        printf("%8u %16.0f %9.2fx %11.1f%% %9.1f%% %11.1f%%\n", ranks, rate, speedup, 100.0 * speedup / ranks,
+               100.0 * exposed, 100.0 * stalled);
+    }
+}
+
+// Hammer the const inference path from 1..max_threads concurrent callers, each with its own
+// workspace, checking every result against a single-threaded reference.
+void reportInferenceScaling(const nnlcpp::NeuralNetwork& nn, uint32_t max_threads) {
+    const size_t   input_size = nn.getLayers().front().getCols();
+    const size_t   output_size = nn.getLayers().back().getRows();
+    const uint32_t calls_per_thread = 20000;
+
+    std::vector<float> input(input_size);
+    for (auto& value : input) {
+        value = static_cast<float>(std::rand()) / static_cast<float>(RAND_MAX);
+    }
+    std::vector<float> reference = nn.predict(input);
+
+    printf("\nConcurrent inference (%u predict calls per thread):\n", calls_per_thread);
+    printf("%8s %16s %10s %12s\n", "Threads", "Predictions/sec", "Speedup", "Efficiency");
+
+    double baseline = 0.0;
+    for (uint32_t threads = 1; threads <= max_threads; ++threads) {
+        std::atomic<uint32_t>    mismatches{0};
+        std::vector<std::thread> callers;
+        auto                     start = std::chrono::high_resolution_clock::now();
+        for (uint32_t t = 0; t < threads; ++t) {
+            callers.emplace_back([&] {
+                nnlcpp::Workspace  workspace(nn.getLayers());
+                std::vector<float> output(output_size);
+                for (uint32_t call = 0; call < calls_per_thread; ++call) {
+                    if (!nn.predict(input, output, workspace) || output != reference)
+                        mismatches.fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+        }
+        for (auto& caller : callers) {
+            caller.join();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+        double rate = static_cast<double>(threads) * calls_per_thread / elapsed.count();
+        if (threads == 1)
+            baseline = rate;
+        double speedup = rate / baseline;
+        printf("%8u %16.0f %9.2fx %11.1f%%", threads, rate, speedup, 100.0 * speedup / threads);
+        if (mismatches.load() != 0) {
+            printf("  %u results differed from the reference!", mismatches.load());
+        }
+        printf("\n");
+    }
+}
+
 void predict(const nnlcpp::NeuralNetwork& nn) {
     uint32_t pass = 0;
     for (auto& test_case : TRAINING_DATA) {
@@ -70,6 +536,272 @@ void predict(const nnlcpp::NeuralNetwork& nn) {
     printf("Predicted %u out of %zu cases correctly.\n", pass, TRAINING_DATA.size()* TRAINING_DATA[0].second.size());
 }
 
+// Quantize the trained network to int8 and run it side by side with float inference on the XOR
+// table or the dataset: parameter memory, how far the outputs drift, and whether the thresholded
+// predictions still agree with float and with the expected outputs.
+void reportQuantization(const nnlcpp::NeuralNetwork& nn, nnlcpp::Dataset* dataset) {
+    nnlcpp::QuantizedNetwork          quantized = nnlcpp::QuantizedNetwork::quantize(nn);
+    nnlcpp::QuantizedNetwork::Scratch scratch = quantized.makeScratch();
+    nnlcpp::Workspace                 workspace(nn.getLayers());
+    std::vector<uint32_t>             topology = nn.getTopology();
+    std::vector<float>                float_output(topology.back());
+    std::vector<float>                int8_output(topology.back());
+
+    double   max_difference = 0.0;
+    double   total_difference = 0.0;
+    uint64_t outputs = 0;
+    uint64_t agree = 0;
+    uint64_t float_correct = 0;
+    uint64_t int8_correct = 0;
+    auto     compare = [&](std::span<const float> input, std::span<const float> expected) {
+        if (!nn.predict(input, float_output, workspace) || !quantized.predict(input, int8_output, scratch))
+            return false;
+        for (size_t i = 0; i < expected.size(); ++i) {
+            double difference = std::fabs(int8_output[i] - float_output[i]);
+            max_difference = std::max(max_difference, difference);
+            total_difference += difference;
+            agree += (int8_output[i] >= 0.5f) == (float_output[i] >= 0.5f);
+            float_correct += (float_output[i] >= 0.5f) == (expected[i] >= 0.5f);
+            int8_correct += (int8_output[i] >= 0.5f) == (expected[i] >= 0.5f);
+        }
+        outputs += expected.size();
+        return true;
+    };
+
+    if (dataset) {
+        const size_t       block = 1024;
+        const size_t       input_size = dataset->getInputSize();
+        const size_t       output_size = dataset->getOutputSize();
+        std::vector<float> inputs(block * input_size);
+        std::vector<float> expected(block * output_size);
+        size_t             count;
+        dataset->rewind();
+        while ((count = dataset->read(inputs.data(), expected.data(), block)) > 0) {
+            for (size_t n = 0; n < count; ++n) {
+                if (!compare({inputs.data() + n * input_size, input_size},
+                             {expected.data() + n * output_size, output_size}))
+                    return;
+            }
+        }
+    } else {
+        for (auto& test_case : TRAINING_DATA) {
+            if (!compare(test_case.first, test_case.second))
+                return;
+        }
+    }
+
+    size_t float_bytes = nnlcpp::QuantizedNetwork::floatBytesFor(topology);
+    size_t int8_bytes = quantized.getBytes();
+    printf("\nInt8 quantization (%s kernels):\n", nnlcpp::Kernels::active().name);
+    // Per-row scales and float biases can outweigh the int8 saving on tiny layers
+    double shrink = static_cast<double>(float_bytes) / static_cast<double>(int8_bytes);
+    printf("Parameters: %zu bytes as float, %zu bytes as int8 (%.2fx %s)\n", float_bytes, int8_bytes,
+           shrink >= 1.0 ? shrink : 1.0 / shrink, shrink >= 1.0 ? "smaller" : "larger");
+    printf("Output drift: max %.6f, mean %.6f\n", max_difference, outputs ? total_difference / outputs : 0.0);
+    printf("Thresholded outputs: %llu of %llu agree with float; correct %llu float, %llu int8\n",
+           static_cast<unsigned long long>(agree), static_cast<unsigned long long>(outputs),
+           static_cast<unsigned long long>(float_correct), static_cast<unsigned long long>(int8_correct));
+}
+
+// The whole dataset, or the XOR table without one, in memory one sample per row
+nnlcpp::SweepData loadAll(nnlcpp::Dataset* dataset) {
+    if (dataset)
+        return nnlcpp::SweepData::load(*dataset);
+
+    nnlcpp::SweepData data;
+    data.input_size = static_cast<uint32_t>(TRAINING_DATA[0].first.size());
+    data.output_size = static_cast<uint32_t>(TRAINING_DATA[0].second.size());
+    for (const auto& entry : TRAINING_DATA) {
+        data.inputs.insert(data.inputs.end(), entry.first.begin(), entry.first.end());
+        data.outputs.insert(data.outputs.end(), entry.second.begin(), entry.second.end());
+        ++data.samples;
+    }
+    return data;
+}
+
+// Loss and accuracy over every sample, predicted in blocks by either network
+template <typename Predict>
+nnlcpp::LossTally measureAll(const nnlcpp::SweepData& data, uint32_t block, Predict&& predictBatch) {
+    std::vector<float> outputs(static_cast<size_t>(block) * data.output_size);
+    nnlcpp::LossTally  tally;
+    for (size_t start = 0; start < data.samples; start += block) {
+        uint32_t count = static_cast<uint32_t>(std::min<size_t>(block, data.samples - start));
+        if (!predictBatch(&data.inputs[start * data.input_size], count, outputs.data()))
+            break;
+        tally.add(outputs.data(), &data.outputs[start * data.output_size],
+                  static_cast<size_t>(count) * data.output_size);
+    }
+    return tally;
+}
+
+// Predictions per second over the data in blocks, the best of three runs of at least 0.1 s each
+template <typename Predict>
+double predictionRate(const nnlcpp::SweepData& data, uint32_t block, Predict&& predictBatch) {
+    std::vector<float> outputs(static_cast<size_t>(block) * data.output_size);
+    double             best = 0.0;
+    for (int run = 0; run < 3; ++run) {
+        uint64_t                      predictions = 0;
+        auto                          start = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> elapsed{0};
+        while (elapsed.count() < 0.1) {
+            for (size_t first = 0; first < data.samples; first += block) {
+                uint32_t count = static_cast<uint32_t>(std::min<size_t>(block, data.samples - first));
+                predictBatch(&data.inputs[first * data.input_size], count, outputs.data());
+                predictions += count;
+            }
+            elapsed = std::chrono::high_resolution_clock::now() - start;
+        }
+        best = std::max(best, static_cast<double>(predictions) / elapsed.count());
+    }
+    return best;
+}
+
+// Prune the trained network to the target sparsity, over several steps with sparse fine-tuning
+// in between if asked, and compare the sparse network with the dense one. The pruned weights then
+// replace the network's, so saving, testing and serving all see the pruned model.
+bool runPruning(nnlcpp::NeuralNetwork& nn, const nnlcpp::PruningSettings& settings, nnlcpp::Dataset* dataset) {
+    const uint32_t    block = 256;
+    nnlcpp::SweepData data = loadAll(dataset);
+    nnlcpp::Workspace workspace(nn.getLayers(), block);
+    auto              dense = [&](const float* inputs, uint32_t count, float* outputs) {
+        return nn.predictBatch(inputs, count, outputs, workspace);
+    };
+    auto              dense_single = [&](const float* input, uint32_t, float* output) {
+        return nn.predict({input, data.input_size}, {output, data.output_size}, workspace);
+    };
+    nnlcpp::LossTally before = measureAll(data, block, dense);
+    double            dense_batched_rate = predictionRate(data, block, dense);
+    double            dense_single_rate = predictionRate(data, 1, dense_single);
+
+    printf("\nPruning to %.1f%% sparsity (%s, %u steps, %u fine-tuning epochs each):\n", 100.0 * settings.sparsity,
+           settings.global ? "global" : "per layer", settings.steps, settings.fine_tune_epochs);
+    printf("%6s %10s %12s %10s\n", "Step", "Sparsity", "Loss", "Accuracy");
+    printf("%6s %9.1f%% %12.6f %9.2f%%\n", "dense", 0.0, before.loss(), 100.0 * before.accuracy());
+
+    // Cubic schedule: large cuts while the network has plenty of redundancy, small ones near the
+    // target where each weight matters more
+    std::optional<nnlcpp::SparseNetwork> sparse;
+    nnlcpp::SparseNetwork::Scratch       scratch;
+    uint32_t                             steps = std::max<uint32_t>(settings.steps, 1);
+    for (uint32_t step = 1; step <= steps; ++step) {
+        float remaining = 1.0f - static_cast<float>(step) / static_cast<float>(steps);
+        float sparsity = settings.sparsity * (1.0f - remaining * remaining * remaining);
+        if (sparse) {
+            sparse->prune(sparsity, settings.global);
+        } else {
+            sparse = nnlcpp::SparseNetwork::prune(nn, sparsity, settings.global);
+        }
+        scratch = sparse->makeScratch(block);
+
+        for (uint32_t epoch = 0; epoch < settings.fine_tune_epochs; ++epoch) {
+            for (size_t n = 0; n < data.samples; ++n) {
+                sparse->train({&data.inputs[n * data.input_size], data.input_size},
+                              {&data.outputs[n * data.output_size], data.output_size}, nn.getLearningRate(), scratch);
+            }
+        }
+
+        nnlcpp::LossTally tally = measureAll(data, block, [&](const float* inputs, uint32_t count, float* outputs) {
+            return sparse->predictBatch(inputs, count, outputs, scratch);
+        });
+        printf("%6u %9.1f%% %12.6f %9.2f%%\n", step, 100.0 * sparse->getSparsity(), tally.loss(),
+               100.0 * tally.accuracy());
+    }
+
+    printf("\n%6s %12s %12s %9s %8s %8s\n", "Layer", "Shape", "Weights", "Density", "Single", "Batched");
+    std::vector<nnlcpp::SparseNetwork::LayerInfo> layers = sparse->getLayerInfo();
+    for (size_t i = 0; i < layers.size(); ++i) {
+        std::string shape = std::to_string(layers[i].rows) + "x" + std::to_string(layers[i].cols);
+        size_t      total = static_cast<size_t>(layers[i].rows) * layers[i].cols;
+        printf("%6zu %12s %12zu %8.1f%% %8s %8s\n", i, shape.c_str(), layers[i].non_zeros,
+               100.0 * static_cast<double>(layers[i].non_zeros) / static_cast<double>(total),
+               layers[i].sparse_single ? "csr" : "dense", layers[i].sparse_batched ? "csr" : "dense");
+    }
+
+    auto sparse_batched = [&](const float* inputs, uint32_t count, float* outputs) {
+        return sparse->predictBatch(inputs, count, outputs, scratch);
+    };
+    auto sparse_single = [&](const float* input, uint32_t, float* output) {
+        return sparse->predict({input, data.input_size}, {output, data.output_size}, scratch);
+    };
+    double sparse_batched_rate = predictionRate(data, block, sparse_batched);
+    double sparse_single_rate = predictionRate(data, 1, sparse_single);
+    size_t float_bytes = nnlcpp::QuantizedNetwork::floatBytesFor(nn.getTopology());
+    // Column indices and row offsets can make the pruned form the larger one on small layers
+    double shrink = static_cast<double>(float_bytes) / static_cast<double>(sparse->getBytes());
+    printf("\nParameters: %zu bytes dense, %zu bytes pruned (%.2fx %s)\n", float_bytes, sparse->getBytes(),
+           shrink >= 1.0 ? shrink : 1.0 / shrink, shrink >= 1.0 ? "smaller" : "larger");
+    printf("Inference, one sample per call: %.0f/s dense, %.0f/s pruned (%.2fx)\n", dense_single_rate,
+           sparse_single_rate, sparse_single_rate / dense_single_rate);
+    printf("Inference, batches of %u:       %.0f/s dense, %.0f/s pruned (%.2fx)\n", block, dense_batched_rate,
+           sparse_batched_rate, sparse_batched_rate / dense_batched_rate);
+    return sparse->writeTo(nn);
+}
+
+// Train a grid or random sample of configurations side by side on the XOR table or the whole
+// dataset, cutting the worst half after every round, and print one table of the results.
+bool runSweep(const std::string& spec, size_t samples, uint32_t halving, uint64_t seed,
+              const std::vector<uint32_t>& layers, float learning_rate, nnlcpp::Optimizer optimizer,
+              const std::vector<nnlcpp::Activation>& activations, uint32_t epochs, uint32_t batch_size,
+              uint32_t threads, double target_loss, nnlcpp::Dataset* dataset) {
+    nnlcpp::SweepConfig defaults{layers, learning_rate, seed, optimizer, activations.front()};
+    std::optional<nnlcpp::SweepSpace> space = nnlcpp::SweepSpace::parse(spec, defaults);
+    if (!space)
+        return false;
+
+    std::vector<nnlcpp::SweepConfig> configs;
+    if (samples > 0) {
+        configs = space->sample(samples, seed);
+    } else if (auto grid = space->grid()) {
+        configs = std::move(*grid);
+    } else {
+        return false;
+    }
+
+    nnlcpp::SweepData data = loadAll(dataset);
+
+    nnlcpp::SweepSettings settings;
+    settings.epochs = epochs;
+    settings.batch_size = std::max<uint32_t>(1, batch_size);
+    settings.halving = halving;
+    settings.target_loss = target_loss;
+    settings.threads = threads;
+    printf("\nSweeping %zu configurations on %zu samples with %u threads\n", configs.size(), data.samples, threads);
+
+    auto                             start = std::chrono::high_resolution_clock::now();
+    std::vector<nnlcpp::SweepResult> results = nnlcpp::Sweep::run(configs, data, settings);
+    std::chrono::duration<double>    elapsed = std::chrono::high_resolution_clock::now() - start;
+    if (results.empty())
+        return false;
+    nnlcpp::Sweep::printTable(results);
+    printf("\nSweep took %.3f seconds\n", elapsed.count());
+    return true;
+}
+
+// Set by SIGINT or SIGTERM to shut a socket server down cleanly and print its report
+std::atomic<bool> g_stop_serving{false};
+
+void stopServing(int) {
+    g_stop_serving.store(true);
+}
+
+// Answer prediction requests with the network until interrupted (socket) or end of input ("-")
+bool serve(const nnlcpp::NeuralNetwork& nn, const std::string& path, FILE* responses,
+           const nnlcpp::InferenceServer::Settings& settings) {
+    nnlcpp::InferenceServer server(nn, settings);
+    bool                    ok;
+    if (path == "-") {
+        printf("Serving on stdin (max batch %u, max wait %u us)\n", settings.max_batch, settings.max_wait_us);
+        fflush(stdout);
+        ok = server.serveStream(stdin, responses);
+    } else {
+        std::signal(SIGINT, stopServing);
+        std::signal(SIGTERM, stopServing);
+        ok = server.serveSocket(path, g_stop_serving);
+    }
+    server.printReport();
+    return ok;
+}
+
 void printUsage(const char* programName) {
     const char* programNameOnly = strrchr(programName, '/');
     programNameOnly = programNameOnly ? programNameOnly + 1 : programName;
@@ -84,18 +816,74 @@ void printUsage(const char* programName) {
     printf("OPTIONS:\n");
     printf("  %-20s %s\n", "-h, --help", "Show this help message");
     printf("  %-20s %s\n", "--layers VALUE", "Network architecture (comma-separated)");
-    printf("  %-20s %s\n", "-i, --iterations N", "Number of training iterations");
+    printf("  %-20s %s\n", "--activation LIST", "Activation per layer, or one for all: sigmoid, sigmoid-poly,");
+    printf("  %-20s %s\n", "", "sigmoid-lut, tanh, relu, leaky-relu (comma-separated)");
+    printf("  %-20s %s\n", "-i, --iterations N", "Number of training iterations (the limit with a target)");
+    printf("  %-20s %s\n", "--optimizer NAME", "Update rule: sgd, momentum, nesterov, rmsprop, adam");
+    printf("  %-20s %s\n", "--momentum M", "Velocity decay for momentum and nesterov (0.9)");
+    printf("  %-20s %s\n", "--target-loss L", "Stop once the epoch's mean squared error reaches L");
+    printf("  %-20s %s\n", "--target-accuracy P", "Report the time to P% accuracy (default 100)");
+    printf("  %-20s %s\n", "--patience N", "Stop after N epochs without improvement");
     printf("  %-20s %s\n", "-s, --seed VALUE", "Random seed for reproducibility");
+    printf("  %-20s %s\n", "-b, --batch-size N", "Samples per weight update (1 = per-sample SGD)");
+    printf("  %-20s %s\n", "-t, --threads N", "Split each batch across N threads");
+    printf("  %-20s %s\n", "--hogwild", "Let threads update weights without synchronising");
+    printf("  %-20s %s\n", "--scaling", "Report training and inference throughput for 1..N threads");
+    printf("  %-20s %s\n", "--ranks N", "Train data-parallel in N processes, each on a shard of the data,");
+    printf("  %-20s %s\n", "", "summing gradients with a ring all-reduce (--scaling: 1..N ranks)");
+    printf("  %-20s %s\n", "--transport NAME", "How ranks exchange gradients: socket, shm (default socket)");
+    printf("  %-20s %s\n", "--save PATH", "Write the trained model to a binary model file");
+    printf("  %-20s %s\n", "--load PATH", "Map a saved model instead of building a new one");
+    printf("  %-20s %s\n", "--checkpoint-every N", "Snapshot training state every N iterations, written in the");
+    printf("  %-20s %s\n", "", "background without stalling training");
+    printf("  %-20s %s\n", "--checkpoint PATH", "Checkpoint file (default checkpoint.nnlc)");
+    printf("  %-20s %s\n", "--checkpoint-sync", "Write checkpoints on the training thread, as a baseline");
+    printf("  %-20s %s\n", "--resume", "Continue training from the checkpoint file");
+    printf("  %-20s %s\n", "--serve PATH", "After loading or training, answer prediction requests on a Unix");
+    printf("  %-20s %s\n", "", "socket at PATH, or on stdin/stdout for -, one line per request");
+    printf("  %-20s %s\n", "--max-batch N", "Requests the server coalesces into one forward pass (default 64)");
+    printf("  %-20s %s\n", "--max-wait-us N", "Longest a request waits for its batch to fill (default 200)");
+    printf("  %-20s %s\n", "--data PATH", "Train on a .csv or binary dataset instead of XOR");
+    printf("  %-20s %s\n", "--shuffle-window N", "Samples the data loader shuffles across");
+    printf("  %-20s %s\n", "--convert-data PATH", "Write the --data samples to a binary dataset file");
+    printf("  %-20s %s\n", "--quantize", "Compare int8 quantized inference with float after training");
+    printf("  %-20s %s\n", "--prune S", "After training, remove the fraction S of weights by magnitude");
+    printf("  %-20s %s\n", "", "and compare sparse (CSR) with dense inference");
+    printf("  %-20s %s\n", "--prune-per-layer", "Prune every layer to S instead of using one global threshold");
+    printf("  %-20s %s\n", "--prune-steps N", "Reach S over N pruning steps (default 1)");
+    printf("  %-20s %s\n", "--fine-tune N", "Sparse training epochs after each pruning step (default 0)");
+    printf("  %-20s %s\n", "--sweep SPEC", "Train every configuration of a search space in parallel, e.g.");
+    printf("  %-20s %s\n", "", "\"layers=2,4,1|2,8,1;lr=0.05|0.5;seed=1-4;optimizer=sgd|adam\"");
+    printf("  %-20s %s\n", "--sweep-samples N", "Random search: draw N configurations (lr=lo~hi is log-uniform)");
+    printf("  %-20s %s\n", "--halving N", "Keep the best 1/N of a sweep after each round (default 2, 0 = off)");
+    printf("  %-20s %s\n", "--profile", "Print a per-layer breakdown of training time");
+    printf("  %-20s %s\n", "--profile-trace PATH", "Also write a Chrome trace (chrome://tracing) of training");
     printf("  %-20s %s\n\n", "-lr, --learning-rate R", "Learning rate (0.0-1.0)");
 
     printf("EXAMPLES:\n");
     printf("  %s --layers 2,4,3,1 --iterations 5000\n", programNameOnly);
-    printf("  %s --layers 2,8,8,1 --learning-rate 0.05 --seed 12345\n\n", programNameOnly);
+    printf("  %s --layers 2,8,8,1 --learning-rate 0.05 --seed 12345\n", programNameOnly);
+    printf("  %s --layers 2,8,8,1 --activation relu,relu,sigmoid\n", programNameOnly);
+    printf("  %s --optimizer adam -lr 0.01 --target-loss 0.001 -i 100000\n", programNameOnly);
+    printf("  %s --load xor.nnl   (inference only; add -i N to keep training)\n", programNameOnly);
+    printf("  %s --optimizer adam -i 100000 --checkpoint-every 1000   (then --resume after a crash)\n",
+           programNameOnly);
+    printf("  %s --sweep \"lr=0.01~1;seed=1-8;optimizer=sgd|adam\" --sweep-samples 32 -t 4\n", programNameOnly);
+    printf("  %s --load xor.nnl --serve /tmp/nnl.sock   (benchmark with nnl_loadgen)\n", programNameOnly);
+    printf("  %s --layers 2,4,1 --data xor.csv --convert-data xor.nnld -b 32\n", programNameOnly);
+    printf("  %s --layers 64,128,8 --data train.csv -b 32 --ranks 4 --transport shm --scaling\n\n",
+           programNameOnly);
 
     printf("DEFAULTS:\n");
     printf("  %-20s %s\n", "Network layers:", "2,2,1 (XOR problem)");
+    printf("  %-20s %s\n", "Activation:", "sigmoid");
     printf("  %-20s %s\n", "Iterations:", "10000");
     printf("  %-20s %s\n", "Learning rate:", "0.1");
+    printf("  %-20s %s\n", "Optimizer:", "sgd");
+    printf("  %-20s %s\n", "Batch size:", "1");
+    printf("  %-20s %s\n", "Threads:", "1");
+    printf("  %-20s %s\n", "Ranks:", "1");
+    printf("  %-20s %s\n", "Shuffle window:", "65536");
     printf("  %-20s %s\n\n", "Seed:", "Random (time-based)");
 }
 
@@ -104,6 +892,36 @@ int main(int argc, char const* argv[]) {
     std::vector<uint32_t> layers = {2, 2, 1};  // Default: 2 inputs, 2 hidden, 1 output
     uint32_t iterations = 10000;               // Default: 10000 training cycles
     float learning_rate = 0.1f;                // Default: 0.1 learning rate
+    uint32_t batch_size = 1;                   // Default: update after every sample
+    uint32_t threads = 1;                      // Default: single-threaded training
+    bool hogwild = false;                      // Default: synchronous gradient reduction
+    bool scaling = false;                      // Default: no thread scaling report
+    uint32_t ranks = 1;                        // Default: train in this process only
+    nnlcpp::TransportKind transport_kind = nnlcpp::TransportKind::Socket;
+    bool iterations_set = false;               // Loaded models only train when asked to
+    std::string load_path;                     // Default: build a fresh network
+    std::string save_path;                     // Default: don't persist the trained model
+    std::string data_path;                     // Default: the built-in XOR table
+    std::string convert_path;                  // Default: no dataset conversion
+    size_t shuffle_window = 65536;             // Default: shuffle across 64K samples
+    bool profile = false;                      // Default: no per-layer profile
+    std::string trace_path;                    // Default: no timeline trace
+    bool quantize = false;                     // Default: no int8 comparison
+    std::vector<nnlcpp::Activation> activations; // Default: sigmoid on every layer
+    nnlcpp::OptimizerSettings optimizer;       // Default: plain SGD
+    nnlcpp::EarlyStopping::Settings stopping_settings; // Default: run every iteration
+    bool stopping_set = false;                 // Only score epochs when a criterion is given
+    uint64_t seed = 1;                         // Sweeps seed each run from here unless they list seeds
+    std::string sweep_spec;                    // Default: train a single network
+    size_t sweep_samples = 0;                  // Default: grid search over the sweep space
+    uint32_t halving = 2;                      // Default: halve the sweep after every round
+    uint32_t checkpoint_every = 0;             // Default: no checkpoints
+    std::string checkpoint_path = "checkpoint.nnlc";
+    bool checkpoint_sync = false;              // Default: write checkpoints in the background
+    bool resume = false;                       // Default: start training from scratch
+    std::string serve_path;                    // Default: test the network and exit
+    nnlcpp::InferenceServer::Settings serve_settings;
+    std::optional<nnlcpp::PruningSettings> pruning; // Default: keep every weight
 
     // Parse command line arguments
     for (int i = 1; i < argc; ++i) {
@@ -130,13 +948,173 @@ int main(int argc, char const* argv[]) {
                 layers.push_back(std::stoi(layers_str));
             }
 
+        } else if (arg == "--activation" && i + 1 < argc) {
+            // Parse one activation name per layer
+            std::string activations_str = argv[++i];
+            activations.clear();
+            size_t start = 0;
+            while (start <= activations_str.size()) {
+                size_t end = activations_str.find(',', start);
+                std::string name = activations_str.substr(start, end == std::string::npos ? end : end - start);
+                std::optional<nnlcpp::Activation> activation = nnlcpp::parseActivation(name);
+                if (!activation) {
+                    printf("Error: Unknown activation '%s'.\n", name.c_str());
+                    printUsage(argv[0]);
+                    return 1;
+                }
+                activations.push_back(*activation);
+                if (end == std::string::npos)
+                    break;
+                start = end + 1;
+            }
         } else if ((arg == "--iterations" || arg == "-i") && i + 1 < argc) {
             iterations = std::stoi(argv[++i]);
+            iterations_set = true;
         } else if ((arg == "--seed" || arg == "-s") && i + 1 < argc) {
-            std::srand(std::stoi(argv[++i]));
+            seed = std::stoull(argv[++i]);
+            std::srand(static_cast<unsigned>(seed));
             printf("Using provided seed: %s\n", argv[i]);
         } else if ((arg == "--learning-rate" || arg == "-lr") && i + 1 < argc) {
             learning_rate = std::stof(argv[++i]);
+        } else if ((arg == "--batch-size" || arg == "-b") && i + 1 < argc) {
+            int value = std::stoi(argv[++i]);
+            if (value < 1) {
+                printf("Error: Batch size must be at least 1, got %d.\n", value);
+                printUsage(argv[0]);
+                return 1;
+            }
+            batch_size = static_cast<uint32_t>(value);
+        } else if ((arg == "--threads" || arg == "-t") && i + 1 < argc) {
+            threads = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--hogwild") {
+            hogwild = true;
+        } else if (arg == "--scaling") {
+            scaling = true;
+        } else if (arg == "--ranks" && i + 1 < argc) {
+            ranks = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--transport" && i + 1 < argc) {
+            std::optional<nnlcpp::TransportKind> kind = nnlcpp::parseTransport(argv[++i]);
+            if (!kind) {
+                printf("Error: Unknown transport '%s'.\n", argv[i]);
+                printUsage(argv[0]);
+                return 1;
+            }
+            transport_kind = *kind;
+        } else if (arg == "--load" && i + 1 < argc) {
+            load_path = argv[++i];
+        } else if (arg == "--save" && i + 1 < argc) {
+            save_path = argv[++i];
+        } else if (arg == "--data" && i + 1 < argc) {
+            data_path = argv[++i];
+        } else if (arg == "--shuffle-window" && i + 1 < argc) {
+            shuffle_window = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--convert-data" && i + 1 < argc) {
+            convert_path = argv[++i];
+        } else if (arg == "--profile") {
+            profile = true;
+        } else if (arg == "--profile-trace" && i + 1 < argc) {
+            trace_path = argv[++i];
+            profile = true;
+        } else if (arg == "--quantize") {
+            quantize = true;
+        } else if (arg == "--optimizer" && i + 1 < argc) {
+            std::optional<nnlcpp::Optimizer> type = nnlcpp::parseOptimizer(argv[++i]);
+            if (!type) {
+                printf("Error: Unknown optimizer '%s'.\n", argv[i]);
+                printUsage(argv[0]);
+                return 1;
+            }
+            optimizer.type = *type;
+        } else if (arg == "--momentum" && i + 1 < argc) {
+            optimizer.momentum = std::stof(argv[++i]);
+        } else if (arg == "--target-loss" && i + 1 < argc) {
+            stopping_settings.target_loss = std::stod(argv[++i]);
+            stopping_set = true;
+        } else if (arg == "--target-accuracy" && i + 1 < argc) {
+            stopping_settings.target_accuracy = std::stod(argv[++i]) / 100.0;
+            stopping_set = true;
+        } else if (arg == "--patience" && i + 1 < argc) {
+            stopping_settings.patience = std::stoi(argv[++i]);
+            stopping_set = true;
+        } else if (arg == "--sweep" && i + 1 < argc) {
+            sweep_spec = argv[++i];
+        } else if (arg == "--sweep-samples" && i + 1 < argc) {
+            sweep_samples = std::stoul(argv[++i]);
+        } else if (arg == "--halving" && i + 1 < argc) {
+            halving = std::stoi(argv[++i]);
+        } else if (arg == "--checkpoint-every" && i + 1 < argc) {
+            checkpoint_every = std::stoi(argv[++i]);
+        } else if (arg == "--checkpoint" && i + 1 < argc) {
+            checkpoint_path = argv[++i];
+        } else if (arg == "--checkpoint-sync") {
+            checkpoint_sync = true;
+        } else if (arg == "--resume") {
+            resume = true;
+        } else if (arg == "--prune" && i + 1 < argc) {
+            if (!pruning)
+                pruning.emplace();
+            pruning->sparsity = std::stof(argv[++i]);
+        } else if (arg == "--prune-per-layer") {
+            if (!pruning)
+                pruning.emplace();
+            pruning->global = false;
+        } else if (arg == "--prune-steps" && i + 1 < argc) {
+            if (!pruning)
+                pruning.emplace();
+            pruning->steps = std::stoi(argv[++i]);
+        } else if (arg == "--fine-tune" && i + 1 < argc) {
+            if (!pruning)
+                pruning.emplace();
+            pruning->fine_tune_epochs = std::stoi(argv[++i]);
+        } else if (arg == "--serve" && i + 1 < argc) {
+            serve_path = argv[++i];
+        } else if (arg == "--max-batch" && i + 1 < argc) {
+            serve_settings.max_batch = std::stoi(argv[++i]);
+        } else if (arg == "--max-wait-us" && i + 1 < argc) {
+            serve_settings.max_wait_us = std::stoi(argv[++i]);
+        }
+    }
+
+    // Serving on stdio keeps stdout for answers only; everything else goes to stderr
+    FILE* responses = stdout;
+    if (serve_path == "-") {
+        responses = fdopen(dup(STDOUT_FILENO), "w");
+        dup2(STDERR_FILENO, STDOUT_FILENO);
+    }
+
+    // A loaded model brings its own topology and learning rate; a checkpoint also its optimizer
+    // state and the iterations already done, which count towards -i
+    std::optional<nnlcpp::NeuralNetwork> loaded;
+    uint64_t                             resumed_epoch = 0;
+    if (resume) {
+        if (!load_path.empty()) {
+            printf("Error: --resume and --load are mutually exclusive.\n");
+            return 1;
+        }
+        std::optional<nnlcpp::CheckpointFile::Checkpoint> checkpoint = nnlcpp::CheckpointFile::load(checkpoint_path);
+        if (!checkpoint) {
+            return 1;
+        }
+        resumed_epoch = checkpoint->epoch;
+        printf("Resumed from %s after %llu iterations\n", checkpoint_path.c_str(),
+               static_cast<unsigned long long>(resumed_epoch));
+        loaded = std::move(checkpoint->network);
+        layers = loaded->getTopology();
+        learning_rate = loaded->getLearningRate();
+        optimizer = loaded->getOptimizer().getSettings();
+        iterations = (iterations > resumed_epoch) ? iterations - static_cast<uint32_t>(resumed_epoch) : 0;
+    } else if (!load_path.empty()) {
+        auto load_start = std::chrono::high_resolution_clock::now();
+        loaded = nnlcpp::ModelFile::load(load_path);
+        if (!loaded) {
+            return 1;
+        }
+        std::chrono::duration<double, std::milli> load_time = std::chrono::high_resolution_clock::now() - load_start;
+        printf("Loaded model %s in %.3f ms\n", load_path.c_str(), load_time.count());
+        layers = loaded->getTopology();
+        learning_rate = loaded->getLearningRate();
+        if (!iterations_set) {
+            iterations = 0;
         }
     }
 
@@ -147,6 +1125,20 @@ int main(int argc, char const* argv[]) {
         return 1;
     }
 
+    // One activation applies to every layer; otherwise there must be one per layer. A loaded
+    // model keeps its own unless --activation overrides them.
+    if (activations.size() == 1) {
+        activations.assign(layers.size() - 1, activations.front());
+    }
+    if (activations.empty()) {
+        activations = loaded ? loaded->getActivations()
+                             : std::vector<nnlcpp::Activation>(layers.size() - 1, nnlcpp::Activation::Sigmoid);
+    }
+    if (activations.size() != layers.size() - 1) {
+        printf("Error: %zu activations given for %zu layers.\n", activations.size(), layers.size() - 1);
+        return 1;
+    }
+
     // Print configuration
     printf("Neural network configuration:\n");
     printf("Layers: ");
@@ -155,8 +1147,22 @@ int main(int argc, char const* argv[]) {
         if (i < layers.size() - 1) printf("->");
     }
     printf("\n");
+    printf("Activations: ");
+    for (size_t i = 0; i < activations.size(); ++i) {
+        printf("%s%s", nnlcpp::activationName(activations[i]), (i + 1 < activations.size()) ? "," : "\n");
+    }
     printf("Learning rate: %.3f\n", learning_rate);
+    printf("Optimizer: %s\n", nnlcpp::optimizerName(optimizer.type));
     printf("Training iterations: %u\n", iterations);
+    if (stopping_settings.target_loss > 0.0) {
+        printf("Target loss: %g\n", stopping_settings.target_loss);
+    }
+    printf("Batch size: %u\n", batch_size);
+    printf("Threads: %u%s\n", threads, hogwild ? " (hogwild)" : "");
+    if (ranks > 1) {
+        printf("Ranks: %u over %s\n", ranks, nnlcpp::transportName(transport_kind));
+    }
+    printf("SIMD kernels: %s\n", nnlcpp::Kernels::active().name);
 
     // Use random seed if not provided
     if (argc <= 2) {
@@ -165,22 +1171,144 @@ int main(int argc, char const* argv[]) {
         std::srand(seed);
     }
 
+    // An external dataset replaces the XOR table; its sample shape must match the network
+    std::unique_ptr<nnlcpp::Dataset> dataset;
+    if (!data_path.empty()) {
+        dataset = nnlcpp::Dataset::open(data_path, layers.front(), layers.back());
+        if (!dataset) {
+            return 1;
+        }
+        printf("Dataset: %s (shuffle window %zu)\n", data_path.c_str(), shuffle_window);
+        if (!convert_path.empty()) {
+            if (!nnlcpp::Dataset::writeBinary(*dataset, convert_path)) {
+                return 1;
+            }
+            printf("Converted %s to %s\n", data_path.c_str(), convert_path.c_str());
+            dataset->rewind();
+        }
+    }
+
+    if (!sweep_spec.empty()) {
+        return runSweep(sweep_spec, sweep_samples, halving, seed, layers, learning_rate, optimizer.type,
+                        activations, iterations, batch_size, threads, stopping_settings.target_loss, dataset.get())
+                   ? 0
+                   : 1;
+    }
+
     // Track how long the program takes to run
     auto start = std::chrono::high_resolution_clock::now();
 
     // Create the neural network with the specified configuration
-    nnlcpp::NeuralNetwork nn(layers, learning_rate);
+    nnlcpp::NeuralNetwork nn = loaded ? std::move(*loaded) : nnlcpp::NeuralNetwork(layers, learning_rate);
+    nn.setActivations(activations);
+    if (!resume) {
+        nn.setOptimizer(optimizer);
+    }
 
     // Train the network
-    printf("Training neural network...\n");
-    train(nn, iterations);
+    auto mode = hogwild ? nnlcpp::ParallelTrainer::Mode::Hogwild : nnlcpp::ParallelTrainer::Mode::Synchronous;
+    if (iterations > 0) {
+        printf("Training neural network...\n");
+    }
+    if (profile) {
+        if (nnlcpp::Profiler::compiledIn()) {
+            nnlcpp::Profiler::start(!trace_path.empty());
+        } else {
+            printf("Note: profiling was compiled out; reconfigure with -DNNL_PROFILE=ON.\n");
+        }
+    }
+    if (ranks > 1 && (threads > 1 || stopping_set || checkpoint_every > 0)) {
+        printf("Note: with --ranks every rank trains on one thread, without early stopping or checkpoints.\n");
+    }
+    std::optional<nnlcpp::EarlyStopping> stopping;
+    if (stopping_set && iterations > 0 && ranks == 1) {
+        stopping.emplace(stopping_settings);
+    }
+    nnlcpp::EarlyStopping* criteria = stopping ? &*stopping : nullptr;
+    std::optional<nnlcpp::Checkpointer> checkpoints;
+    if (checkpoint_every > 0 && iterations > 0 && ranks == 1) {
+        checkpoints.emplace(nn, checkpoint_path, checkpoint_every, resumed_epoch, checkpoint_sync);
+    }
+    nnlcpp::Checkpointer* checkpointer = checkpoints ? &*checkpoints : nullptr;
+    if (iterations == 0) {
+        // Nothing to train, e.g. a loaded model used for inference only
+    } else if (ranks > 1) {
+        if (!trainDistributed(nn, loadAll(dataset.get()), ranks, transport_kind, iterations, batch_size)) {
+            return 1;
+        }
+    } else if (dataset) {
+        std::optional<nnlcpp::ParallelTrainer> trainer;
+        if (threads > 1) {
+            trainer.emplace(nn, threads, mode);
+        }
+        if (!trainStreamed(nn, *dataset, iterations, batch_size, shuffle_window, trainer ? &*trainer : nullptr,
+                           criteria, checkpointer)) {
+            return 1;
+        }
+    } else if (threads > 1) {
+        if (batch_size < threads) {
+            printf("Note: batch size %u leaves some of the %u threads idle.\n", batch_size, threads);
+        }
+        nnlcpp::ParallelTrainer trainer(nn, threads, mode);
+        trainBatched(nn, iterations, batch_size, &trainer, criteria, checkpointer);
+    } else if (batch_size > 1) {
+        trainBatched(nn, iterations, batch_size, nullptr, criteria, checkpointer);
+    } else {
+        train(nn, iterations, criteria, checkpointer);
+    }
+    if (checkpoints) {
+        checkpoints->flush();
+        checkpoints->printReport();
+    }
+    if (stopping) {
+        printf("\n");
+        stopping->printReport();
+    }
+
+    if (profile && nnlcpp::Profiler::compiledIn()) {
+        nnlcpp::Profiler::stop();
+        nnlcpp::Profiler::printReport();
+        if (!trace_path.empty() && nnlcpp::Profiler::writeTrace(trace_path)) {
+            printf("Wrote trace to %s\n", trace_path.c_str());
+        }
+    }
+
+    if (pruning && !runPruning(nn, *pruning, dataset.get())) {
+        return 1;
+    }
+
+    if (!save_path.empty()) {
+        if (!nnlcpp::ModelFile::save(nn, save_path)) {
+            return 1;
+        }
+        printf("Saved model to %s\n", save_path.c_str());
+    }
+
+    if (!serve_path.empty()) {
+        return serve(nn, serve_path, responses, serve_settings) ? 0 : 1;
+    }
 
     // Test the network
     printf("\nTesting neural network:\n");
-    predict(nn);
+    if (dataset) {
+        evaluate(nn, *dataset);
+    } else {
+        predict(nn);
+    }
+    if (quantize) {
+        reportQuantization(nn, dataset.get());
+    }
 
     auto end = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> elapsed = end - start;
     printf("\nApp took %.3f seconds to run\n", elapsed.count());
+
+    if (scaling && ranks > 1) {
+        reportRankScaling(layers, nn.getActivations(), learning_rate, ranks, std::max<uint32_t>(batch_size, 256),
+                          transport_kind);
+    } else if (scaling) {
+        reportScaling(layers, nn.getActivations(), learning_rate, threads, std::max<uint32_t>(batch_size, 256), mode);
+        reportInferenceScaling(nn, threads);
+    }
     return 0;
 }
\ No newline at end of file
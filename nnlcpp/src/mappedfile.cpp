@@ -0,0 +1,46 @@
+#include "mappedfile.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace nnlcpp {
+
+MappedFile::~MappedFile() {
+    if (m_data != nullptr) {
+        munmap(m_data, m_size);
+    }
+}
+
+std::shared_ptr<MappedFile> MappedFile::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        printf("Error: Cannot open %s: %s\n", path.c_str(), std::strerror(errno));
+        return nullptr;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        printf("Error: Cannot map empty or unreadable file %s.\n", path.c_str());
+        ::close(fd);
+        return nullptr;
+    }
+
+    // MAP_PRIVATE with write access lets callers modify the parameters (e.g. fine-tuning a loaded
+    // model) without touching the file; only the pages actually written get private copies
+    size_t size = static_cast<size_t>(info.st_size);
+    void*  data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        printf("Error: Cannot map %s: %s\n", path.c_str(), std::strerror(errno));
+        return nullptr;
+    }
+
+    return std::shared_ptr<MappedFile>(new MappedFile(data, size));
+}
+
+} // namespace nnlcpp
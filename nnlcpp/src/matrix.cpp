@@ -1,9 +1,12 @@
 #include "matrix.hpp"
 
+#include "gemm.hpp"
+#include "kernels.hpp"
+
 namespace nnlcpp {
 
-std::vector<float> Matrix:: dotMatrix(std::vector<float> matrix_a, size_t rows_a, size_t cols_a,
-                                     std::vector<float> matrix_b, size_t rows_b, size_t cols_b) {
+std::vector<float> Matrix::dotMatrix(const std::vector<float>& matrix_a, size_t rows_a, size_t cols_a,
+                                    const std::vector<float>& matrix_b, size_t rows_b, size_t cols_b) {
     if (cols_a != rows_b) {
         printf("Error: Cannot multply matrix shape [%d,%d] and [%d,%d]\n", static_cast<int>(rows_a),
                static_cast<int>(cols_a), static_cast<int>(rows_b), static_cast<int>(cols_b));
@@ -11,18 +14,16 @@ std::vector<float> Matrix:: dotMatrix(std::vector<float> matrix_a, size_t rows_a
     }
 
     // matrix multiply the two matrices
-    std::vector<float> result(rows_a * cols_b, 0.0f);
-    for (size_t i = 0; i < rows_a; ++i) {
-        for (size_t j = 0; j < cols_b; ++j) {
-            for (size_t k = 0; k < cols_a; ++k) {
-                result[i * cols_b + j] += matrix_a[i * cols_a + k] * matrix_b[k * cols_b + j];
-            }
-        }
+    std::vector<float> result(rows_a * cols_b);
+    if (!Gemm::multiply(1.0f, ConstMatrixView(matrix_a.data(), rows_a, cols_a), Transpose::No,
+                        ConstMatrixView(matrix_b.data(), rows_b, cols_b), Transpose::No, 0.0f,
+                        MatrixView(result.data(), rows_a, cols_b))) {
+        return {};
     }
     return result;
 }
 
-std::vector<float> Matrix::transpose(std::vector<float> matrix, size_t rows, size_t cols) {
+std::vector<float> Matrix::transpose(const std::vector<float>& matrix, size_t rows, size_t cols) {
     std::vector<float> transposed(cols * rows);
     for (size_t i = 0; i < rows; ++i) {
         for (size_t j = 0; j < cols; ++j) {
@@ -37,22 +38,35 @@ std::vector<float> Matrix::transpose(std::vector<float> matrix, size_t rows, siz
 void Matrix::randomize() {}
 
 std::vector<float> Matrix::add(const std::vector<float>& a, const std::vector<float>& b) {
-    return elementWiseOperation(a, b, [](float x, float y) { return x + y; });
+    return elementWiseOperation(a, b, Kernels::active().add);
 }
 
 std::vector<float> Matrix::subtract(const std::vector<float>& a, const std::vector<float>& b) {
-    return elementWiseOperation(a, b, [](float x, float y) { return x - y; });
+    return elementWiseOperation(a, b, Kernels::active().subtract);
 }
 
 std::vector<float> Matrix::multiply(const std::vector<float>& a, const std::vector<float>& b) {
-    return elementWiseOperation(a, b, [](float x, float y) { return x * y; });
+    return elementWiseOperation(a, b, Kernels::active().multiply);
 }
 
 std::vector<float> Matrix::divide(const std::vector<float>& a, const std::vector<float>& b) {
-    return elementWiseOperation(a, b, [](float x, float y) {
-        if (y == 0)
-            return static_cast<float>(0); // Handle division by zero
-        return x / y;
-    });
+    // Division by zero yields zero
+    return elementWiseOperation(a, b, Kernels::active().divide);
+}
+
+bool Matrix::add(std::span<const float> a, std::span<const float> b, std::span<float> out) {
+    return elementWiseOperation(a, b, out, Kernels::active().add);
+}
+
+bool Matrix::subtract(std::span<const float> a, std::span<const float> b, std::span<float> out) {
+    return elementWiseOperation(a, b, out, Kernels::active().subtract);
+}
+
+bool Matrix::multiply(std::span<const float> a, std::span<const float> b, std::span<float> out) {
+    return elementWiseOperation(a, b, out, Kernels::active().multiply);
+}
+
+bool Matrix::divide(std::span<const float> a, std::span<const float> b, std::span<float> out) {
+    return elementWiseOperation(a, b, out, Kernels::active().divide);
 }
-} // namespace nnlcpp
\ No newline at end of file
+} // namespace nnlcpp
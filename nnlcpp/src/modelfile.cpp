@@ -0,0 +1,137 @@
+#include "modelfile.hpp"
+
+#include <cstring>
+#include <stdio.h>
+#include <vector>
+
+#include "mappedfile.hpp"
+
+namespace nnlcpp {
+
+namespace {
+
+constexpr char     MAGIC[8] = {'N', 'N', 'L', 'M', 'O', 'D', 'E', 'L'};
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+size_t alignUp(size_t offset) {
+    return (offset + MODEL_FILE_ALIGNMENT - 1) / MODEL_FILE_ALIGNMENT * MODEL_FILE_ALIGNMENT;
+}
+
+constexpr uint32_t FIRST_VERSION_WITH_ACTIVATIONS = 2;
+
+size_t activationsOffset(const std::vector<uint32_t>& topology) {
+    return sizeof(ModelFileHeader) + topology.size() * sizeof(uint32_t);
+}
+
+size_t activationsSize(const std::vector<uint32_t>& topology, uint32_t version) {
+    return (version >= FIRST_VERSION_WITH_ACTIVATIONS) ? (topology.size() - 1) * sizeof(uint8_t) : 0;
+}
+
+// The parameters follow the header, topology and activations as one ParameterArena image, which
+// aligns every array to 64 bytes relative to its own 64-byte-aligned start
+size_t parametersOffset(const std::vector<uint32_t>& topology, uint32_t version) {
+    return alignUp(activationsOffset(topology) + activationsSize(topology, version));
+}
+
+size_t fileSize(const std::vector<uint32_t>& topology, uint32_t version) {
+    return parametersOffset(topology, version) + ParameterArena::bytesFor(topology);
+}
+
+bool writeAt(FILE* file, size_t offset, const void* data, size_t size) {
+    return fseek(file, static_cast<long>(offset), SEEK_SET) == 0 && fwrite(data, 1, size, file) == size;
+}
+
+} // namespace
+
+bool ModelFile::save(const NeuralNetwork& network, const std::string& path) {
+    const ParameterArena&        parameters = network.getParameters();
+    const std::vector<uint32_t>& topology = parameters.getTopology();
+
+    ModelFileHeader header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = MODEL_FILE_VERSION;
+    header.byte_order = BYTE_ORDER_MARK;
+    header.layer_count = static_cast<uint32_t>(parameters.getLayerCount());
+    header.learning_rate = network.getLearningRate();
+    header.file_size = fileSize(topology, MODEL_FILE_VERSION);
+
+    std::vector<uint8_t> activations;
+    for (Activation activation : network.getActivations()) {
+        activations.push_back(static_cast<uint8_t>(activation));
+    }
+
+    // Write next to the target and rename over it, so readers never map a half-written model
+    std::string tmp_path = path + ".tmp";
+    FILE*       file = fopen(tmp_path.c_str(), "wb");
+    if (file == nullptr) {
+        printf("Error: Cannot open %s for writing.\n", tmp_path.c_str());
+        return false;
+    }
+
+    // The arena already carries the alignment padding, so the parameters go out in one write
+    bool ok = writeAt(file, 0, &header, sizeof(header)) &&
+              writeAt(file, sizeof(ModelFileHeader), topology.data(), topology.size() * sizeof(uint32_t)) &&
+              writeAt(file, activationsOffset(topology), activations.data(), activations.size()) &&
+              writeAt(file, parametersOffset(topology, MODEL_FILE_VERSION), parameters.data(),
+                      parameters.size() * sizeof(float));
+    ok = (fclose(file) == 0) && ok;
+
+    if (!ok || std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        printf("Error: Failed to write model file %s.\n", path.c_str());
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::optional<NeuralNetwork> ModelFile::load(const std::string& path) {
+    std::shared_ptr<MappedFile> mapping = MappedFile::open(path);
+    if (!mapping)
+        return std::nullopt;
+
+    auto*                  base = static_cast<uint8_t*>(mapping->data());
+    const ModelFileHeader* header = reinterpret_cast<const ModelFileHeader*>(base);
+    if (mapping->size() < sizeof(ModelFileHeader) || std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0) {
+        printf("Error: %s is not an nnl model file.\n", path.c_str());
+        return std::nullopt;
+    }
+    uint32_t version = header->version;
+    if (version == 0 || version > MODEL_FILE_VERSION || header->byte_order != BYTE_ORDER_MARK) {
+        printf("Error: %s has unsupported version %u or byte order 0x%08x.\n", path.c_str(), header->version,
+               header->byte_order);
+        return std::nullopt;
+    }
+
+    size_t topology_bytes = (static_cast<size_t>(header->layer_count) + 1) * sizeof(uint32_t);
+    if (header->layer_count == 0 || sizeof(ModelFileHeader) + topology_bytes > mapping->size()) {
+        printf("Error: %s has a truncated topology.\n", path.c_str());
+        return std::nullopt;
+    }
+    const uint32_t*       sizes = reinterpret_cast<const uint32_t*>(base + sizeof(ModelFileHeader));
+    std::vector<uint32_t> topology(sizes, sizes + header->layer_count + 1);
+
+    size_t file_size = fileSize(topology, version);
+    if (file_size != header->file_size || file_size != mapping->size()) {
+        printf("Error: %s is %zu bytes but its topology needs %zu.\n", path.c_str(), mapping->size(), file_size);
+        return std::nullopt;
+    }
+
+    std::vector<Activation> activations(header->layer_count, Activation::Sigmoid);
+    const uint8_t*          stored = base + activationsOffset(topology);
+    for (size_t i = 0; i < activationsSize(topology, version); ++i) {
+        if (stored[i] >= ACTIVATION_COUNT) {
+            printf("Error: %s has unknown activation %u on layer %zu.\n", path.c_str(), stored[i], i);
+            return std::nullopt;
+        }
+        activations[i] = static_cast<Activation>(stored[i]);
+    }
+
+    // The network's arena views the mapped pages directly; nothing is copied
+    float*        parameters = reinterpret_cast<float*>(base + parametersOffset(topology, version));
+    float         learning_rate = header->learning_rate;
+    NeuralNetwork network(ParameterArena::view(topology, parameters, std::move(mapping)), learning_rate);
+    network.setActivations(activations);
+    return network;
+}
+
+} // namespace nnlcpp
@@ -1,129 +1,438 @@
 #include "neuralnetwork.hpp"
+
+#include <algorithm>
+#include <random>
+
+#include "expression.hpp"
+#include "kernels.hpp"
+#include "profiler.hpp"
+
 namespace nnlcpp {
 
 NeuralNetwork::NeuralNetwork(std::vector<uint32_t> layers, float learning_rate)
+      : m_parameters(layers),
+        m_activations(m_parameters.getLayerCount(), Activation::Sigmoid),
+        m_learning_rate(learning_rate) {
+    // Each layer connects layers[i] neurons to layers[i + 1] neurons through a
+    // (output_size x input_size) weights matrix, all carved out of one arena
+    bindLayers();
+    for (auto& layer : m_layers) {
+        layer.randomize();
+    }
+}
+
+NeuralNetwork::NeuralNetwork(std::vector<uint32_t> layers, float learning_rate, uint64_t seed)
+      : m_parameters(layers),
+        m_activations(m_parameters.getLayerCount(), Activation::Sigmoid),
+        m_learning_rate(learning_rate) {
+    bindLayers();
+    std::seed_seq seeds{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)};
+    std::mt19937  rng(seeds);
+    for (auto& layer : m_layers) {
+        layer.randomize(rng);
+    }
+}
+
+NeuralNetwork::NeuralNetwork(const std::vector<Layer>& layers, float learning_rate)
       : m_learning_rate(learning_rate) {
-    // Constructor implementation - Create layers with proper dimensions
-    // For each layer, the weights matrix should have dimensions: (output_size × input_size)
+    // No layers gives an empty network, with no topology to take an input size from
+    if (!layers.empty()) {
+        std::vector<uint32_t> topology;
+        topology.push_back(layers.front().getCols());
+        for (const auto& layer : layers) {
+            topology.push_back(layer.getRows());
+        }
+        m_parameters = ParameterArena(topology);
+    }
+    for (const auto& layer : layers) {
+        m_activations.push_back(layer.getActivation());
+    }
+    bindLayers();
+    for (size_t i = 0; i < layers.size(); ++i) {
+        m_layers[i].setWeights(layers[i].getWeights());
+        m_layers[i].setBiases(layers[i].getBiases());
+    }
+}
 
-    for (size_t i = 0; i < layers.size() - 1; ++i) {
-        // Each layer connects layer[i] neurons to layer[i+1] neurons
-        uint32_t input_size = layers[i];     // Number of neurons in current layer (columns)
-        uint32_t output_size = layers[i+1];  // Number of neurons in next layer (rows)
+NeuralNetwork::NeuralNetwork(ParameterArena parameters, float learning_rate)
+      : m_parameters(std::move(parameters)),
+        m_activations(m_parameters.getLayerCount(), Activation::Sigmoid),
+        m_learning_rate(learning_rate) {
+    bindLayers();
+}
 
-        // Create a layer with output_size × input_size weights matrix
-        m_layers.emplace_back(Layer(output_size, input_size));
+NeuralNetwork::NeuralNetwork(const NeuralNetwork& other)
+      : m_parameters(other.m_parameters),
+        m_activations(other.m_activations),
+        m_learning_rate(other.m_learning_rate),
+        m_optimizer(other.m_optimizer) {
+    bindLayers();
+}
+
+NeuralNetwork& NeuralNetwork::operator=(const NeuralNetwork& other) {
+    if (this != &other) {
+        *this = NeuralNetwork(other);
     }
+    return *this;
 }
 
-bool NeuralNetwork::train(const std::vector<float>& input, std::vector<float>& expected_output) {
-    // Store activations and weighted inputs for backpropagation
-    std::vector<std::vector<float>> activations;    // Outputs of each layer
-    std::vector<std::vector<float>> weighted_inputs; // Inputs to activation function
+void NeuralNetwork::bindLayers() {
+    const std::vector<uint32_t>& topology = m_parameters.getTopology();
+    m_layers.clear();
+    for (size_t i = 0; i < m_parameters.getLayerCount(); ++i) {
+        m_layers.emplace_back(topology[i + 1], topology[i], m_parameters.weights(i).data(),
+                              m_parameters.biases(i).data(), m_activations[i]);
+    }
+
+    // Size the training scratch memory once for single-sample steps
+    m_workspace = Workspace(m_layers);
+}
 
-    activations.push_back(input); // First activation is the input
+bool NeuralNetwork::setActivations(const std::vector<Activation>& activations) {
+    if (activations.size() != m_layers.size()) {
+        printf("Error: setActivations expects %zu activations but got %zu.\n", m_layers.size(), activations.size());
+        return false;
+    }
+    m_activations = activations;
+    bindLayers();
+    return true;
+}
+
+void NeuralNetwork::setOptimizer(const OptimizerSettings& settings) {
+    m_optimizer = OptimizerState(m_parameters.getTopology(), settings);
+}
+
+std::vector<uint32_t> NeuralNetwork::getTopology() const {
+    return m_parameters.getTopology();
+}
+
+bool NeuralNetwork::train(const std::vector<float>& input, std::vector<float>& expected_output) {
+    if (input.size() != m_layers.front().getCols() || expected_output.size() != m_layers.back().getRows()) {
+        printf("Error: train expects %u inputs and %u outputs but got %zu and %zu.\n", m_layers.front().getCols(),
+               m_layers.back().getRows(), input.size(), expected_output.size());
+        return false;
+    }
 
-    auto output = input;
-    auto output_rows = input.size();
-    auto output_cols = 1;
+    // Activations and deltas live in the preallocated workspace, so a step never allocates
+    m_workspace.reserve(1);
+    const KernelTable& kernels = Kernels::active();
 
     // Feed forward through all layers
+    const float* output = input.data();
     for (size_t i = 0; i < m_layers.size(); ++i) {
-        // 1. Compute weighted input (before activation function)
-        auto dot_result = Matrix::dotMatrix(
-            m_layers[i].getWeights(),
-            m_layers[i].getRows(),
-            m_layers[i].getCols(),
-            output, output_rows, output_cols
-        );
-
-        if (dot_result.empty()) {
-            printf("Error: dotMatrix returned empty output for layer %zu.\n", i);
-            return false;
+        const Layer&     layer = m_layers[i];
+        std::span<float> a = m_workspace.activation(i);
+        const uint64_t   rows = layer.getRows();
+        const uint64_t   cols = layer.getCols();
+
+        // Weighted input, bias and activation in one pass. Backprop only needs the activation output.
+        {
+            NNL_PROFILE_SCOPE(Forward, i, 2 * rows * cols + 4 * rows, 4 * (rows * cols + cols + 2 * rows));
+            kernels.activation(layer.getActivation())
+                .dense(layer.weights().data(), output, layer.biases().data(), nullptr, a.data(), rows, cols);
         }
 
-        // 2. Add biases
-        auto z = Matrix::add(dot_result, m_layers[i].getBiases());
-        if (z.empty()) {
-            printf("Error: bias addition returned empty output for layer %zu.\n", i);
-            return false;
+        output = a.data();
+    }
+
+    // Calculate output error and apply derivative of the output activation to it
+    std::span<float> delta = m_workspace.delta(m_layers.back().getRows());
+    {
+        NNL_PROFILE_SCOPE(OutputError, m_layers.size() - 1, 4 * delta.size(), 16 * delta.size());
+        kernels.subtract(expected_output.data(), output, delta.data(), delta.size());
+        kernels.activation(m_layers.back().getActivation())
+            .multiplyDerivative(delta.data(), output, delta.data(), delta.size());
+    }
+
+    // Plain SGD updates the biases in place below; everything else goes through the fused update kernels
+    using expression::values;
+    const bool              plain_sgd = m_optimizer.getType() == Optimizer::Sgd;
+    const OptimizerKernels& optimizer = kernels.optimizer(m_optimizer.getType());
+    const OptimizerStep     step =
+        plain_sgd ? OptimizerStep{m_learning_rate, 0.0f, 0.0f, 0.0f} : m_optimizer.beginStep(m_learning_rate);
+
+    // Backpropagation
+    for (int i = m_layers.size() - 1; i >= 0; i--) {
+        Layer&           layer = m_layers[i];
+        std::span<float> weights = layer.weights();
+        std::span<float> biases = layer.biases();
+        const size_t     rows = layer.getRows();
+        const size_t     cols = layer.getCols();
+
+        // 1. Update biases: delta directly gives the gradient for biases
+        {
+            NNL_PROFILE_SCOPE(BiasUpdate, i, 2 * rows, 12 * rows);
+            if (plain_sgd) {
+                expression::evaluate(biases, values(biases) + m_learning_rate * values(delta));
+            } else {
+                optimizer.update(biases.data(), delta.data(), 1.0f, m_optimizer.firstBiases(i),
+                                 m_optimizer.secondBiases(i), rows, step);
+            }
         }
 
-        // Store weighted input for backpropagation
-        weighted_inputs.push_back(z);
+        // 2. Update weights with the outer product of delta and the previous layer's activation and,
+        // in the same pass over the matrix, propagate the error through the weights as they were
+        const float* prev_activation = (i > 0) ? m_workspace.activation(i - 1).data() : input.data();
+        float*       new_delta = (i > 0) ? m_workspace.nextDelta(cols).data() : nullptr;
+        {
+            NNL_PROFILE_SCOPE(WeightUpdate, i, (new_delta ? 4 : 2) * rows * cols,
+                              4 * (2 * rows * cols + rows + (new_delta ? 3 : 1) * cols));
+            optimizer.updateOuter(weights.data(), delta.data(), prev_activation, new_delta,
+                                  m_optimizer.firstWeights(i), m_optimizer.secondWeights(i), rows, cols, step);
+        }
 
-        // 3. Apply activation function
-        std::vector<float> a(z.size());
-        for (size_t j = 0; j < z.size(); j++) {
-            a[j] = sigmoid(z[j]);
+        // 3. Apply the derivative of the previous layer's activation to the propagated error
+        if (i > 0) {
+            NNL_PROFILE_SCOPE(DeltaPropagation, i, 3 * cols, 12 * cols);
+            kernels.activation(m_layers[i - 1].getActivation())
+                .multiplyDerivative(new_delta, prev_activation, new_delta, cols);
+
+            m_workspace.swapDeltas();
+            delta = m_workspace.delta(cols);
         }
+    }
 
-        output = a;
-        activations.push_back(output); // Store activation
+    return true;
+}
 
-        output_rows = m_layers[i].getRows();
-        output_cols = 1;
+bool NeuralNetwork::trainBatch(const std::vector<float>& inputs, const std::vector<float>& expected_outputs,
+                               uint32_t batch_size) {
+    const size_t input_size = m_layers.front().getCols();
+    const size_t output_size = m_layers.back().getRows();
+    if (batch_size == 0 || inputs.size() != batch_size * input_size ||
+        expected_outputs.size() != batch_size * output_size) {
+        printf("Error: trainBatch expects %u x %zu inputs and %u x %zu outputs but got %zu and %zu values.\n",
+               batch_size, input_size, batch_size, output_size, inputs.size(), expected_outputs.size());
+        return false;
     }
 
-    // Calculate output error
-    auto output_error = Matrix::subtract(expected_output, output);
-    if (output_error.empty()) {
-        printf("Error: subtract returned empty output_error vector.\n");
+    return trainBatch(inputs.data(), expected_outputs.data(), batch_size, m_workspace);
+}
+
+bool NeuralNetwork::trainBatch(const float* inputs, const float* expected_outputs, uint32_t batch_size,
+                               Workspace& workspace) {
+    if (!forwardBatch(inputs, batch_size, workspace))
         return false;
+
+    if (m_optimizer.getType() == Optimizer::Sgd) {
+        // Apply W += lr / N * delta * A_prev^T and b += lr / N * sum(delta) straight into the layer
+        const float scale = m_learning_rate / static_cast<float>(batch_size);
+        backwardBatch(inputs, expected_outputs, batch_size, workspace,
+                      [&](size_t i, ConstMatrixView delta, ConstMatrixView prev_t, Transpose trans_prev) {
+                          Layer& layer = m_layers[i];
+                          {
+                              NNL_PROFILE_SCOPE(BiasUpdate, i, delta.rows * delta.cols,
+                                                4 * delta.rows * (delta.cols + 2));
+                              accumulateRowSums(delta, scale, layer.biases().data());
+                          }
+                          NNL_PROFILE_SCOPE(WeightUpdate, i, 2ull * layer.getWeights().size() * delta.cols,
+                                            4 * (2 * layer.getWeights().size() + delta.rows * delta.cols +
+                                                 prev_t.rows * prev_t.cols));
+                          Gemm::multiply(scale, delta, Transpose::No, prev_t, trans_prev, 1.0f,
+                                         MatrixView(layer.weights().data(), layer.getRows(), layer.getCols()));
+                      });
+        return true;
     }
 
-    // Compute error for output layer
-    std::vector<float> delta = output_error;
+    // Other rules need each layer's summed gradient whole: form it in the workspace, then hand
+    // it, scaled to the batch mean, to the rule's fused update
+    const OptimizerKernels& optimizer = Kernels::active().optimizer(m_optimizer.getType());
+    const OptimizerStep     step = m_optimizer.beginStep(m_learning_rate);
+    const float             scale = 1.0f / static_cast<float>(batch_size);
+    backwardBatch(inputs, expected_outputs, batch_size, workspace,
+                  [&](size_t i, ConstMatrixView delta, ConstMatrixView prev_t, Transpose trans_prev) {
+                      Layer&           layer = m_layers[i];
+                      const size_t     weight_count = layer.getWeights().size();
+                      std::span<float> gradient = workspace.gradient(weight_count + layer.getRows());
+                      float*           bias_gradient = gradient.data() + weight_count;
+                      {
+                          NNL_PROFILE_SCOPE(BiasUpdate, i, delta.rows * delta.cols, 4 * delta.rows * (delta.cols + 2));
+                          std::fill_n(bias_gradient, layer.getRows(), 0.0f);
+                          accumulateRowSums(delta, 1.0f, bias_gradient);
+                          optimizer.update(layer.biases().data(), bias_gradient, scale, m_optimizer.firstBiases(i),
+                                           m_optimizer.secondBiases(i), layer.getRows(), step);
+                      }
+                      NNL_PROFILE_SCOPE(WeightUpdate, i, 2ull * weight_count * delta.cols,
+                                        4 * (4 * weight_count + delta.rows * delta.cols + prev_t.rows * prev_t.cols));
+                      Gemm::multiply(1.0f, delta, Transpose::No, prev_t, trans_prev, 0.0f,
+                                     MatrixView(gradient.data(), layer.getRows(), layer.getCols()));
+                      optimizer.update(layer.weights().data(), gradient.data(), scale, m_optimizer.firstWeights(i),
+                                       m_optimizer.secondWeights(i), weight_count, step);
+                  });
+    return true;
+}
 
-    // Apply derivative of sigmoid to error
-    for (size_t i = 0; i < delta.size(); i++) {
-        delta[i] *= dSigmoid(activations.back()[i]);
+bool NeuralNetwork::computeGradients(const float* inputs, const float* expected_outputs, uint32_t batch_size,
+                                     Workspace& workspace, Gradients& gradients,
+                                     const std::function<void(size_t layer)>& layer_ready) const {
+    if (gradients.getLayerCount() != m_layers.size()) {
+        printf("Error: computeGradients got gradients for %zu layers, network has %zu.\n",
+               gradients.getLayerCount(), m_layers.size());
+        return false;
     }
+    if (!forwardBatch(inputs, batch_size, workspace))
+        return false;
 
-    // Backpropagation
-    for (int i = m_layers.size() - 1; i >= 0; i--) {
-        // 1. Update biases: delta directly gives the gradient for biases
-        std::vector<float> new_biases = m_layers[i].getBiases();
-        for (size_t j = 0; j < new_biases.size(); j++) {
-            new_biases[j] += m_learning_rate * delta[j];
+    // Overwrite the gradients with the batch sums delta * A_prev^T and sum(delta)
+    backwardBatch(inputs, expected_outputs, batch_size, workspace,
+                  [&](size_t i, ConstMatrixView delta, ConstMatrixView prev_t, Transpose trans_prev) {
+                      std::span<float> biases = gradients.biases(i);
+                      {
+                          NNL_PROFILE_SCOPE(BiasUpdate, i, delta.rows * delta.cols, 4 * delta.rows * (delta.cols + 2));
+                          std::fill(biases.begin(), biases.end(), 0.0f);
+                          accumulateRowSums(delta, 1.0f, biases.data());
+                      }
+                      {
+                          NNL_PROFILE_SCOPE(WeightUpdate, i, 2ull * m_layers[i].getWeights().size() * delta.cols,
+                                            4 * (2 * m_layers[i].getWeights().size() + delta.rows * delta.cols +
+                                                 prev_t.rows * prev_t.cols));
+                          Gemm::multiply(1.0f, delta, Transpose::No, prev_t, trans_prev, 0.0f,
+                                         MatrixView(gradients.weights(i).data(), m_layers[i].getRows(),
+                                                    m_layers[i].getCols()));
+                      }
+                      if (layer_ready)
+                          layer_ready(i);
+                  });
+    return true;
+}
+
+bool NeuralNetwork::applyGradients(const Gradients& gradients, float scale) {
+    const ParameterArena& gradient = gradients.getArena();
+    if (!gradient.sameLayout(m_parameters)) {
+        printf("Error: applyGradients got gradients for %zu layers, network has %zu.\n",
+               gradients.getLayerCount(), m_layers.size());
+        return false;
+    }
+
+    // Every arena shares one layout with zeroed padding, so the update is a single streaming pass
+    if (m_optimizer.getType() == Optimizer::Sgd) {
+        using expression::values;
+        std::span<float>       parameters(m_parameters.data(), m_parameters.size());
+        std::span<const float> gradient_values(gradient.data(), gradient.size());
+        return expression::evaluate(parameters,
+                                    values(parameters) + (m_learning_rate * scale) * values(gradient_values));
+    }
+
+    const OptimizerStep step = m_optimizer.beginStep(m_learning_rate);
+    Kernels::active()
+        .optimizer(m_optimizer.getType())
+        .update(m_parameters.data(), gradient.data(), scale, m_optimizer.first(), m_optimizer.second(),
+                m_parameters.size(), step);
+    return true;
+}
+
+void NeuralNetwork::accumulateRowSums(ConstMatrixView matrix, float scale, float* sums) {
+    for (size_t j = 0; j < matrix.rows; ++j) {
+        const float* row = &matrix.data[j * matrix.stride];
+        float        sum = 0.0f;
+        for (size_t n = 0; n < matrix.cols; ++n) {
+            sum += row[n];
         }
-        m_layers[i].setBiases(new_biases);
+        sums[j] += scale * sum;
+    }
+}
 
-        // 2. Update weights: outer product of delta and activation from previous layer
-        std::vector<float> prev_activation = activations[i]; // Previous layer activation
-        std::vector<float> new_weights = m_layers[i].getWeights();
+bool NeuralNetwork::forwardBatch(const float* inputs, uint32_t batch_size, Workspace& workspace) const {
+    // Activations are stored neuron-major with one column per sample (rows x batch_size), so every
+    // layer is a single matrix-matrix product with the batch as the columns.
+    workspace.reserve(batch_size);
+    const KernelTable& kernels = Kernels::active();
 
-        for (size_t j = 0; j < m_layers[i].getRows(); j++) {
-            for (size_t k = 0; k < m_layers[i].getCols(); k++) {
-                size_t idx = j * m_layers[i].getCols() + k;
-                new_weights[idx] += m_learning_rate * delta[j] * prev_activation[k];
+    for (size_t i = 0; i < m_layers.size(); ++i) {
+        const Layer&     layer = m_layers[i];
+        std::span<float> z = workspace.activation(i);
+        const uint64_t   rows = layer.getRows();
+        const uint64_t   cols = layer.getCols();
+
+        // 1. Broadcast the biases into the output so the product can accumulate onto them
+        {
+            NNL_PROFILE_SCOPE(BiasActivation, i, 0, 4 * (rows + z.size()));
+            std::span<const float> biases = layer.biases();
+            for (size_t j = 0; j < layer.getRows(); ++j) {
+                std::fill_n(&z[j * batch_size], batch_size, biases[j]);
             }
         }
-        m_layers[i].setWeights(new_weights);
 
-        // 3. Propagate error to previous layer (if not the first layer)
-        if (i > 0) {
-            // Calculate error for previous layer
-            std::vector<float> new_delta(m_layers[i-1].getRows(), 0.0f);
-
-            // Multiply by transpose of weights
-            for (size_t j = 0; j < m_layers[i].getRows(); j++) {
-                for (size_t k = 0; k < m_layers[i].getCols(); k++) {
-                    size_t idx = j * m_layers[i].getCols() + k;
-                    new_delta[k] += m_layers[i].getWeights()[idx] * delta[j];
-                }
-            }
+        // 2. Weighted input: W * X^T for the first layer (inputs arrive one sample per row),
+        //    W * A_prev for every later one
+        ConstMatrixView weights(layer.weights().data(), layer.getRows(), layer.getCols());
+        MatrixView      out(z.data(), layer.getRows(), batch_size);
+        bool            ok;
+        {
+            NNL_PROFILE_SCOPE(Forward, i, 2 * rows * cols * batch_size,
+                              4 * (rows * cols + (cols + 2 * rows) * batch_size));
+            ok = (i == 0) ? Gemm::multiply(1.0f, weights, Transpose::No,
+                                           ConstMatrixView(inputs, batch_size, layer.getCols()), Transpose::Yes,
+                                           1.0f, out)
+                          : Gemm::multiply(1.0f, weights, Transpose::No,
+                                           ConstMatrixView(workspace.activation(i - 1).data(), layer.getCols(),
+                                                           batch_size),
+                                           Transpose::No, 1.0f, out);
+        }
+        if (!ok) {
+            printf("Error: batch forward pass failed for layer %zu.\n", i);
+            return false;
+        }
 
-            // Apply derivative of sigmoid
-            for (size_t j = 0; j < new_delta.size(); j++) {
-                new_delta[j] *= dSigmoid(activations[i][j]);
-            }
+        // 3. Apply the activation function in place
+        NNL_PROFILE_SCOPE(BiasActivation, i, 3 * z.size(), 8 * z.size());
+        kernels.activation(layer.getActivation()).activate(z.data(), z.data(), z.size());
+    }
+    return true;
+}
 
-            delta = new_delta;
+template <typename Update>
+void NeuralNetwork::backwardBatch(const float* inputs, const float* expected_outputs, uint32_t batch_size,
+                                  Workspace& workspace, Update&& update) const {
+    const KernelTable& kernels = Kernels::active();
+    const size_t       output_size = m_layers.back().getRows();
+
+    // Output error times the derivative of the output activation, transposing the expected outputs on the fly
+    std::span<const float> output = workspace.activation(m_layers.size() - 1);
+    std::span<float>       delta = workspace.delta(output_size);
+    {
+        NNL_PROFILE_SCOPE(OutputError, m_layers.size() - 1, 4 * delta.size(), 16 * delta.size());
+        for (size_t j = 0; j < output_size; ++j) {
+            for (size_t n = 0; n < batch_size; ++n) {
+                delta[j * batch_size + n] = expected_outputs[n * output_size + j] - output[j * batch_size + n];
+            }
         }
+        kernels.activation(m_layers.back().getActivation())
+            .multiplyDerivative(delta.data(), output.data(), delta.data(), delta.size());
     }
 
-    return true;
+    // Backpropagation. Every layer's error is taken against the weights the batch was forwarded
+    // through before update() gets to consume the layer's delta.
+    for (int i = m_layers.size() - 1; i >= 0; i--) {
+        const Layer& layer = m_layers[i];
+        const size_t rows = layer.getRows();
+        const size_t cols = layer.getCols();
+
+        // 1. Propagate error to previous layer: W^T * delta, times the derivative of its activation
+        if (i > 0) {
+            NNL_PROFILE_SCOPE(DeltaPropagation, i, (2 * rows + 3) * cols * batch_size,
+                              4 * (rows * cols + (rows + 3 * cols) * batch_size));
+            std::span<float> new_delta = workspace.nextDelta(cols);
+            Gemm::multiply(1.0f, ConstMatrixView(layer.weights().data(), rows, cols), Transpose::Yes,
+                           ConstMatrixView(delta.data(), rows, batch_size), Transpose::No, 0.0f,
+                           MatrixView(new_delta.data(), cols, batch_size));
+            kernels.activation(m_layers[i - 1].getActivation())
+                .multiplyDerivative(new_delta.data(), workspace.activation(i - 1).data(), new_delta.data(),
+                                    new_delta.size());
+        }
+
+        // 2. Hand the layer's delta and A_prev^T (simply the input matrix for the first layer) to
+        //    the caller, which either applies or records the update
+        ConstMatrixView prev_t = (i == 0) ? ConstMatrixView(inputs, batch_size, cols)
+                                          : ConstMatrixView(workspace.activation(i - 1).data(), cols, batch_size);
+        update(static_cast<size_t>(i), ConstMatrixView(delta.data(), rows, batch_size), prev_t,
+               (i == 0) ? Transpose::No : Transpose::Yes);
+
+        if (i > 0) {
+            workspace.swapDeltas();
+            delta = workspace.delta(cols);
+        }
+    }
 }
 
 void NeuralNetwork::printVector(const std::string& msg, const std::vector<float>& data) const {
@@ -145,26 +454,36 @@ float NeuralNetwork::dSigmoid(float x) const {
     return x * (1 - x);
 }
 
-std::vector<float> NeuralNetwork::feedForward(Layer& layer_a, std::vector<float>& input, uint32_t input_rows,
-                                              uint32_t input_cols) {
-    // dot product
-    auto dotMatrix =
-        Matrix::dotMatrix(layer_a.getWeights(), layer_a.getRows(), layer_a.getCols(), input, input_rows, input_cols);
-    if (dotMatrix.empty()) {
-        printf("Error: dotMatrix returned empty matrix.\n");
+std::vector<float> NeuralNetwork::feedForward(const Layer& layer_a, const std::vector<float>& input,
+                                              uint32_t input_rows, uint32_t input_cols) const {
+    if (input_rows != layer_a.getCols() || input.size() != static_cast<size_t>(input_rows) * input_cols) {
+        printf("Error: feedForward expects %u input rows but got %u.\n", layer_a.getCols(), input_rows);
         return {};
     }
-    // add biases
-    auto biasedMatrix = Matrix::add(dotMatrix, layer_a.getBiases());
-    if (biasedMatrix.empty()) {
-        printf("Error: add returned empty matrix.\n");
-        return {};
+
+    // A single column is one fused pass: dot product, bias and activation per neuron
+    const ActivationKernels& kernels = Kernels::active().activation(layer_a.getActivation());
+    std::vector<float>       output(static_cast<size_t>(layer_a.getRows()) * input_cols);
+    if (input_cols == 1) {
+        kernels.dense(layer_a.getWeights().data(), input.data(), layer_a.getBiases().data(), nullptr, output.data(),
+                      layer_a.getRows(), layer_a.getCols());
+        return output;
     }
-    // activation function
-    for (auto& value : biasedMatrix) {
-        value = sigmoid(value);
+
+    // Several columns: broadcast the biases so the product accumulates onto them, then activate
+    // in place
+    std::span<const float> biases = layer_a.getBiases();
+    for (size_t j = 0; j < layer_a.getRows(); ++j) {
+        std::fill_n(&output[j * input_cols], input_cols, biases[j]);
     }
-    return biasedMatrix;
+    if (!Gemm::multiply(1.0f, ConstMatrixView(layer_a.getWeights().data(), layer_a.getRows(), layer_a.getCols()),
+                        Transpose::No, ConstMatrixView(input.data(), input_rows, input_cols), Transpose::No, 1.0f,
+                        MatrixView(output.data(), layer_a.getRows(), input_cols))) {
+        printf("Error: dotMatrix returned empty matrix.\n");
+        return {};
+    }
+    kernels.activate(output.data(), output.data(), output.size());
+    return output;
 }
 
 bool NeuralNetwork::applyDelta(const std::vector<float>& delta, Layer& layer) {
@@ -181,19 +500,10 @@ std::vector<float> NeuralNetwork::calculateGradient(const std::vector<float>& ou
         return {};
     }
 
-    if (output_error.size() != layer_output.size()) {
-        printf("Error: mismatched sizes in calculateGradient: %zu and %zu.\n",
-               output_error.size(), layer_output.size());
-        return {};
-    }
-
-    // Calculate element-wise product of error and derivative of sigmoid
-    std::vector<float> gradient(output_error.size());
-    for (size_t i = 0; i < output_error.size(); i++) {
-        gradient[i] = output_error[i] * dSigmoid(layer_output[i]);
-    }
-
-    return gradient;
+    // Element-wise product of error and derivative of sigmoid, in one pass
+    using expression::values;
+    return expression::toVector(values(output_error) *
+                                expression::map(values(layer_output), [this](float y) { return dSigmoid(y); }));
 }
 
 std::vector<float> NeuralNetwork::calculateDelta(const std::vector<float>& gradient, const Layer& layer) {
@@ -202,24 +512,52 @@ std::vector<float> NeuralNetwork::calculateDelta(const std::vector<float>& gradi
 }
 
 std::vector<float> NeuralNetwork::predict(const std::vector<float>& input) const {
-    std::vector<float> output = input;  // Start with the input
-    uint32_t output_rows = input.size();
-    uint32_t output_cols = 1;
+    // Convenience wrapper; concurrent and latency-sensitive callers should keep a Workspace per
+    // thread and use the overload below instead of paying for one per call
+    Workspace          workspace(m_layers);
+    std::vector<float> output(m_layers.back().getRows());
+    if (!predict(input, output, workspace))
+        return {};
+    return output;
+}
 
-    // Iterate through all layers, feeding forward
+bool NeuralNetwork::predict(std::span<const float> input, std::span<float> output, Workspace& workspace) const {
+    if (input.size() != m_layers.front().getCols() || output.size() != m_layers.back().getRows()) {
+        printf("Error: predict expects %u inputs and %u outputs but got %zu and %zu.\n", m_layers.front().getCols(),
+               m_layers.back().getRows(), input.size(), output.size());
+        return false;
+    }
+
+    // Only the caller's workspace is written, so any number of threads can predict at once as
+    // long as each brings its own
+    workspace.reserve(1);
+    const KernelTable& kernels = Kernels::active();
+    const float*       x = input.data();
     for (size_t i = 0; i < m_layers.size(); ++i) {
-        // Need to use const_cast since feedForward is not const
-        Layer& layer = const_cast<Layer&>(m_layers[i]);
+        const Layer& layer = m_layers[i];
+        float*       a = (i + 1 == m_layers.size()) ? output.data() : workspace.activation(i).data();
+        kernels.activation(layer.getActivation())
+            .dense(layer.weights().data(), x, layer.biases().data(), nullptr, a, layer.getRows(), layer.getCols());
+        x = a;
+    }
+    return true;
+}
+
+bool NeuralNetwork::predictBatch(const float* inputs, uint32_t batch_size, float* outputs,
+                                 Workspace& workspace) const {
+    // One GEMM per layer streams each weight matrix once for the whole batch
+    if (batch_size == 0 || !forwardBatch(inputs, batch_size, workspace))
+        return false;
 
-        output = const_cast<NeuralNetwork*>(this)->feedForward(layer, output, output_rows, output_cols);
-        if (output.empty()) {
-            printf("Error: predict feedForward returned empty output for layer %zu.\n", i);
-            return {};
+    // The last activation is neuron-major; hand it back one sample per row like the inputs
+    const size_t           output_size = m_layers.back().getRows();
+    std::span<const float> result = workspace.activation(m_layers.size() - 1);
+    for (size_t n = 0; n < batch_size; ++n) {
+        for (size_t j = 0; j < output_size; ++j) {
+            outputs[n * output_size + j] = result[j * batch_size + n];
         }
-        output_rows = m_layers[i].getRows();
     }
-
-    return output;
+    return true;
 }
 
 } // namespace nnlcpp
@@ -0,0 +1,24 @@
+#include "optimizer.hpp"
+
+namespace nnlcpp {
+
+namespace {
+
+constexpr const char* NAMES[OPTIMIZER_COUNT] = {"sgd", "momentum", "nesterov", "rmsprop", "adam"};
+
+} // namespace
+
+const char* optimizerName(Optimizer optimizer) {
+    size_t index = static_cast<size_t>(optimizer);
+    return (index < OPTIMIZER_COUNT) ? NAMES[index] : "unknown";
+}
+
+std::optional<Optimizer> parseOptimizer(const std::string& name) {
+    for (size_t i = 0; i < OPTIMIZER_COUNT; ++i) {
+        if (name == NAMES[i])
+            return static_cast<Optimizer>(i);
+    }
+    return std::nullopt;
+}
+
+} // namespace nnlcpp
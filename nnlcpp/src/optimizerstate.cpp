@@ -0,0 +1,49 @@
+#include "optimizerstate.hpp"
+
+#include <algorithm>
+#include <stdio.h>
+
+namespace nnlcpp {
+
+OptimizerState::OptimizerState(const std::vector<uint32_t>& topology, const OptimizerSettings& settings)
+      : m_settings(settings) {
+    switch (settings.type) {
+    case Optimizer::Adam:
+        m_second = ParameterArena(topology);
+        [[fallthrough]];
+    case Optimizer::Momentum:
+    case Optimizer::Nesterov:
+    case Optimizer::RmsProp:
+        m_first = ParameterArena(topology);
+        break;
+    default:
+        break;
+    }
+}
+
+OptimizerStep OptimizerState::beginStep(float learning_rate) {
+    return OptimizerStep::make(m_settings, learning_rate, ++m_steps);
+}
+
+void OptimizerState::reset() {
+    if (m_first.data())
+        m_first.zero();
+    if (m_second.data())
+        m_second.zero();
+    m_steps = 0;
+}
+
+bool OptimizerState::restore(const float* first, const float* second, uint64_t steps) {
+    if ((m_first.data() != nullptr) != (first != nullptr) || (m_second.data() != nullptr) != (second != nullptr)) {
+        printf("Error: Saved state does not match the %s optimizer.\n", optimizerName(m_settings.type));
+        return false;
+    }
+    if (first)
+        std::copy_n(first, m_first.size(), m_first.data());
+    if (second)
+        std::copy_n(second, m_second.size(), m_second.data());
+    m_steps = steps;
+    return true;
+}
+
+} // namespace nnlcpp
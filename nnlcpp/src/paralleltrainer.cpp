@@ -0,0 +1,77 @@
+#include "paralleltrainer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <stdio.h>
+
+namespace nnlcpp {
+
+ParallelTrainer::ParallelTrainer(NeuralNetwork& network, uint32_t threads, Mode mode)
+      : m_network(network),
+        m_pool(std::max<uint32_t>(threads, 1)),
+        m_mode(mode) {
+    for (size_t i = 0; i < m_pool.getThreadCount(); ++i) {
+        m_workspaces.emplace_back(network.getLayers());
+        if (mode == Mode::Synchronous) {
+            m_gradients.emplace_back(network.getLayers());
+        }
+    }
+}
+
+bool ParallelTrainer::trainBatch(const std::vector<float>& inputs, const std::vector<float>& expected_outputs,
+                                 uint32_t batch_size) {
+    const size_t input_size = m_network.getLayers().front().getCols();
+    const size_t output_size = m_network.getLayers().back().getRows();
+    if (batch_size == 0 || inputs.size() != batch_size * input_size ||
+        expected_outputs.size() != batch_size * output_size) {
+        printf("Error: trainBatch expects %u x %zu inputs and %u x %zu outputs but got %zu and %zu values.\n",
+               batch_size, input_size, batch_size, output_size, inputs.size(), expected_outputs.size());
+        return false;
+    }
+
+    // Shard boundaries depend only on the batch and thread count, never on scheduling, so the
+    // reduction below always sums the same partial results in the same order
+    const size_t      shards = std::min<size_t>(m_pool.getThreadCount(), batch_size);
+    std::atomic<bool> ok{true};
+    m_pool.parallelFor(shards, [&](size_t shard, size_t worker) {
+        size_t       begin = shard * batch_size / shards;
+        size_t       end = (shard + 1) * batch_size / shards;
+        const float* shard_inputs = inputs.data() + begin * input_size;
+        const float* shard_outputs = expected_outputs.data() + begin * output_size;
+        uint32_t     count = static_cast<uint32_t>(end - begin);
+        Workspace&   workspace = m_workspaces[worker];
+
+        bool shard_ok = (m_mode == Mode::Hogwild)
+                            ? m_network.trainBatch(shard_inputs, shard_outputs, count, workspace)
+                            : m_network.computeGradients(shard_inputs, shard_outputs, count, workspace,
+                                                         m_gradients[shard]);
+        if (!shard_ok)
+            ok.store(false, std::memory_order_relaxed);
+    });
+    if (!ok.load())
+        return false;
+
+    if (m_mode == Mode::Hogwild)
+        return true;
+
+    if (!reduceGradients(shards))
+        return false;
+    return m_network.applyGradients(m_gradients[0], 1.0f / static_cast<float>(batch_size));
+}
+
+bool ParallelTrainer::reduceGradients(size_t shards) {
+    // Pairwise tree: at each level slot i absorbs slot i + stride, halving the live slots. Pairs
+    // within a level are independent, so each level runs in parallel.
+    std::atomic<bool> ok{true};
+    for (size_t stride = 1; stride < shards; stride *= 2) {
+        size_t pairs = (shards - stride + 2 * stride - 1) / (2 * stride);
+        m_pool.parallelFor(pairs, [&](size_t pair, size_t) {
+            size_t target = pair * 2 * stride;
+            if (!m_gradients[target].add(m_gradients[target + stride]))
+                ok.store(false, std::memory_order_relaxed);
+        });
+    }
+    return ok.load();
+}
+
+} // namespace nnlcpp
@@ -0,0 +1,101 @@
+#include "parameterarena.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <stdio.h>
+
+namespace nnlcpp {
+
+namespace {
+
+constexpr size_t FLOATS_PER_LINE = ParameterArena::ALIGNMENT / sizeof(float);
+
+size_t alignUp(size_t floats) {
+    return (floats + FLOATS_PER_LINE - 1) / FLOATS_PER_LINE * FLOATS_PER_LINE;
+}
+
+std::shared_ptr<float> allocateAligned(size_t floats) {
+    // Always hand out at least one cache line so data() is never null
+    size_t bytes = std::max(floats, FLOATS_PER_LINE) * sizeof(float);
+    auto*  data = static_cast<float*>(::operator new(bytes, std::align_val_t(ParameterArena::ALIGNMENT)));
+    std::memset(data, 0, bytes);
+    return std::shared_ptr<float>(data, [](float* ptr) {
+        ::operator delete(ptr, std::align_val_t(ParameterArena::ALIGNMENT));
+    });
+}
+
+} // namespace
+
+ParameterArena::ParameterArena(const std::vector<uint32_t>& topology) : m_topology(topology) {
+    computeLayout();
+    std::shared_ptr<float> block = allocateAligned(m_size);
+    m_data = block.get();
+    m_backing = std::move(block);
+    m_owned = true;
+}
+
+ParameterArena ParameterArena::view(const std::vector<uint32_t>& topology, float* data,
+                                    std::shared_ptr<const void> backing) {
+    ParameterArena arena;
+    arena.m_topology = topology;
+    arena.computeLayout();
+    arena.m_data = data;
+    arena.m_backing = std::move(backing);
+    return arena;
+}
+
+ParameterArena::ParameterArena(const ParameterArena& other)
+      : m_topology(other.m_topology),
+        m_slices(other.m_slices),
+        m_size(other.m_size) {
+    if (other.m_data == nullptr)
+        return;
+    std::shared_ptr<float> block = allocateAligned(m_size);
+    std::memcpy(block.get(), other.m_data, m_size * sizeof(float));
+    m_data = block.get();
+    m_backing = std::move(block);
+    m_owned = true;
+}
+
+ParameterArena& ParameterArena::operator=(const ParameterArena& other) {
+    if (this != &other) {
+        *this = ParameterArena(other);
+    }
+    return *this;
+}
+
+void ParameterArena::computeLayout() {
+    m_slices.clear();
+    size_t offset = 0;
+    for (size_t i = 0; i + 1 < m_topology.size(); ++i) {
+        Slice slice;
+        slice.rows = m_topology[i + 1];
+        slice.cols = m_topology[i];
+        slice.weights = offset;
+        offset = alignUp(offset + static_cast<size_t>(slice.rows) * slice.cols);
+        slice.biases = offset;
+        offset = alignUp(offset + slice.rows);
+        m_slices.push_back(slice);
+    }
+    m_size = offset;
+}
+
+size_t ParameterArena::bytesFor(const std::vector<uint32_t>& topology) {
+    return view(topology, nullptr, nullptr).size() * sizeof(float);
+}
+
+void ParameterArena::zero() {
+    std::fill_n(m_data, m_size, 0.0f);
+}
+
+bool ParameterArena::copyFrom(const ParameterArena& other) {
+    if (!sameLayout(other)) {
+        printf("Error: Cannot copy parameters between arenas of different topologies.\n");
+        return false;
+    }
+    std::memcpy(m_data, other.m_data, m_size * sizeof(float));
+    return true;
+}
+
+} // namespace nnlcpp
@@ -0,0 +1,211 @@
+#include "profiler.hpp"
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+
+namespace nnlcpp {
+
+namespace {
+
+constexpr size_t PHASE_COUNT = static_cast<size_t>(ProfilePhase::Count);
+// Cap on timeline events per thread so a long run can't exhaust memory (about 24 MB)
+constexpr size_t MAX_TRACE_EVENTS = 1 << 20;
+
+struct TraceEvent {
+    uint64_t     start;
+    uint64_t     end;
+    uint32_t     layer;
+    ProfilePhase phase;
+};
+
+struct ThreadLog {
+    uint32_t                        id;
+    std::vector<Profiler::Counters> counters; // layer * PHASE_COUNT + phase
+    std::vector<TraceEvent>         events;
+    uint64_t                        dropped = 0;
+};
+
+std::mutex                              g_mutex;
+std::vector<std::shared_ptr<ThreadLog>> g_logs; // Outlive their threads so reports see every worker
+bool                                    g_trace = false;
+uint64_t                                g_origin = 0;
+thread_local std::shared_ptr<ThreadLog> t_log;
+
+ThreadLog& threadLog() {
+    if (!t_log) {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        t_log = std::make_shared<ThreadLog>();
+        t_log->id = static_cast<uint32_t>(g_logs.size());
+        g_logs.push_back(t_log);
+    }
+    return *t_log;
+}
+
+} // namespace
+
+void Profiler::start(bool trace) {
+    // Only called between training runs, so no thread is recording into the logs being reset
+    std::lock_guard<std::mutex> lock(g_mutex);
+    for (auto& log : g_logs) {
+        log->counters.clear();
+        log->events.clear();
+        log->dropped = 0;
+    }
+    g_trace = trace;
+    g_origin = now();
+    s_active.store(true, std::memory_order_relaxed);
+}
+
+void Profiler::stop() {
+    s_active.store(false, std::memory_order_relaxed);
+}
+
+uint64_t Profiler::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+void Profiler::record(ProfilePhase phase, uint32_t layer, uint64_t start, uint64_t end, uint64_t flops,
+                      uint64_t bytes, uint64_t allocations) {
+    ThreadLog& log = threadLog();
+    size_t     index = layer * PHASE_COUNT + static_cast<size_t>(phase);
+    if (index >= log.counters.size()) {
+        log.counters.resize((layer + 1) * PHASE_COUNT);
+    }
+
+    Counters& counters = log.counters[index];
+    ++counters.calls;
+    counters.nanoseconds += end - start;
+    counters.flops += flops;
+    counters.bytes += bytes;
+    counters.allocations += allocations;
+
+    if (g_trace) {
+        if (log.events.size() < MAX_TRACE_EVENTS) {
+            log.events.push_back({start, end, layer, phase});
+        } else {
+            ++log.dropped;
+        }
+    }
+}
+
+const char* Profiler::phaseName(ProfilePhase phase) {
+    switch (phase) {
+    case ProfilePhase::Forward:
+        return "forward";
+    case ProfilePhase::BiasActivation:
+        return "bias+activation";
+    case ProfilePhase::OutputError:
+        return "output error";
+    case ProfilePhase::DeltaPropagation:
+        return "delta propagation";
+    case ProfilePhase::WeightUpdate:
+        return "weight update";
+    case ProfilePhase::BiasUpdate:
+        return "bias update";
+    default:
+        return "unknown";
+    }
+}
+
+std::vector<std::vector<Profiler::Counters>> Profiler::collect() {
+    std::lock_guard<std::mutex>        lock(g_mutex);
+    std::vector<std::vector<Counters>> merged;
+    for (const auto& log : g_logs) {
+        size_t layers = log->counters.size() / PHASE_COUNT;
+        if (merged.size() < layers) {
+            merged.resize(layers, std::vector<Counters>(PHASE_COUNT));
+        }
+        for (size_t i = 0; i < log->counters.size(); ++i) {
+            const Counters& from = log->counters[i];
+            Counters&       to = merged[i / PHASE_COUNT][i % PHASE_COUNT];
+            to.calls += from.calls;
+            to.nanoseconds += from.nanoseconds;
+            to.flops += from.flops;
+            to.bytes += from.bytes;
+            to.allocations += from.allocations;
+        }
+    }
+    return merged;
+}
+
+void Profiler::printReport(FILE* file) {
+    std::vector<std::vector<Counters>> layers = collect();
+    std::vector<Counters>              totals(PHASE_COUNT);
+    uint64_t                           total_ns = 0;
+    for (const auto& phases : layers) {
+        for (size_t p = 0; p < PHASE_COUNT; ++p) {
+            total_ns += phases[p].nanoseconds;
+            totals[p].calls += phases[p].calls;
+            totals[p].nanoseconds += phases[p].nanoseconds;
+            totals[p].flops += phases[p].flops;
+            totals[p].bytes += phases[p].bytes;
+            totals[p].allocations += phases[p].allocations;
+        }
+    }
+    if (total_ns == 0) {
+        fprintf(file, "\nProfile: nothing was recorded.\n");
+        return;
+    }
+
+    auto printRow = [&](const char* layer, size_t phase, const Counters& c) {
+        if (c.calls == 0)
+            return;
+        double ns = static_cast<double>(c.nanoseconds);
+        fprintf(file, "%-6s %-18s %10llu %11.3f %6.1f%% %11.1f %9.2f %9.2f %8.2f\n", layer,
+                phaseName(static_cast<ProfilePhase>(phase)), static_cast<unsigned long long>(c.calls), ns / 1e6,
+                100.0 * ns / total_ns, ns / c.calls, ns > 0 ? c.flops / ns : 0.0, ns > 0 ? c.bytes / ns : 0.0,
+                static_cast<double>(c.allocations) / c.calls);
+    };
+
+    fprintf(file, "\nProfile (%.3f ms in profiled phases):\n", total_ns / 1e6);
+    fprintf(file, "%-6s %-18s %10s %11s %7s %11s %9s %9s %8s\n", "Layer", "Phase", "Calls", "Total ms", "Share",
+            "ns/call", "GFLOP/s", "GB/s", "Allocs");
+    for (size_t i = 0; i < layers.size(); ++i) {
+        std::string name = std::to_string(i);
+        for (size_t p = 0; p < PHASE_COUNT; ++p) {
+            printRow(name.c_str(), p, layers[i][p]);
+        }
+    }
+    for (size_t p = 0; p < PHASE_COUNT; ++p) {
+        printRow("all", p, totals[p]);
+    }
+}
+
+bool Profiler::writeTrace(const std::string& path) {
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        printf("Error: Cannot open %s for writing.\n", path.c_str());
+        return false;
+    }
+
+    // Complete ("X") events with microsecond timestamps relative to Profiler::start
+    std::lock_guard<std::mutex> lock(g_mutex);
+    uint64_t                    dropped = 0;
+    bool                        first = true;
+    fprintf(file, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n");
+    for (const auto& log : g_logs) {
+        dropped += log->dropped;
+        for (const TraceEvent& event : log->events) {
+            fprintf(file, "%s{\"name\": \"%s\", \"cat\": \"layer %u\", \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, "
+                          "\"pid\": 1, \"tid\": %u, \"args\": {\"layer\": %u}}",
+                    first ? "" : ",\n", phaseName(event.phase), event.layer, (event.start - g_origin) / 1e3,
+                    (event.end - event.start) / 1e3, log->id, event.layer);
+            first = false;
+        }
+    }
+    fprintf(file, "\n]}\n");
+
+    bool ok = fclose(file) == 0;
+    if (!ok) {
+        printf("Error: Failed to write trace file %s.\n", path.c_str());
+    }
+    if (dropped > 0) {
+        printf("Warning: %llu trace events beyond the per-thread limit were dropped.\n",
+               static_cast<unsigned long long>(dropped));
+    }
+    return ok;
+}
+
+} // namespace nnlcpp
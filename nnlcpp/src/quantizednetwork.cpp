@@ -0,0 +1,145 @@
+#include "quantizednetwork.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdio.h>
+
+#include "kernels.hpp"
+
+namespace nnlcpp {
+
+namespace {
+
+constexpr float INT8_LIMIT = 127.0f;
+
+float maxMagnitude(std::span<const float> values) {
+    float max = 0.0f;
+    for (float value : values) {
+        max = std::max(max, std::fabs(value));
+    }
+    return max;
+}
+
+// Quantize values into out with a shared symmetric scale and return that scale. All-zero input
+// gets scale zero, which dequantizes everything back to zero.
+float quantizeSymmetric(std::span<const float> values, int8_t* out) {
+    float max = maxMagnitude(values);
+    if (max == 0.0f) {
+        std::fill_n(out, values.size(), int8_t{0});
+        return 0.0f;
+    }
+    float inverse = INT8_LIMIT / max;
+    for (size_t i = 0; i < values.size(); ++i) {
+        float q = std::nearbyint(values[i] * inverse);
+        out[i] = static_cast<int8_t>(std::clamp(q, -INT8_LIMIT, INT8_LIMIT));
+    }
+    return max / INT8_LIMIT;
+}
+
+} // namespace
+
+QuantizedNetwork QuantizedNetwork::quantize(const NeuralNetwork& network) {
+    QuantizedNetwork result;
+    for (const Layer& layer : network.getLayers()) {
+        QuantizedLayer quantized;
+        quantized.rows = layer.getRows();
+        quantized.cols = layer.getCols();
+        quantized.weights.resize(static_cast<size_t>(quantized.rows) * quantized.cols);
+        quantized.scales.resize(quantized.rows);
+        quantized.biases.assign(layer.getBiases().begin(), layer.getBiases().end());
+        quantized.activation = layer.getActivation();
+
+        std::span<const float> weights = layer.getWeights();
+        for (uint32_t j = 0; j < quantized.rows; ++j) {
+            size_t offset = static_cast<size_t>(j) * quantized.cols;
+            quantized.scales[j] =
+                quantizeSymmetric(weights.subspan(offset, quantized.cols), quantized.weights.data() + offset);
+        }
+        result.m_layers.push_back(std::move(quantized));
+    }
+    return result;
+}
+
+std::vector<uint32_t> QuantizedNetwork::getTopology() const {
+    std::vector<uint32_t> topology;
+    if (m_layers.empty())
+        return topology;
+    topology.push_back(m_layers.front().cols);
+    for (const QuantizedLayer& layer : m_layers) {
+        topology.push_back(layer.rows);
+    }
+    return topology;
+}
+
+size_t QuantizedNetwork::getBytes() const {
+    size_t bytes = 0;
+    for (const QuantizedLayer& layer : m_layers) {
+        bytes += layer.weights.size() * sizeof(int8_t);
+        bytes += (layer.scales.size() + layer.biases.size()) * sizeof(float);
+    }
+    return bytes;
+}
+
+size_t QuantizedNetwork::floatBytesFor(const std::vector<uint32_t>& topology) {
+    size_t floats = 0;
+    for (size_t i = 0; i + 1 < topology.size(); ++i) {
+        floats += static_cast<size_t>(topology[i + 1]) * topology[i] + topology[i + 1];
+    }
+    return floats * sizeof(float);
+}
+
+QuantizedNetwork::Scratch QuantizedNetwork::makeScratch() const {
+    uint32_t widest = 0;
+    for (const QuantizedLayer& layer : m_layers) {
+        widest = std::max({widest, layer.rows, layer.cols});
+    }
+    Scratch scratch;
+    scratch.input.resize(widest);
+    scratch.sums.resize(widest);
+    scratch.current.resize(widest);
+    scratch.next.resize(widest);
+    return scratch;
+}
+
+std::vector<float> QuantizedNetwork::predict(const std::vector<float>& input) const {
+    if (m_layers.empty()) {
+        printf("Error: Cannot predict with an empty quantized network.\n");
+        return {};
+    }
+    std::vector<float> output(m_layers.back().rows);
+    Scratch            scratch = makeScratch();
+    if (!predict(input, output, scratch))
+        return {};
+    return output;
+}
+
+bool QuantizedNetwork::predict(std::span<const float> input, std::span<float> output, Scratch& scratch) const {
+    if (m_layers.empty() || input.size() != m_layers.front().cols || output.size() != m_layers.back().rows) {
+        printf("Error: Quantized predict got %zu inputs and room for %zu outputs, which does not match the "
+               "network.\n",
+               input.size(), output.size());
+        return false;
+    }
+
+    const KernelTable& kernels = Kernels::active();
+    std::span<const float> x = input;
+    for (size_t i = 0; i < m_layers.size(); ++i) {
+        const QuantizedLayer& layer = m_layers[i];
+        float                 input_scale = quantizeSymmetric(x, scratch.input.data());
+        kernels.gemvInt8(layer.weights.data(), scratch.input.data(), scratch.sums.data(), layer.rows, layer.cols);
+
+        // Dequantize and add the bias, then activate, straight into output for the last layer
+        float* z = scratch.next.data();
+        for (uint32_t j = 0; j < layer.rows; ++j) {
+            z[j] = static_cast<float>(scratch.sums[j]) * (layer.scales[j] * input_scale) + layer.biases[j];
+        }
+        float* a = (i + 1 == m_layers.size()) ? output.data() : z;
+        kernels.activation(layer.activation).activate(z, a, layer.rows);
+
+        scratch.current.swap(scratch.next);
+        x = {scratch.current.data(), layer.rows};
+    }
+    return true;
+}
+
+} // namespace nnlcpp
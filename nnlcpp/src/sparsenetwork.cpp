@@ -0,0 +1,400 @@
+#include "sparsenetwork.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdio.h>
+
+#include "gemm.hpp"
+#include "kernels.hpp"
+
+namespace nnlcpp {
+
+namespace {
+
+// Clear count more entries of the masks, the smallest surviving weights by magnitude. Ties at
+// the threshold are cleared in order until the count is reached, so the result is exact.
+void clearSmallest(const std::vector<const std::vector<float>*>& weights,
+                   const std::vector<std::vector<uint8_t>*>& masks, size_t count) {
+    std::vector<float> magnitudes;
+    for (size_t l = 0; l < weights.size(); ++l) {
+        for (size_t k = 0; k < weights[l]->size(); ++k) {
+            if ((*masks[l])[k])
+                magnitudes.push_back(std::fabs((*weights[l])[k]));
+        }
+    }
+    count = std::min(count, magnitudes.size());
+    if (count == 0)
+        return;
+
+    std::nth_element(magnitudes.begin(), magnitudes.begin() + (count - 1), magnitudes.end());
+    float  threshold = magnitudes[count - 1];
+    size_t below = static_cast<size_t>(
+        std::count_if(magnitudes.begin(), magnitudes.end(), [threshold](float m) { return m < threshold; }));
+    size_t ties = count - below;
+    for (size_t l = 0; l < weights.size(); ++l) {
+        for (size_t k = 0; k < weights[l]->size(); ++k) {
+            uint8_t& keep = (*masks[l])[k];
+            float    magnitude = std::fabs((*weights[l])[k]);
+            if (keep && (magnitude < threshold || (magnitude == threshold && ties > 0))) {
+                ties -= (magnitude == threshold);
+                keep = 0;
+            }
+        }
+    }
+}
+
+// Row r of a CSR matrix times a dense vector. Four running sums break the dependency on the add
+// latency, which otherwise limits the gather loop to one nonzero every few cycles.
+float sparseDot(const CsrMatrix& csr, uint32_t r, const float* x) {
+    const uint32_t* columns = csr.columns.data();
+    const float*    values = csr.values.data();
+    uint32_t        k = csr.row_starts[r];
+    const uint32_t  end = csr.row_starts[r + 1];
+    float           sums[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    for (; k + 4 <= end; k += 4) {
+        sums[0] += values[k] * x[columns[k]];
+        sums[1] += values[k + 1] * x[columns[k + 1]];
+        sums[2] += values[k + 2] * x[columns[k + 2]];
+        sums[3] += values[k + 3] * x[columns[k + 3]];
+    }
+    for (; k < end; ++k) {
+        sums[0] += values[k] * x[columns[k]];
+    }
+    return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+}
+
+size_t countSet(const std::vector<uint8_t>& mask) {
+    return static_cast<size_t>(std::count(mask.begin(), mask.end(), uint8_t{1}));
+}
+
+} // namespace
+
+CsrMatrix CsrMatrix::fromDense(const float* weights, const std::vector<uint8_t>& mask, uint32_t rows, uint32_t cols) {
+    CsrMatrix csr;
+    csr.rows = rows;
+    csr.cols = cols;
+    csr.row_starts.reserve(rows + 1);
+    csr.row_starts.push_back(0);
+    for (uint32_t r = 0; r < rows; ++r) {
+        for (uint32_t c = 0; c < cols; ++c) {
+            size_t k = static_cast<size_t>(r) * cols + c;
+            if (mask[k]) {
+                csr.columns.push_back(c);
+                csr.values.push_back(weights[k]);
+            }
+        }
+        csr.row_starts.push_back(static_cast<uint32_t>(csr.values.size()));
+    }
+    return csr;
+}
+
+SparseNetwork SparseNetwork::prune(const NeuralNetwork& network, float sparsity, bool global) {
+    SparseNetwork result;
+    for (const Layer& layer : network.getLayers()) {
+        SparseLayer sparse;
+        sparse.rows = layer.getRows();
+        sparse.cols = layer.getCols();
+        sparse.sparse_single = false;
+        sparse.sparse_batched = false;
+        sparse.dense.assign(layer.getWeights().begin(), layer.getWeights().end());
+        sparse.mask.assign(sparse.dense.size(), 1);
+        sparse.biases.assign(layer.getBiases().begin(), layer.getBiases().end());
+        sparse.activation = layer.getActivation();
+        result.m_layers.push_back(std::move(sparse));
+    }
+    result.prune(sparsity, global);
+    return result;
+}
+
+void SparseNetwork::prune(float sparsity, bool global) {
+    // Work on dense copies of the weights and masks, then store each layer afresh
+    std::vector<std::vector<float>>   weights(m_layers.size());
+    std::vector<std::vector<uint8_t>> masks(m_layers.size());
+    for (size_t i = 0; i < m_layers.size(); ++i) {
+        SparseLayer& layer = m_layers[i];
+        if (!layer.hasCsr()) {
+            weights[i] = std::move(layer.dense);
+            masks[i] = std::move(layer.mask);
+            continue;
+        }
+        weights[i].assign(static_cast<size_t>(layer.rows) * layer.cols, 0.0f);
+        masks[i].assign(weights[i].size(), 0);
+        for (uint32_t r = 0; r < layer.rows; ++r) {
+            for (uint32_t k = layer.csr.row_starts[r]; k < layer.csr.row_starts[r + 1]; ++k) {
+                size_t index = static_cast<size_t>(r) * layer.cols + layer.csr.columns[k];
+                weights[i][index] = layer.csr.values[k];
+                masks[i][index] = 1;
+            }
+        }
+    }
+
+    // Remove whatever it takes to bring the whole network, or each layer, to the target
+    sparsity = std::clamp(sparsity, 0.0f, 1.0f);
+    auto removeUpTo = [&](size_t first, size_t last) {
+        std::vector<const std::vector<float>*> layer_weights;
+        std::vector<std::vector<uint8_t>*>     layer_masks;
+        size_t                                 total = 0;
+        size_t                                 survivors = 0;
+        for (size_t i = first; i < last; ++i) {
+            layer_weights.push_back(&weights[i]);
+            layer_masks.push_back(&masks[i]);
+            total += masks[i].size();
+            survivors += countSet(masks[i]);
+        }
+        size_t target = static_cast<size_t>(std::llround(static_cast<double>(sparsity) * static_cast<double>(total)));
+        size_t removed = total - survivors;
+        if (target > removed)
+            clearSmallest(layer_weights, layer_masks, target - removed);
+    };
+    if (global) {
+        removeUpTo(0, m_layers.size());
+    } else {
+        for (size_t i = 0; i < m_layers.size(); ++i) {
+            removeUpTo(i, i + 1);
+        }
+    }
+
+    for (size_t i = 0; i < m_layers.size(); ++i) {
+        SparseLayer& layer = m_layers[i];
+        float        density = static_cast<float>(countSet(masks[i])) / static_cast<float>(masks[i].size());
+        layer.sparse_single = density <= SINGLE_DENSITY_LIMIT;
+        layer.sparse_batched = density <= BATCH_DENSITY_LIMIT;
+        for (size_t k = 0; k < weights[i].size(); ++k) {
+            weights[i][k] = masks[i][k] ? weights[i][k] : 0.0f;
+        }
+        layer.csr = layer.hasCsr() ? CsrMatrix::fromDense(weights[i].data(), masks[i], layer.rows, layer.cols)
+                                   : CsrMatrix{};
+        layer.dense = layer.sparse_single ? std::vector<float>{} : std::move(weights[i]);
+        layer.mask = layer.hasCsr() ? std::vector<uint8_t>{} : std::move(masks[i]);
+    }
+}
+
+bool SparseNetwork::writeTo(NeuralNetwork& network) const {
+    std::vector<uint32_t> topology = network.getTopology();
+    if (topology.size() != m_layers.size() + 1) {
+        printf("Error: Cannot write a %zu-layer sparse network into %zu layers.\n", m_layers.size(),
+               topology.size() - 1);
+        return false;
+    }
+    ParameterArena parameters(topology);
+    for (size_t i = 0; i < m_layers.size(); ++i) {
+        const SparseLayer& layer = m_layers[i];
+        std::span<float>   weights = parameters.weights(i);
+        if (weights.size() != static_cast<size_t>(layer.rows) * layer.cols) {
+            printf("Error: Layer %zu is %ux%u in the sparse network but not in the target.\n", i, layer.rows,
+                   layer.cols);
+            return false;
+        }
+        if (layer.dense.empty()) {
+            for (uint32_t r = 0; r < layer.rows; ++r) {
+                for (uint32_t k = layer.csr.row_starts[r]; k < layer.csr.row_starts[r + 1]; ++k) {
+                    weights[static_cast<size_t>(r) * layer.cols + layer.csr.columns[k]] = layer.csr.values[k];
+                }
+            }
+        } else {
+            std::copy(layer.dense.begin(), layer.dense.end(), weights.begin());
+        }
+        std::copy(layer.biases.begin(), layer.biases.end(), parameters.biases(i).begin());
+    }
+    return network.setParameters(parameters);
+}
+
+std::vector<SparseNetwork::LayerInfo> SparseNetwork::getLayerInfo() const {
+    std::vector<LayerInfo> info;
+    for (const SparseLayer& layer : m_layers) {
+        info.push_back({layer.rows, layer.cols, layer.hasCsr() ? layer.csr.nonZeros() : countSet(layer.mask),
+                        layer.sparse_single, layer.sparse_batched});
+    }
+    return info;
+}
+
+float SparseNetwork::getSparsity() const {
+    size_t total = 0;
+    size_t non_zeros = 0;
+    for (const LayerInfo& layer : getLayerInfo()) {
+        total += static_cast<size_t>(layer.rows) * layer.cols;
+        non_zeros += layer.non_zeros;
+    }
+    return total ? 1.0f - static_cast<float>(non_zeros) / static_cast<float>(total) : 0.0f;
+}
+
+size_t SparseNetwork::getBytes() const {
+    size_t bytes = 0;
+    for (const SparseLayer& layer : m_layers) {
+        bytes += (layer.biases.size() + layer.dense.size() + layer.csr.values.size()) * sizeof(float);
+        bytes += (layer.csr.columns.size() + layer.csr.row_starts.size()) * sizeof(uint32_t);
+    }
+    return bytes;
+}
+
+SparseNetwork::Scratch SparseNetwork::makeScratch(uint32_t batch_size) const {
+    Scratch scratch;
+    scratch.batch_size = std::max<uint32_t>(batch_size, 1);
+    uint32_t widest = 0;
+    for (const SparseLayer& layer : m_layers) {
+        scratch.activations.emplace_back(static_cast<size_t>(layer.rows) * scratch.batch_size);
+        widest = std::max({widest, layer.rows, layer.cols});
+    }
+    if (!m_layers.empty())
+        scratch.inputs.resize(static_cast<size_t>(m_layers.front().cols) * scratch.batch_size);
+    scratch.delta.resize(widest);
+    scratch.next_delta.resize(widest);
+    return scratch;
+}
+
+void SparseNetwork::forward(size_t i, const float* x, float* y, uint32_t batch_size) const {
+    const SparseLayer&       layer = m_layers[i];
+    const ActivationKernels& activation = Kernels::active().activation(layer.activation);
+
+    if (batch_size == 1) {
+        if (layer.sparse_single) {
+            for (uint32_t r = 0; r < layer.rows; ++r) {
+                y[r] = layer.biases[r] + sparseDot(layer.csr, r, x);
+            }
+            activation.activate(y, y, layer.rows);
+        } else {
+            activation.dense(layer.dense.data(), x, layer.biases.data(), nullptr, y, layer.rows, layer.cols);
+        }
+        return;
+    }
+
+    // Start from the biases and accumulate the weighted input onto them
+    for (uint32_t r = 0; r < layer.rows; ++r) {
+        std::fill_n(y + static_cast<size_t>(r) * batch_size, batch_size, layer.biases[r]);
+    }
+    if (layer.sparse_batched) {
+        // Each stored weight scales one input row into its output row, batch_size lanes wide
+        for (uint32_t r = 0; r < layer.rows; ++r) {
+            float* out = y + static_cast<size_t>(r) * batch_size;
+            for (uint32_t k = layer.csr.row_starts[r]; k < layer.csr.row_starts[r + 1]; ++k) {
+                const float  w = layer.csr.values[k];
+                const float* in = x + static_cast<size_t>(layer.csr.columns[k]) * batch_size;
+                for (uint32_t n = 0; n < batch_size; ++n) {
+                    out[n] += w * in[n];
+                }
+            }
+        }
+    } else {
+        Gemm::multiply(1.0f, ConstMatrixView(layer.dense.data(), layer.rows, layer.cols), Transpose::No,
+                       ConstMatrixView(x, layer.cols, batch_size), Transpose::No, 1.0f,
+                       MatrixView(y, layer.rows, batch_size));
+    }
+    activation.activate(y, y, static_cast<size_t>(layer.rows) * batch_size);
+}
+
+bool SparseNetwork::predict(std::span<const float> input, std::span<float> output, Scratch& scratch) const {
+    if (m_layers.empty() || input.size() != m_layers.front().cols || output.size() != m_layers.back().rows ||
+        scratch.activations.size() != m_layers.size()) {
+        printf("Error: Sparse predict got %zu inputs and room for %zu outputs, which does not match the network.\n",
+               input.size(), output.size());
+        return false;
+    }
+    const float* x = input.data();
+    for (size_t i = 0; i < m_layers.size(); ++i) {
+        float* y = (i + 1 == m_layers.size()) ? output.data() : scratch.activations[i].data();
+        forward(i, x, y, 1);
+        x = y;
+    }
+    return true;
+}
+
+bool SparseNetwork::predictBatch(const float* inputs, uint32_t batch_size, float* outputs, Scratch& scratch) const {
+    if (m_layers.empty() || batch_size == 0 || batch_size > scratch.batch_size ||
+        scratch.activations.size() != m_layers.size()) {
+        printf("Error: Sparse predictBatch got %u samples for scratch sized for %u.\n", batch_size,
+               scratch.batch_size);
+        return false;
+    }
+
+    // Samples become columns, so every layer runs over contiguous batch-wide rows
+    const uint32_t input_size = m_layers.front().cols;
+    for (uint32_t n = 0; n < batch_size; ++n) {
+        for (uint32_t k = 0; k < input_size; ++k) {
+            scratch.inputs[static_cast<size_t>(k) * batch_size + n] = inputs[static_cast<size_t>(n) * input_size + k];
+        }
+    }
+    const float* x = scratch.inputs.data();
+    for (size_t i = 0; i < m_layers.size(); ++i) {
+        forward(i, x, scratch.activations[i].data(), batch_size);
+        x = scratch.activations[i].data();
+    }
+
+    const uint32_t output_size = m_layers.back().rows;
+    for (uint32_t n = 0; n < batch_size; ++n) {
+        for (uint32_t k = 0; k < output_size; ++k) {
+            outputs[static_cast<size_t>(n) * output_size + k] = x[static_cast<size_t>(k) * batch_size + n];
+        }
+    }
+    return true;
+}
+
+bool SparseNetwork::train(std::span<const float> input, std::span<const float> expected, float learning_rate,
+                          Scratch& scratch) {
+    if (m_layers.empty() || input.size() != m_layers.front().cols || expected.size() != m_layers.back().rows ||
+        scratch.activations.size() != m_layers.size()) {
+        printf("Error: Sparse train got %zu inputs and %zu outputs, which does not match the network.\n",
+               input.size(), expected.size());
+        return false;
+    }
+    const KernelTable& kernels = Kernels::active();
+
+    const float* x = input.data();
+    for (size_t i = 0; i < m_layers.size(); ++i) {
+        forward(i, x, scratch.activations[i].data(), 1);
+        x = scratch.activations[i].data();
+    }
+
+    float* delta = scratch.delta.data();
+    kernels.subtract(expected.data(), x, delta, expected.size());
+    kernels.activation(m_layers.back().activation).multiplyDerivative(delta, x, delta, expected.size());
+
+    for (size_t i = m_layers.size(); i-- > 0;) {
+        SparseLayer& layer = m_layers[i];
+        const float* prev = (i > 0) ? scratch.activations[i - 1].data() : input.data();
+        float*       next_delta = scratch.next_delta.data();
+
+        // Propagate through the weights before they change, then update only the stored ones
+        if (layer.hasCsr()) {
+            // A dense copy kept for single samples mirrors every stored value
+            float* mirror = layer.dense.empty() ? nullptr : layer.dense.data();
+            if (i > 0)
+                std::fill_n(next_delta, layer.cols, 0.0f);
+            for (uint32_t r = 0; r < layer.rows; ++r) {
+                const float scaled = learning_rate * delta[r];
+                for (uint32_t k = layer.csr.row_starts[r]; k < layer.csr.row_starts[r + 1]; ++k) {
+                    uint32_t c = layer.csr.columns[k];
+                    if (i > 0)
+                        next_delta[c] += layer.csr.values[k] * delta[r];
+                    layer.csr.values[k] += scaled * prev[c];
+                    if (mirror)
+                        mirror[static_cast<size_t>(r) * layer.cols + c] = layer.csr.values[k];
+                }
+            }
+        } else {
+            if (i > 0) {
+                Gemm::multiplyVector(1.0f, ConstMatrixView(layer.dense.data(), layer.rows, layer.cols),
+                                     Transpose::Yes, delta, 0.0f, next_delta);
+            }
+            for (uint32_t r = 0; r < layer.rows; ++r) {
+                float*         row = layer.dense.data() + static_cast<size_t>(r) * layer.cols;
+                const uint8_t* keep = layer.mask.data() + static_cast<size_t>(r) * layer.cols;
+                const float    scaled = learning_rate * delta[r];
+                for (uint32_t c = 0; c < layer.cols; ++c) {
+                    row[c] += keep[c] ? scaled * prev[c] : 0.0f;
+                }
+            }
+        }
+        for (uint32_t r = 0; r < layer.rows; ++r) {
+            layer.biases[r] += learning_rate * delta[r];
+        }
+
+        if (i > 0) {
+            kernels.activation(m_layers[i - 1].activation).multiplyDerivative(next_delta, prev, next_delta, layer.cols);
+            std::swap(scratch.delta, scratch.next_delta);
+            delta = scratch.delta.data();
+        }
+    }
+    return true;
+}
+
+} // namespace nnlcpp
@@ -0,0 +1,375 @@
+#include "sweep.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <stdio.h>
+
+#include "earlystopping.hpp"
+#include "neuralnetwork.hpp"
+#include "workstealingpool.hpp"
+
+namespace nnlcpp {
+
+namespace {
+
+std::vector<std::string> split(const std::string& text, char separator) {
+    std::vector<std::string> parts;
+    size_t                   start = 0;
+    while (true) {
+        size_t end = text.find(separator, start);
+        parts.push_back(text.substr(start, end == std::string::npos ? end : end - start));
+        if (end == std::string::npos)
+            return parts;
+        start = end + 1;
+    }
+}
+
+bool parseUnsigned(const std::string& text, uint64_t& value) {
+    char* end = nullptr;
+    value = std::strtoull(text.c_str(), &end, 10);
+    return !text.empty() && *end == '\0';
+}
+
+bool parsePositive(const std::string& text, float& value) {
+    char* end = nullptr;
+    value = std::strtof(text.c_str(), &end);
+    return !text.empty() && *end == '\0' && value > 0.0f;
+}
+
+// Parse one "key=a|b|c" entry into space
+bool parseKey(const std::string& key, const std::vector<std::string>& values, SweepSpace& space) {
+    for (const std::string& value : values) {
+        if (key == "layers") {
+            std::vector<uint32_t> layers;
+            for (const std::string& size : split(value, ',')) {
+                uint64_t neurons;
+                if (!parseUnsigned(size, neurons) || neurons == 0)
+                    return false;
+                layers.push_back(static_cast<uint32_t>(neurons));
+            }
+            if (layers.size() < 2)
+                return false;
+            space.layers.push_back(layers);
+        } else if (key == "lr") {
+            size_t range = value.find('~');
+            if (range != std::string::npos) {
+                float low, high;
+                if (!parsePositive(value.substr(0, range), low) || !parsePositive(value.substr(range + 1), high) ||
+                    low > high)
+                    return false;
+                space.learning_rate_range = std::make_pair(low, high);
+            } else {
+                float rate;
+                if (!parsePositive(value, rate))
+                    return false;
+                space.learning_rates.push_back(rate);
+            }
+        } else if (key == "seed") {
+            size_t   range = value.find('-');
+            uint64_t first, last;
+            if (range == std::string::npos) {
+                if (!parseUnsigned(value, first))
+                    return false;
+                last = first;
+            } else if (!parseUnsigned(value.substr(0, range), first) ||
+                       !parseUnsigned(value.substr(range + 1), last) || first > last) {
+                return false;
+            }
+            for (uint64_t seed = first; seed <= last; ++seed) {
+                space.seeds.push_back(seed);
+            }
+        } else if (key == "optimizer") {
+            std::optional<Optimizer> optimizer = parseOptimizer(value);
+            if (!optimizer)
+                return false;
+            space.optimizers.push_back(*optimizer);
+        } else if (key == "activation") {
+            std::optional<Activation> activation = parseActivation(value);
+            if (!activation)
+                return false;
+            space.activations.push_back(*activation);
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// One configuration's network and training state, carried from round to round
+struct Run {
+    SweepResult           result;
+    NeuralNetwork         network;
+    Workspace             workspace;
+    std::mt19937_64       rng; // Shuffles this run's sample order, independently of every other run
+    std::vector<uint32_t> order;
+    bool                  active = true;
+
+    Run(const SweepConfig& config, const SweepSettings& settings, size_t samples)
+          : network(config.layers, config.learning_rate, config.seed),
+            rng(config.seed),
+            order(samples) {
+        result.config = config;
+        network.setActivations(std::vector<Activation>(config.layers.size() - 1, config.activation));
+        OptimizerSettings optimizer;
+        optimizer.type = config.optimizer;
+        network.setOptimizer(optimizer);
+        workspace = Workspace(network.getLayers(), settings.batch_size);
+        std::iota(order.begin(), order.end(), 0u);
+    }
+};
+
+// Loss and accuracy over every sample, scored in blocks
+LossTally score(Run& run, const SweepData& data) {
+    const uint32_t     block = 256;
+    std::vector<float> outputs(static_cast<size_t>(block) * data.output_size);
+    LossTally          tally;
+    for (size_t start = 0; start < data.samples; start += block) {
+        uint32_t count = static_cast<uint32_t>(std::min<size_t>(block, data.samples - start));
+        if (!run.network.predictBatch(&data.inputs[start * data.input_size], count, outputs.data(), run.workspace))
+            break;
+        tally.add(outputs.data(), &data.outputs[start * data.output_size], static_cast<size_t>(count) * data.output_size);
+    }
+    return tally;
+}
+
+// Train one run up to epochs in total, reshuffling every epoch, then score it
+void advance(Run& run, const SweepData& data, const SweepSettings& settings, uint32_t epochs) {
+    auto               start = std::chrono::steady_clock::now();
+    std::vector<float> input(data.input_size);
+    std::vector<float> output(data.output_size);
+    std::vector<float> batch_inputs(static_cast<size_t>(settings.batch_size) * data.input_size);
+    std::vector<float> batch_outputs(static_cast<size_t>(settings.batch_size) * data.output_size);
+
+    for (; run.result.epochs < epochs && !run.result.converged; ++run.result.epochs) {
+        std::shuffle(run.order.begin(), run.order.end(), run.rng);
+        for (size_t first = 0; first < data.samples; first += settings.batch_size) {
+            uint32_t count = static_cast<uint32_t>(std::min<size_t>(settings.batch_size, data.samples - first));
+            if (count == 1) {
+                size_t sample = run.order[first];
+                std::copy_n(&data.inputs[sample * data.input_size], data.input_size, input.begin());
+                std::copy_n(&data.outputs[sample * data.output_size], data.output_size, output.begin());
+                run.network.train(input, output);
+                continue;
+            }
+            for (uint32_t n = 0; n < count; ++n) {
+                size_t sample = run.order[first + n];
+                std::copy_n(&data.inputs[sample * data.input_size], data.input_size,
+                            &batch_inputs[n * data.input_size]);
+                std::copy_n(&data.outputs[sample * data.output_size], data.output_size,
+                            &batch_outputs[n * data.output_size]);
+            }
+            run.network.trainBatch(batch_inputs.data(), batch_outputs.data(), count, run.workspace);
+        }
+        if (settings.target_loss > 0.0 && score(run, data).loss() <= settings.target_loss) {
+            run.result.converged = true;
+        }
+    }
+
+    LossTally tally = score(run, data);
+    run.result.loss = tally.loss();
+    run.result.accuracy = tally.accuracy();
+    ++run.result.rounds;
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    run.result.seconds += elapsed.count();
+}
+
+// Whether loss a ranks ahead of b. A diverged run's NaN or infinite loss ranks behind every finite one,
+// which also keeps the comparison a strict weak ordering for sorting
+bool lowerLoss(double a, double b) {
+    if (!std::isfinite(a))
+        return false;
+    return !std::isfinite(b) || a < b;
+}
+
+} // namespace
+
+std::optional<SweepSpace> SweepSpace::parse(const std::string& spec, const SweepConfig& defaults) {
+    SweepSpace space;
+    for (const std::string& entry : split(spec, ';')) {
+        if (entry.empty())
+            continue;
+        size_t equals = entry.find('=');
+        if (equals == std::string::npos ||
+            !parseKey(entry.substr(0, equals), split(entry.substr(equals + 1), '|'), space)) {
+            printf("Error: Cannot parse sweep entry '%s'.\n", entry.c_str());
+            return std::nullopt;
+        }
+    }
+
+    if (space.layers.empty())
+        space.layers.push_back(defaults.layers);
+    if (space.learning_rates.empty() && !space.learning_rate_range)
+        space.learning_rates.push_back(defaults.learning_rate);
+    if (space.seeds.empty())
+        space.seeds.push_back(defaults.seed);
+    if (space.optimizers.empty())
+        space.optimizers.push_back(defaults.optimizer);
+    if (space.activations.empty())
+        space.activations.push_back(defaults.activation);
+    return space;
+}
+
+std::optional<std::vector<SweepConfig>> SweepSpace::grid() const {
+    if (learning_rate_range) {
+        printf("Error: A learning rate range needs random search (--sweep-samples).\n");
+        return std::nullopt;
+    }
+
+    std::vector<SweepConfig> configs;
+    for (const auto& topology : layers) {
+        for (Activation activation : activations) {
+            for (Optimizer optimizer : optimizers) {
+                for (float learning_rate : learning_rates) {
+                    for (uint64_t seed : seeds) {
+                        configs.push_back({topology, learning_rate, seed, optimizer, activation});
+                    }
+                }
+            }
+        }
+    }
+    return configs;
+}
+
+std::vector<SweepConfig> SweepSpace::sample(size_t count, uint64_t seed) const {
+    std::mt19937_64 rng(seed);
+    auto            pick = [&](const auto& values) {
+        return values[std::uniform_int_distribution<size_t>(0, values.size() - 1)(rng)];
+    };
+
+    std::vector<SweepConfig> configs;
+    for (size_t i = 0; i < count; ++i) {
+        SweepConfig config;
+        config.layers = pick(layers);
+        config.activation = pick(activations);
+        config.optimizer = pick(optimizers);
+        if (learning_rate_range) {
+            std::uniform_real_distribution<double> exponent(std::log(learning_rate_range->first),
+                                                            std::log(learning_rate_range->second));
+            config.learning_rate = static_cast<float>(std::exp(exponent(rng)));
+        } else {
+            config.learning_rate = pick(learning_rates);
+        }
+        config.seed = pick(seeds);
+        configs.push_back(config);
+    }
+    return configs;
+}
+
+SweepData SweepData::load(Dataset& dataset) {
+    const size_t block = 4096;
+    SweepData    data;
+    data.input_size = dataset.getInputSize();
+    data.output_size = dataset.getOutputSize();
+
+    dataset.rewind();
+    while (true) {
+        data.inputs.resize((data.samples + block) * data.input_size);
+        data.outputs.resize((data.samples + block) * data.output_size);
+        size_t count = dataset.read(&data.inputs[data.samples * data.input_size],
+                                    &data.outputs[data.samples * data.output_size], block);
+        data.samples += count;
+        if (count < block)
+            break;
+    }
+    data.inputs.resize(data.samples * data.input_size);
+    data.outputs.resize(data.samples * data.output_size);
+    dataset.rewind();
+    return data;
+}
+
+std::vector<SweepResult> Sweep::run(const std::vector<SweepConfig>& configs, const SweepData& data,
+                                    const SweepSettings& settings) {
+    std::vector<std::unique_ptr<Run>> runs;
+    for (const SweepConfig& config : configs) {
+        if (config.layers.front() != data.input_size || config.layers.back() != data.output_size) {
+            printf("Error: Sweep topology %u->...->%u does not match the data's %u inputs and %u outputs.\n",
+                   config.layers.front(), config.layers.back(), data.input_size, data.output_size);
+            return {};
+        }
+        runs.push_back(std::make_unique<Run>(config, settings, data.samples));
+    }
+    if (runs.empty() || data.samples == 0)
+        return {};
+
+    // Rounds until halving leaves a single survivor; round k trains everyone still in up to
+    // epochs / halving^(rounds - 1 - k) epochs in total
+    uint32_t rounds = 1;
+    if (settings.halving >= 2) {
+        for (size_t left = runs.size(); left > 1; left = (left + settings.halving - 1) / settings.halving) {
+            ++rounds;
+        }
+    }
+
+    WorkStealingPool pool(settings.threads);
+    for (uint32_t round = 0; round < rounds; ++round) {
+        double   share = std::pow(static_cast<double>(settings.halving), static_cast<double>(rounds - 1 - round));
+        uint32_t epochs = std::max<uint32_t>(1, static_cast<uint32_t>(settings.epochs / share));
+
+        std::vector<Run*> active;
+        for (auto& run : runs) {
+            if (run->active)
+                active.push_back(run.get());
+        }
+
+        // Largest networks first, so the pool ends on short tasks that balance out by stealing
+        std::stable_sort(active.begin(), active.end(), [](const Run* a, const Run* b) {
+            return a->network.getParameters().size() > b->network.getParameters().size();
+        });
+        for (Run* run : active) {
+            pool.submit([run, &data, &settings, epochs](size_t) { advance(*run, data, settings, epochs); });
+        }
+        pool.wait();
+
+        printf("Sweep round %u of %u: %zu configurations trained to %u epochs\n", round + 1, rounds, active.size(),
+               epochs);
+        if (round + 1 == rounds)
+            break;
+
+        // Keep the best 1/halving by loss
+        std::stable_sort(active.begin(), active.end(),
+                         [](const Run* a, const Run* b) { return lowerLoss(a->result.loss, b->result.loss); });
+        size_t keep = (active.size() + settings.halving - 1) / settings.halving;
+        for (size_t i = keep; i < active.size(); ++i) {
+            active[i]->active = false;
+        }
+    }
+
+    std::vector<SweepResult> results;
+    for (auto& run : runs) {
+        run->result.survived = run->active;
+        results.push_back(run->result);
+    }
+    std::stable_sort(results.begin(), results.end(), [](const SweepResult& a, const SweepResult& b) {
+        if (a.rounds != b.rounds)
+            return a.rounds > b.rounds;
+        return lowerLoss(a.loss, b.loss);
+    });
+    return results;
+}
+
+void Sweep::printTable(const std::vector<SweepResult>& results) {
+    printf("\n%4s  %-16s %-12s %-9s %10s %6s %7s %10s %9s %9s  %s\n", "Rank", "Layers", "Activation", "Optimizer",
+           "LR", "Seed", "Epochs", "Loss", "Accuracy", "Time (s)", "Status");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const SweepResult& result = results[i];
+        std::string        layers;
+        for (size_t j = 0; j < result.config.layers.size(); ++j) {
+            layers += (j ? "," : "") + std::to_string(result.config.layers[j]);
+        }
+        std::string status = !std::isfinite(result.loss) ? "diverged"
+                             : !result.survived         ? "cut after round " + std::to_string(result.rounds)
+                             : result.converged         ? "converged"
+                                                        : "finished";
+        printf("%4zu  %-16s %-12s %-9s %10.5f %6llu %7u %10.6f %8.2f%% %9.3f  %s\n", i + 1, layers.c_str(),
+               activationName(result.config.activation), optimizerName(result.config.optimizer),
+               result.config.learning_rate, static_cast<unsigned long long>(result.config.seed), result.epochs,
+               result.loss, 100.0 * result.accuracy, result.seconds, status.c_str());
+    }
+}
+
+} // namespace nnlcpp
@@ -0,0 +1,73 @@
+#include "threadpool.hpp"
+
+namespace nnlcpp {
+
+ThreadPool::ThreadPool(size_t threads) {
+    for (size_t i = 1; i < threads; ++i) {
+        m_threads.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_start.notify_all();
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::parallelFor(size_t task_count, const Job& job) {
+    if (m_threads.empty() || task_count <= 1) {
+        for (size_t task = 0; task < task_count; ++task) {
+            job(task, 0);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job = &job;
+        m_task_count = task_count;
+        m_next_task.store(0, std::memory_order_relaxed);
+        m_busy = m_threads.size();
+        ++m_generation;
+    }
+    m_start.notify_all();
+
+    drain(0);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this] { return m_busy == 0; });
+    m_job = nullptr;
+}
+
+void ThreadPool::workerLoop(size_t worker) {
+    size_t seen_generation = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_start.wait(lock, [&] { return m_stop || m_generation != seen_generation; });
+            if (m_stop)
+                return;
+            seen_generation = m_generation;
+        }
+
+        drain(worker);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (--m_busy == 0)
+            m_done.notify_one();
+    }
+}
+
+void ThreadPool::drain(size_t worker) {
+    size_t task;
+    while ((task = m_next_task.fetch_add(1, std::memory_order_relaxed)) < m_task_count) {
+        (*m_job)(task, worker);
+    }
+}
+
+} // namespace nnlcpp
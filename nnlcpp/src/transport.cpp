@@ -0,0 +1,290 @@
+#include "transport.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <new>
+#include <poll.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace nnlcpp {
+
+namespace {
+
+constexpr const char* NAMES[TRANSPORT_COUNT] = {"socket", "shm"};
+
+// Yields before an idle shared memory transport falls back to sleeping in poll
+constexpr uint32_t SPIN_LIMIT = 100;
+
+bool linkLost(uint32_t rank, uint32_t neighbour) {
+    printf("Error: Rank %u lost its link to rank %u.\n", rank, neighbour);
+    return false;
+}
+
+bool wouldBlock() {
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+}
+
+void closeIfOpen(int fd) {
+    if (fd >= 0)
+        close(fd);
+}
+
+} // namespace
+
+const char* transportName(TransportKind kind) {
+    size_t index = static_cast<size_t>(kind);
+    return (index < TRANSPORT_COUNT) ? NAMES[index] : "unknown";
+}
+
+std::optional<TransportKind> parseTransport(const std::string& name) {
+    for (size_t i = 0; i < TRANSPORT_COUNT; ++i) {
+        if (name == NAMES[i])
+            return static_cast<TransportKind>(i);
+    }
+    return std::nullopt;
+}
+
+SocketTransport::SocketTransport(uint32_t rank, uint32_t ranks, int next, int previous)
+      : m_rank(rank),
+        m_ranks(ranks),
+        m_next(next),
+        m_previous(previous) {
+    for (int fd : {m_next, m_previous}) {
+        if (fd >= 0)
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+}
+
+SocketTransport::~SocketTransport() {
+    closeIfOpen(m_next);
+    closeIfOpen(m_previous);
+}
+
+bool SocketTransport::exchange(const void* send, size_t send_bytes, void* receive, size_t receive_bytes) {
+    const char* out = static_cast<const char*>(send);
+    char*       in = static_cast<char*>(receive);
+    size_t      sent = 0;
+    size_t      received = 0;
+    while (sent < send_bytes || received < receive_bytes) {
+        // Move whatever the socket buffers take right now, and only wait when neither side can
+        bool progress = false;
+        if (sent < send_bytes) {
+            ssize_t count = ::send(m_next, out + sent, send_bytes - sent, MSG_NOSIGNAL);
+            if (count > 0) {
+                sent += static_cast<size_t>(count);
+                progress = true;
+            } else if (count < 0 && !wouldBlock()) {
+                return linkLost(m_rank, (m_rank + 1) % m_ranks);
+            }
+        }
+        if (received < receive_bytes) {
+            ssize_t count = recv(m_previous, in + received, receive_bytes - received, 0);
+            if (count > 0) {
+                received += static_cast<size_t>(count);
+                progress = true;
+            } else if (count == 0 || !wouldBlock()) {
+                return linkLost(m_rank, (m_rank + m_ranks - 1) % m_ranks);
+            }
+        }
+        if (progress)
+            continue;
+
+        // Finished directions are left out, as a closed peer would otherwise wake poll for ever
+        pollfd waiting[2] = {{sent < send_bytes ? m_next : -1, POLLOUT, 0},
+                             {received < receive_bytes ? m_previous : -1, POLLIN, 0}};
+        if (poll(waiting, 2, -1) < 0 && errno != EINTR) {
+            printf("Error: Rank %u cannot wait for its neighbours: %s\n", m_rank, std::strerror(errno));
+            return false;
+        }
+    }
+    return true;
+}
+
+// written and read only ever grow; their difference is the number of bytes in flight, and each
+// is stored by one side only, so the ring needs no lock
+struct SharedMemoryTransport::Channel {
+    alignas(64) std::atomic<uint64_t> written{0}; // Stored by the sending rank
+    alignas(64) std::atomic<uint64_t> read{0};    // Stored by the receiving rank
+    alignas(64) char data[CHANNEL_BYTES];
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Shared memory channels need lock-free atomics");
+
+std::shared_ptr<SharedMemoryTransport::Channel> SharedMemoryTransport::createChannels(uint32_t ranks) {
+    size_t bytes = sizeof(Channel) * ranks;
+    void*  memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        printf("Error: Cannot map %zu bytes of shared memory: %s\n", bytes, std::strerror(errno));
+        return nullptr;
+    }
+    Channel* channels = static_cast<Channel*>(memory);
+    for (uint32_t i = 0; i < ranks; ++i) {
+        new (&channels[i]) Channel;
+    }
+    return std::shared_ptr<Channel>(channels, [bytes](Channel* mapped) { munmap(mapped, bytes); });
+}
+
+SharedMemoryTransport::SharedMemoryTransport(uint32_t rank, uint32_t ranks, std::shared_ptr<Channel> channels,
+                                             int next, int previous)
+      : m_rank(rank),
+        m_ranks(ranks),
+        m_channels(std::move(channels)),
+        m_outgoing(m_channels.get() + rank),
+        m_incoming(m_channels.get() + (rank + ranks - 1) % ranks),
+        m_next(next),
+        m_previous(previous) {}
+
+SharedMemoryTransport::~SharedMemoryTransport() {
+    closeIfOpen(m_next);
+    closeIfOpen(m_previous);
+}
+
+bool SharedMemoryTransport::exchange(const void* send, size_t send_bytes, void* receive, size_t receive_bytes) {
+    const char* out = static_cast<const char*>(send);
+    char*       in = static_cast<char*>(receive);
+    size_t      sent = 0;
+    size_t      received = 0;
+    uint32_t    idle = 0;
+    while (sent < send_bytes || received < receive_bytes) {
+        bool progress = false;
+        if (sent < send_bytes) {
+            uint64_t head = m_outgoing->written.load(std::memory_order_relaxed);
+            uint64_t tail = m_outgoing->read.load(std::memory_order_acquire);
+            size_t   count = std::min<size_t>(send_bytes - sent, CHANNEL_BYTES - (head - tail));
+            if (count > 0) {
+                size_t offset = head % CHANNEL_BYTES;
+                size_t first = std::min(count, CHANNEL_BYTES - offset);
+                std::memcpy(m_outgoing->data + offset, out + sent, first);
+                std::memcpy(m_outgoing->data, out + sent + first, count - first);
+                m_outgoing->written.store(head + count, std::memory_order_release);
+                sent += count;
+                progress = true;
+            }
+        }
+        if (received < receive_bytes) {
+            uint64_t tail = m_incoming->read.load(std::memory_order_relaxed);
+            uint64_t head = m_incoming->written.load(std::memory_order_acquire);
+            size_t   count = std::min<size_t>(receive_bytes - received, head - tail);
+            if (count > 0) {
+                size_t offset = tail % CHANNEL_BYTES;
+                size_t first = std::min(count, CHANNEL_BYTES - offset);
+                std::memcpy(in + received, m_incoming->data + offset, first);
+                std::memcpy(in + received + first, m_incoming->data, count - first);
+                m_incoming->read.store(tail + count, std::memory_order_release);
+                received += count;
+                progress = true;
+            }
+        }
+        if (progress) {
+            idle = 0;
+            continue;
+        }
+        if (++idle < SPIN_LIMIT) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        // The liveness sockets never carry data, so any event on one means that rank has exited
+        pollfd neighbours[2] = {{sent < send_bytes ? m_next : -1, POLLIN, 0},
+                                {received < receive_bytes ? m_previous : -1, POLLIN, 0}};
+        if (poll(neighbours, 2, 1) > 0) {
+            return linkLost(m_rank, neighbours[0].revents ? (m_rank + 1) % m_ranks
+                                                          : (m_rank + m_ranks - 1) % m_ranks);
+        }
+    }
+    return true;
+}
+
+bool LocalCluster::run(uint32_t ranks, TransportKind kind, const Worker& worker) {
+    ranks = std::max<uint32_t>(ranks, 1);
+
+    // links[r] joins rank r (end 0) to rank r + 1 (end 1)
+    std::vector<std::array<int, 2>> links(ranks > 1 ? ranks : 0, {-1, -1});
+    auto                            closeLinks = [&](int keep_next, int keep_previous) {
+        for (auto& link : links) {
+            for (int fd : link) {
+                if (fd != keep_next && fd != keep_previous)
+                    closeIfOpen(fd);
+            }
+        }
+    };
+    for (auto& link : links) {
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, link.data()) != 0) {
+            printf("Error: Cannot connect %u ranks: %s\n", ranks, std::strerror(errno));
+            closeLinks(-1, -1);
+            return false;
+        }
+    }
+    std::shared_ptr<SharedMemoryTransport::Channel> channels;
+    if (kind == TransportKind::SharedMemory && ranks > 1) {
+        channels = SharedMemoryTransport::createChannels(ranks);
+        if (!channels) {
+            closeLinks(-1, -1);
+            return false;
+        }
+    }
+
+    // Each rank keeps only its own two ends, so when a rank exits its neighbours see the links close
+    auto makeTransport = [&](uint32_t rank) -> std::unique_ptr<Transport> {
+        int next = ranks > 1 ? links[rank][0] : -1;
+        int previous = ranks > 1 ? links[(rank + ranks - 1) % ranks][1] : -1;
+        closeLinks(next, previous);
+        if (kind == TransportKind::SharedMemory)
+            return std::make_unique<SharedMemoryTransport>(rank, ranks, channels, next, previous);
+        return std::make_unique<SocketTransport>(rank, ranks, next, previous);
+    };
+
+    // Anything still buffered would otherwise be printed once by every rank
+    fflush(stdout);
+    fflush(stderr);
+    std::vector<pid_t> workers;
+    for (uint32_t rank = 1; rank < ranks; ++rank) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            printf("Error: Cannot start rank %u: %s\n", rank, std::strerror(errno));
+            break;
+        }
+        if (pid == 0) {
+            bool ok;
+            {
+                std::unique_ptr<Transport> transport = makeTransport(rank);
+                ok = worker(*transport);
+            }
+            fflush(stdout);
+            _exit(ok ? 0 : 1);
+        }
+        workers.push_back(pid);
+    }
+
+    // Without a full ring, closing rank 0's ends makes the ranks already started fail and exit
+    bool ok = false;
+    if (workers.size() + 1 == ranks) {
+        std::unique_ptr<Transport> transport = makeTransport(0);
+        ok = worker(*transport);
+    } else {
+        closeLinks(-1, -1);
+    }
+
+    for (size_t i = 0; i < workers.size(); ++i) {
+        int status = 0;
+        while (waitpid(workers[i], &status, 0) < 0 && errno == EINTR) {
+        }
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            printf("Error: Rank %zu did not finish.\n", i + 1);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+} // namespace nnlcpp
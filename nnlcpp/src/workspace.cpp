@@ -0,0 +1,29 @@
+#include "workspace.hpp"
+
+#include <algorithm>
+
+namespace nnlcpp {
+
+Workspace::Workspace(const std::vector<Layer>& layers, uint32_t batch_size)
+      : m_activations(layers.size()) {
+    for (const auto& layer : layers) {
+        m_rows.push_back(layer.getRows());
+        m_max_rows = std::max(m_max_rows, layer.getRows());
+    }
+    reserve(batch_size);
+}
+
+void Workspace::reserve(uint32_t batch_size) {
+    m_batch_size = batch_size;
+    if (batch_size <= m_capacity)
+        return;
+
+    for (size_t i = 0; i < m_activations.size(); ++i) {
+        m_activations[i].resize(static_cast<size_t>(m_rows[i]) * batch_size);
+    }
+    m_delta.resize(static_cast<size_t>(m_max_rows) * batch_size);
+    m_next_delta.resize(static_cast<size_t>(m_max_rows) * batch_size);
+    m_capacity = batch_size;
+}
+
+} // namespace nnlcpp
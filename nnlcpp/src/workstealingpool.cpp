@@ -0,0 +1,99 @@
+#include "workstealingpool.hpp"
+
+namespace nnlcpp {
+
+WorkStealingPool::WorkStealingPool(size_t threads) : m_queues(threads > 0 ? threads : 1) {
+    for (size_t i = 1; i < m_queues.size(); ++i) {
+        m_threads.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::submit(Task task) {
+    Queue& queue = m_queues[m_next_queue.fetch_add(1, std::memory_order_relaxed) % m_queues.size()];
+    m_pending.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+        m_queued.fetch_add(1);
+    }
+    {
+        // A sleeper checks m_queued under m_mutex, so passing through it here means it either
+        // saw the new task or is already waiting for this notification
+        std::lock_guard<std::mutex> lock(m_mutex);
+    }
+    m_wake.notify_one();
+    m_idle.notify_one();
+}
+
+bool WorkStealingPool::takeTask(size_t worker, Task& task) {
+    {
+        Queue&                      own = m_queues[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            m_queued.fetch_sub(1);
+            return true;
+        }
+    }
+    for (size_t offset = 1; offset < m_queues.size(); ++offset) {
+        Queue&                      victim = m_queues[(worker + offset) % m_queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            m_queued.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::runTask(size_t worker, Task& task) {
+    task(worker);
+    task = nullptr;
+    if (m_pending.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_idle.notify_all();
+    }
+}
+
+void WorkStealingPool::workerLoop(size_t worker) {
+    Task task;
+    while (true) {
+        if (takeTask(worker, task)) {
+            runTask(worker, task);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wake.wait(lock, [this] { return m_stop || m_queued.load() > 0; });
+        if (m_stop)
+            return;
+    }
+}
+
+void WorkStealingPool::wait() {
+    Task task;
+    while (m_pending.load() > 0) {
+        if (takeTask(0, task)) {
+            runTask(0, task);
+            continue;
+        }
+        // Everything left is running on other workers; sleep until it finishes or spawns more
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_idle.wait(lock, [this] { return m_pending.load() == 0 || m_queued.load() > 0; });
+    }
+}
+
+} // namespace nnlcpp
@@ -0,0 +1,78 @@
+#include <cstdint>
+#include <span>
+#include <stdio.h>
+#include <vector>
+
+#include "allocations.hpp"
+#include "neuralnetwork.hpp"
+#include "optimizer.hpp"
+#include "workspace.hpp"
+
+// After a warm-up step has sized every buffer, training and inference must not touch the heap:
+// the allocation counter of this thread may not move over further steps.
+
+namespace {
+
+constexpr uint32_t BATCH = 16;
+constexpr uint32_t STEPS = 100;
+
+int g_failures = 0;
+
+template <typename Step>
+void expectNoAllocations(const char* name, Step&& step) {
+    for (int i = 0; i < 3; ++i) {
+        step();
+    }
+    uint64_t before = nnlcpp::Allocations::count();
+    for (uint32_t i = 0; i < STEPS; ++i) {
+        step();
+    }
+    uint64_t allocations = nnlcpp::Allocations::count() - before;
+    printf("%-40s %llu allocations in %u steps\n", name, static_cast<unsigned long long>(allocations), STEPS);
+    if (allocations != 0)
+        ++g_failures;
+}
+
+} // namespace
+
+int main() {
+    const std::vector<uint32_t> topology = {8, 32, 16, 4};
+    const size_t                input_size = topology.front();
+    const size_t                output_size = topology.back();
+
+    std::vector<float> inputs(BATCH * input_size);
+    std::vector<float> outputs(BATCH * output_size);
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        inputs[i] = static_cast<float>(i % 7) / 7.0f;
+    }
+    for (size_t i = 0; i < outputs.size(); ++i) {
+        outputs[i] = static_cast<float>(i % 2);
+    }
+    std::vector<float> input(inputs.begin(), inputs.begin() + input_size);
+    std::vector<float> expected(outputs.begin(), outputs.begin() + output_size);
+    std::vector<float> output(output_size);
+    std::vector<float> predictions(BATCH * output_size);
+
+    for (nnlcpp::Optimizer type : {nnlcpp::Optimizer::Sgd, nnlcpp::Optimizer::Adam}) {
+        nnlcpp::NeuralNetwork     nn(topology, 0.1f, 1);
+        nnlcpp::OptimizerSettings settings;
+        settings.type = type;
+        nn.setOptimizer(settings);
+        nnlcpp::Workspace workspace(nn.getLayers(), BATCH);
+        printf("%s:\n", nnlcpp::optimizerName(type));
+
+        expectNoAllocations("  train", [&] { nn.train(input, expected); });
+        expectNoAllocations("  trainBatch (vectors)", [&] { nn.trainBatch(inputs, outputs, BATCH); });
+        expectNoAllocations("  trainBatch (workspace)",
+                            [&] { nn.trainBatch(inputs.data(), outputs.data(), BATCH, workspace); });
+        expectNoAllocations("  predict (workspace)", [&] { nn.predict(input, output, workspace); });
+        expectNoAllocations("  predictBatch",
+                            [&] { nn.predictBatch(inputs.data(), BATCH, predictions.data(), workspace); });
+    }
+
+    if (g_failures) {
+        printf("FAILED: %d paths allocated after warm-up\n", g_failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include <atomic>
+#include <cstdint>
+#include <span>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+#include "neuralnetwork.hpp"
+#include "workspace.hpp"
+
+// Many threads predicting at once on one shared const network, each with its own workspace,
+// must get exactly the outputs a single thread gets: inference only reads the network.
+
+namespace {
+
+constexpr uint32_t THREADS = 8;
+constexpr uint32_t INPUTS = 64;
+constexpr uint32_t ROUNDS = 200; // Passes over every input per thread
+
+} // namespace
+
+int main() {
+    const nnlcpp::NeuralNetwork nn({16, 64, 32, 4}, 0.1f, 7);
+    const size_t                input_size = 16;
+    const size_t                output_size = 4;
+
+    std::vector<float> inputs(INPUTS * input_size);
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        inputs[i] = static_cast<float>((i * 37) % 101) / 101.0f;
+    }
+
+    // Single-threaded reference for every input
+    std::vector<float> reference(INPUTS * output_size);
+    {
+        nnlcpp::Workspace workspace(nn.getLayers());
+        for (uint32_t n = 0; n < INPUTS; ++n) {
+            if (!nn.predict({&inputs[n * input_size], input_size}, {&reference[n * output_size], output_size},
+                            workspace)) {
+                printf("FAILED: reference prediction %u\n", n);
+                return 1;
+            }
+        }
+    }
+
+    std::atomic<uint64_t>    mismatches{0};
+    std::atomic<uint32_t>    ready{0};
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&, t] {
+            nnlcpp::Workspace  workspace(nn.getLayers());
+            std::vector<float> output(output_size);
+            ready.fetch_add(1);
+            while (ready.load() < THREADS) {
+                std::this_thread::yield();
+            }
+            // Each thread walks the inputs from a different offset, so neighbours work on different samples
+            for (uint32_t round = 0; round < ROUNDS; ++round) {
+                for (uint32_t i = 0; i < INPUTS; ++i) {
+                    uint32_t n = (i + t * 7) % INPUTS;
+                    bool     ok = nn.predict({&inputs[n * input_size], input_size}, output, workspace);
+                    for (size_t j = 0; ok && j < output_size; ++j) {
+                        ok = output[j] == reference[n * output_size + j];
+                    }
+                    if (!ok)
+                        mismatches.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    uint64_t calls = static_cast<uint64_t>(THREADS) * ROUNDS * INPUTS;
+    printf("%llu predictions on %u threads, %llu differed from the reference\n",
+           static_cast<unsigned long long>(calls), THREADS, static_cast<unsigned long long>(mismatches.load()));
+    return mismatches.load() ? 1 : 0;
+}
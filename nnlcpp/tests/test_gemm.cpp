@@ -0,0 +1,178 @@
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <stdio.h>
+#include <vector>
+
+#include "gemm.hpp"
+
+// Gemm::multiply and Gemm::multiplyVector against a naive triple loop in double precision, over
+// every transpose combination, padded (non-unit) row strides, beta 0, 1 and other values, and
+// shapes on both sides of the small-problem cutoff that are not multiples of any tile size.
+
+namespace {
+
+using nnlcpp::ConstMatrixView;
+using nnlcpp::Gemm;
+using nnlcpp::MatrixView;
+using nnlcpp::Transpose;
+
+constexpr size_t PADDING = 3; // Extra floats at the end of every row of a padded operand
+
+struct Shape {
+    size_t m;
+    size_t n;
+    size_t k;
+};
+
+std::mt19937 g_rng(42);
+int          g_failures = 0;
+int          g_cases = 0;
+
+// rows x cols with the given stride, filled with values in [-1, 1]
+std::vector<float> randomMatrix(size_t rows, size_t stride) {
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+    std::vector<float>                    data(rows * stride);
+    for (auto& x : data) {
+        x = value(g_rng);
+    }
+    return data;
+}
+
+const char* name(Transpose trans) {
+    return trans == Transpose::Yes ? "T" : "N";
+}
+
+// Compare c with alpha * op(A) op(B) + beta * c0 element by element. The tolerance scales with
+// the magnitude of the terms summed, which bounds the float rounding of any summation order.
+bool matches(const char* what, float alpha, ConstMatrixView a, Transpose trans_a, ConstMatrixView b,
+             Transpose trans_b, float beta, const std::vector<float>& c0, ConstMatrixView c) {
+    ++g_cases;
+    for (size_t i = 0; i < c.rows; ++i) {
+        for (size_t j = 0; j < c.cols; ++j) {
+            size_t k_size = (trans_a == Transpose::Yes) ? a.rows : a.cols;
+            double sum = 0.0;
+            double magnitude = 0.0;
+            for (size_t k = 0; k < k_size; ++k) {
+                double x = (trans_a == Transpose::Yes) ? a(k, i) : a(i, k);
+                double y = (trans_b == Transpose::Yes) ? b(j, k) : b(k, j);
+                sum += x * y;
+                magnitude += std::fabs(x * y);
+            }
+            double expected = alpha * sum;
+            magnitude = std::fabs(alpha) * magnitude;
+            if (beta != 0.0f) {
+                expected += beta * c0[i * c.stride + j];
+                magnitude += std::fabs(beta * c0[i * c.stride + j]);
+            }
+            double error = std::fabs(c(i, j) - expected);
+            if (!(error <= 1e-5 * (1.0 + magnitude))) {
+                printf("FAIL %s: C(%zu, %zu) = %.7f, expected %.7f\n", what, i, j, c(i, j), expected);
+                ++g_failures;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void checkMultiply(Shape shape, Transpose trans_a, Transpose trans_b, float beta, bool padded) {
+    const float alpha = 0.75f;
+    size_t      a_rows = (trans_a == Transpose::Yes) ? shape.k : shape.m;
+    size_t      a_cols = (trans_a == Transpose::Yes) ? shape.m : shape.k;
+    size_t      b_rows = (trans_b == Transpose::Yes) ? shape.n : shape.k;
+    size_t      b_cols = (trans_b == Transpose::Yes) ? shape.k : shape.n;
+    size_t      pad = padded ? PADDING : 0;
+
+    std::vector<float> a = randomMatrix(a_rows, a_cols + pad);
+    std::vector<float> b = randomMatrix(b_rows, b_cols + pad);
+    std::vector<float> c = randomMatrix(shape.m, shape.n + pad);
+    if (beta == 0.0f) {
+        // C is output only, so whatever it held, even NaN, must not leak into the result
+        for (auto& x : c) {
+            x = NAN;
+        }
+    }
+    std::vector<float> c0 = c;
+
+    ConstMatrixView a_view(a.data(), a_rows, a_cols, a_cols + pad);
+    ConstMatrixView b_view(b.data(), b_rows, b_cols, b_cols + pad);
+    MatrixView      c_view(c.data(), shape.m, shape.n, shape.n + pad);
+    char            what[128];
+    snprintf(what, sizeof(what), "multiply %zux%zux%zu %s%s beta %g%s", shape.m, shape.n, shape.k, name(trans_a),
+             name(trans_b), beta, padded ? " padded" : "");
+    if (!Gemm::multiply(alpha, a_view, trans_a, b_view, trans_b, beta, c_view)) {
+        printf("FAIL %s: returned false\n", what);
+        ++g_failures;
+        return;
+    }
+    matches(what, alpha, a_view, trans_a, b_view, trans_b, beta, c0, c_view);
+}
+
+void checkMultiplyVector(size_t m, size_t k, Transpose trans_a, float beta, bool padded) {
+    const float alpha = -1.25f;
+    size_t      a_rows = (trans_a == Transpose::Yes) ? k : m;
+    size_t      a_cols = (trans_a == Transpose::Yes) ? m : k;
+    size_t      pad = padded ? PADDING : 0;
+
+    std::vector<float> a = randomMatrix(a_rows, a_cols + pad);
+    std::vector<float> x = randomMatrix(k, 1);
+    std::vector<float> y = randomMatrix(m, 1);
+    if (beta == 0.0f) {
+        for (auto& value : y) {
+            value = NAN;
+        }
+    }
+    std::vector<float> y0 = y;
+
+    ConstMatrixView a_view(a.data(), a_rows, a_cols, a_cols + pad);
+    char            what[128];
+    snprintf(what, sizeof(what), "multiplyVector %zux%zu %s beta %g%s", m, k, name(trans_a), beta,
+             padded ? " padded" : "");
+    if (!Gemm::multiplyVector(alpha, a_view, trans_a, x.data(), beta, y.data())) {
+        printf("FAIL %s: returned false\n", what);
+        ++g_failures;
+        return;
+    }
+    matches(what, alpha, a_view, trans_a, ConstMatrixView(x.data(), k, 1), Transpose::No, beta, y0,
+            ConstMatrixView(y.data(), m, 1));
+}
+
+} // namespace
+
+int main() {
+    // Below the small-problem cutoff (32^3), above it, across the MR = 6, NR = 8, KC = 256,
+    // MC = 120 and NC = 4096 tile edges, and single-column outputs that take the GEMV path
+    const Shape shapes[] = {
+        {1, 1, 1},     {5, 7, 3},      {6, 8, 16},   {31, 33, 29}, {64, 64, 64},
+        {121, 9, 257}, {130, 70, 300}, {7, 4100, 5}, {13, 1, 300}, {250, 1, 7},
+    };
+    const Transpose transposes[] = {Transpose::No, Transpose::Yes};
+    const float     betas[] = {0.0f, 1.0f, -0.5f};
+
+    for (const Shape& shape : shapes) {
+        for (Transpose trans_a : transposes) {
+            for (Transpose trans_b : transposes) {
+                for (float beta : betas) {
+                    for (bool padded : {false, true}) {
+                        checkMultiply(shape, trans_a, trans_b, beta, padded);
+                    }
+                }
+            }
+        }
+    }
+    for (size_t m : {1, 6, 37, 300}) {
+        for (size_t k : {1, 8, 45, 513}) {
+            for (Transpose trans_a : transposes) {
+                for (float beta : betas) {
+                    for (bool padded : {false, true}) {
+                        checkMultiplyVector(m, k, trans_a, beta, padded);
+                    }
+                }
+            }
+        }
+    }
+
+    printf("%d of %d cases matched the naive product\n", g_cases - g_failures, g_cases);
+    return g_failures ? 1 : 0;
+}